@@ -10,6 +10,9 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <functional>
+#include <chrono>
+#include <future>
 
 namespace Kimura
 {
@@ -141,6 +144,14 @@ namespace Kimura
 	};
 
 
+	enum class PlaybackDirection : int
+	{
+		Forward,
+		Reverse,
+		PingPong
+	};
+
+
 	enum class PositionFormat : int
 	{
 		Full,
@@ -187,6 +198,15 @@ namespace Kimura
 		None
 	};
 
+	// How the streams and mipmaps of a frame are stored, from version 0.6 of the format. The library decodes LZ4 
+	// (block format) itself, the others go through PlayerOptions::StreamDecoder.
+	enum class StreamCodec : uint8
+	{
+		None,
+		LZ4,
+		Zstd
+	};
+
 	class IFrame
 	{
 		public:
@@ -286,9 +306,10 @@ namespace Kimura
 	{
 		uint32 BufferedFramesStart = 0;
 		uint32 BufferedFramesCount = 0;
+		uint64 BufferedBytes = 0;				// memory retained by the frames buffered ahead (see PlayerOptions::MaxBufferedBytes)
 
 		uint64 BytesReadInLastSecond = 0;
-		uint64 MemoryUsageForFrames = 0;
+		uint64 MemoryUsageForFrames = 0;		// memory retained by frames, whether buffered by the player or held by the application
 
 		uint32 NumFramesProcessedInLastSecond = 0;
 
@@ -298,9 +319,58 @@ namespace Kimura
 		double TotalTimeSpentOnProcessingFramesInLastSecond = 0.0;
 		double AvgTimeSpentOnProcessingPerFrames = 0.0;
 
+		// streams stored compressed, decompressed as part of processing. The ratio is their decompressed size over 
+		// their size in the document. Time is the total of all the tasks decompressing them.
+		double CompressionRatio = 0.0;
+		double TotalTimeSpentOnDecompressingInLastSecond = 0.0;
+		double AvgTimeSpentOnDecompressingPerFrame = 0.0;
+
+		// frames read and waiting to be decoded or published (see PlayerOptions::NumDecodeTasks), and the share of 
+		// the last second each stage spent working. Decode utilization is relative to all of the decode tasks.
+		uint32 DecodeQueueDepth = 0;
+		double AvgDecodeQueueDepth = 0.0;		// seen by the frames entering the queue
+		double ReadStageUtilization = 0.0;
+		double DecodeStageUtilization = 0.0;
+
+		double OpenToReadyTime = 0.0;			// time it took (in seconds) for the player to open the file and become ready
+
+		// with the entire playback buffered (see PlayerOptions::BufferEntirePlayback), the share of the frames loaded so 
+		// far and the time it took (in seconds) from opening the file to all of them being loaded
+		double PercentLoaded = 0.0;
+		double TimeToFullyResident = 0.0;
+
+		// when the file is memory mapped, frames point directly into the mapping rather than owning a buffer.
+		uint64 MappedBytes = 0;					// size of the file mapping
+		uint64 MappedResidentBytes = 0;			// portion of the mapping currently resident in physical memory
+
+		double FrameBufferPoolHitRate = 0.0;	// ratio of frame buffers recycled from the pool rather than allocated
+		uint64 FrameBufferPoolBytesHeld = 0;	// memory held by the pool, waiting to be reused
+
+		// seeks are requests for frames outside of the buffered window. Latency is the time (in seconds) it takes for 
+		// the requested frame to become available.
+		uint32 NumSeeks = 0;
+		double LastSeekLatency = 0.0;
+		double AvgSeekLatency = 0.0;
+
+		// number of frames currently buffered ahead (see PlayerOptions::AdaptivePreBuffering), the rate (per second) 
+		// at which the application requests them and how many times it asked for a frame that wasn't loaded yet
+		uint32 PreBufferingSize = 0;
+		double FrameRequestRate = 0.0;
+		uint32 NumStarvedRequests = 0;
+
+		// loads that completed after the time the application was expected to need the frame
+		uint32 NumDeadlineMisses = 0;
+
+		// requests for frames behind the buffered window, served from the back buffer (hits) or reloaded (misses)
+		uint32 BackBufferedFramesCount = 0;
+		uint64 BackBufferHits = 0;
+		uint64 BackBufferMisses = 0;
+
 	};
 
 
+	typedef std::function<void(std::shared_ptr<IFrame>)> FrameRequestCallback;
+
 	class IPlayer
 	{
 		public:
@@ -313,7 +383,19 @@ namespace Kimura
 			virtual bool RetrievePlaybackInformation(PlaybackInformation& OutInfo) = 0;
 
 			virtual int GetBufferedFrameCount() = 0;
+
+			// Frames are meant to be requested from a single thread. Asking again for the frame last returned doesn't 
+			// take any lock.
 			virtual std::shared_ptr<IFrame>	GetFrameAt(uint32 iFrame, bool InForceWait) = 0;
+
+			// waits for the frame until InDeadline at most. Null if it isn't available by then.
+			virtual std::shared_ptr<IFrame>	GetFrameAt(uint32 iFrame, std::chrono::steady_clock::time_point InDeadline) = 0;
+
+			// Asks for a frame without moving the playback, from any thread. The request completes right away when 
+			// the frame is buffered, otherwise once the player has loaded it, ahead of the frames it buffers. Null when 
+			// the player stops or fails first. InCallback runs on the thread completing the request, it mustn't block.
+			virtual std::shared_future<std::shared_ptr<IFrame>>	RequestFrame(uint32 iFrame, FrameRequestCallback InCallback = nullptr) = 0;
+
 			virtual std::shared_ptr<IFrame>	GetConstantFrame() = 0;
 
 			virtual uint32	GetNumFrames() = 0;
@@ -324,19 +406,213 @@ namespace Kimura
 
 	};
 
+	// Source of the bytes making up a .k document. The player only ever reads through this interface, which allows 
+	// playback from files, memory, mappings, archives or any custom I/O layer. ReadAt may be called from any thread.
+	class IByteSource
+	{
+		public:
+
+			virtual ~IByteSource() {}
+
+			virtual uint64 GetSize() = 0;
+
+			// positional read. Succeeds only if the entire range could be read.
+			virtual bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize) = 0;
+
+			// Optional. Address of the entire content when it is directly addressable (memory, file mapping). Frames 
+			// then point straight into it rather than owning a copy. The source must remain valid as long as it is 
+			// referenced by the player or its frames.
+			virtual const byte* Map() { return nullptr; }
+
+			// Optional. Hint that a range of a mapped source is about to be accessed.
+			virtual void Prefetch(uint64 /*InOffset*/, uint64 /*InSize*/) {}
+
+			// Optional. For mapped sources, how much of the content currently sits in physical memory.
+			virtual uint64 GetResidentBytes() { return 0; }
+
+			// Optional. Native posix file descriptor, allows asynchronous reads through io_uring on linux.
+			virtual int GetFileDescriptor() { return -1; }
+	};
+
+	// InMemoryMap is only honored on posix systems, a regular file source is returned elsewhere or when mapping fails.
+	std::shared_ptr<IByteSource>	CreateFileByteSource(const std::string& InPath, bool InMemoryMap = false);
+
+	// the source takes ownership of the data
+	std::shared_ptr<IByteSource>	CreateMemoryByteSource(std::vector<byte>&& InData);
+
+	// the data is not copied and must outlive the source and all of the frames obtained through it
+	std::shared_ptr<IByteSource>	CreateMemoryByteSource(const void* InData, uint64 InSize);
+
+
+	// Runs the work of the players: opening documents and loading frames. Unless told otherwise, all of the players 
+	// share a pool of threads sized to the machine. Engines with a task system of their own can provide it instead.
+	class ITaskScheduler
+	{
+		public:
+
+			virtual ~ITaskScheduler() {}
+
+			// runs InTask on another thread, later on. Tasks may block on I/O, and a player never has more than one 
+			// of them submitted at a time.
+			virtual void	Submit(std::function<void()> InTask) = 0;
+
+			// runs InTask on another thread, like Submit, for tasks that never block on I/O (decoding frames). 
+			// Schedulers keeping threads aside for I/O run these on their other threads.
+			virtual void	SubmitCompute(std::function<void()> InTask) { this->Submit(std::move(InTask)); }
+	};
+
+	// work stealing pool. One thread per core when InNumThreads is 0.
+	std::shared_ptr<ITaskScheduler>	CreateThreadPool(uint32 InNumThreads);
+
+	// scheduler of the players created without one (see PlayerOptions::TaskScheduler). Players keep using the one 
+	// they were created with. Set to null to go back to the built-in pool.
+	void							SetDefaultTaskScheduler(std::shared_ptr<ITaskScheduler> InScheduler);
+	std::shared_ptr<ITaskScheduler>	GetDefaultTaskScheduler();
+
+
+	class MemoryBudget;
+
+	// Memory budget shared by players (see PlayerOptions::MemoryBudget). Players only buffer frames while the memory 
+	// retained by all of them fits the budget. When it doesn't, players of lower priority give up their frames: back 
+	// buffers first, then frames buffered ahead. Only obtained from CreateMemoryBudget or GetProcessMemoryBudget, 
+	// players rely on the library's own implementation.
+	class IMemoryBudget
+	{
+		public:
+
+			virtual ~IMemoryBudget() {}
+
+			// 0 means no limit
+			virtual void	SetBudget(uint64 InBytes) = 0;
+			virtual uint64	GetBudget() = 0;
+
+			// memory retained by all of the players: buffered frames, cached keyframes and the idle buffers of their 
+			// pools (see PlayerOptions::MaxPooledFrameBufferBytes)
+			virtual uint64	GetBytesUsed() = 0;
+
+			// releases idle buffers and frames, lowest priority first, until InBytes have been freed or nothing is left 
+			// to release but the frames players need next. Meant for low memory events. Returns the amount actually 
+			// released.
+			virtual uint64	Trim(uint64 InBytes) = 0;
+
+		private:
+
+			friend class MemoryBudget;
+
+			IMemoryBudget() {}
+	};
+
+	std::shared_ptr<IMemoryBudget>	CreateMemoryBudget(uint64 InBytes);
+
+	// budget shared by the entire process, without limit until one is set
+	std::shared_ptr<IMemoryBudget>	GetProcessMemoryBudget();
+
+
+	// Decodes the streams stored with a codec the library doesn't implement itself (see StreamCodec), usually through 
+	// the compression library the engine already ships with. Called from any thread, several at once.
+	class IStreamDecoder
+	{
+		public:
+
+			virtual ~IStreamDecoder() {}
+
+			// succeeds only if exactly OutSize bytes were decoded
+			virtual bool	Decode(StreamCodec InCodec, const byte* InData, uint64 InSize, byte* OutData, uint64 OutSize) = 0;
+	};
+
+
 	class PlayerOptions
 	{
 		public:
 			
 			uint32 PreBufferingSize = 20;
+
+			// Loads of all the players are run earliest deadline first, the deadline being when the application is 
+			// expected to need the frame. The expected rate is measured from the requests, until then it's the 
+			// document's frame rate times PlaybackSpeed.
+			float PlaybackSpeed = 1.0f;
+
+			// Size the number of frames buffered ahead so that they cover PreBufferingTime seconds of playback at the 
+			// rate frames are requested. The window grows when frames take longer to load or the application runs 
+			// short of frames, and shrinks back when there's slack, within [MinPreBufferingSize, MaxPreBufferingSize] 
+			// and MaxPreBufferingBytes. PreBufferingSize is where it starts from.
+			bool AdaptivePreBuffering = false;
+			double PreBufferingTime = 0.5;
+			uint32 MinPreBufferingSize = 4;
+			uint32 MaxPreBufferingSize = 120;
+			uint64 MaxPreBufferingBytes = 512 * 1024 * 1024;
+
+			// Frames stop being buffered ahead once the next one would take the memory they retain over this amount, 
+			// whatever the number of frames. Frames the application is waiting for are always buffered. 0 means no 
+			// limit. Ignored when the entire playback is buffered.
+			uint64 MaxBufferedBytes = 0;
+
+			// Share a memory budget with other players, obtained from CreateMemoryBudget or GetProcessMemoryBudget. 
+			// When the budget runs short, players of lower priority give up their frames first.
+			std::shared_ptr<IMemoryBudget> MemoryBudget;
+			int32 MemoryBudgetPriority = 0;
+
+			// where the player's work runs. The default scheduler when not set.
+			std::shared_ptr<ITaskScheduler> TaskScheduler;
+
+			// Frames already played are kept for this long behind the requested one, so that stepping or scrubbing 
+			// backwards doesn't reload them. The oldest ones are dropped first once MaxBackBufferBytes is reached.
 			uint32 BackBufferSize = 10;
+			uint64 MaxBackBufferBytes = 128 * 1024 * 1024;
 
 			bool BufferEntirePlayback = false;
 
+			// With the entire playback buffered, frames are loaded by this many tasks at once. Each one takes ranges of 
+			// frames in turn, starting on keyframes whenever possible. 1 loads the frames one after the other.
+			uint32 NumBulkLoadTasks = 4;
+
 			bool Loop = true;
 
+			// Frames are buffered ahead of the requested one in this order. PingPong goes from the first frame to the 
+			// last one, then back. Ignored when the entire playback is buffered.
+			PlaybackDirection Direction = PlaybackDirection::Forward;
+
+			// Map the entire file in memory and have frames point straight into the mapping (no per-frame allocation 
+			// or copy). Only available on posix systems; ignored elsewhere, and ignored when the player is created 
+			// from a byte source.
+			bool MemoryMapFile = false;
+
+			// Number of frame reads kept in flight at once. Values above 1 enable asynchronous reads through io_uring 
+			// on linux, for sources that expose a file descriptor. Otherwise, frames keep being read one at a time.
+			uint32 IOQueueDepth = 1;
+
+			// Frames read by the player are set up by up to NumDecodeTasks tasks of the scheduler, while the next ones 
+			// are being read, then published in order. At most DecodeQueueDepth frames wait between reading and 
+			// publishing. 0 sets frames up right after reading them, on the same task.
+			uint32 NumDecodeTasks = 0;
+			uint32 DecodeQueueDepth = 8;
+
+			// Compressed streams of a frame are decompressed by up to this many tasks at once, including the one 
+			// setting the frame up. Codecs other than LZ4 need a StreamDecoder, documents using them fail to open 
+			// otherwise.
+			uint32 NumDecompressionTasks = 4;
+			std::shared_ptr<IStreamDecoder> StreamDecoder;
+
+			// Meshes stored as a basis (a mean shape and vectors, with a few coefficients per frame) only use as many of 
+			// its vectors as keep positions within this distance of the encoded ones. Fewer vectors take less memory 
+			// and time to reconstruct each frame. 0 uses all of them.
+			float MaxBasisError = 0.0f;
+
+			// Memory of retired frames is kept for reuse by upcoming frames, up to this amount. Counts against the 
+			// memory budget, which frees it first when running short.
+			uint64 MaxPooledFrameBufferBytes = 256 * 1024 * 1024;
+
+			// Number of keyframes kept around after being decoded to resolve a seek. Seeking back and forth around the 
+			// same spot then only costs the frames that are stored after the keyframe.
+			uint32 KeyframeCacheSize = 2;
+
+			// Back pooled frame buffers with huge pages, which reduces page faults and TLB misses on large frames. 
+			// Only honored on linux (transparent huge pages).
+			bool UseHugePages = false;
+
 	};
 
 	std::shared_ptr<IPlayer>	CreatePlayer(const std::string& InPath, const PlayerOptions& InOptions);
+	std::shared_ptr<IPlayer>	CreatePlayer(std::shared_ptr<IByteSource> InSource, const PlayerOptions& InOptions);
 
 }
\ No newline at end of file
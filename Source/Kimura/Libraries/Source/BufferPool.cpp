@@ -0,0 +1,338 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "Player.h"
+
+#if defined(KIMURA_UNREAL)
+
+	#include "HAL/UnrealMemory.h"
+
+#else
+
+	#include <cstdlib>
+
+	#if defined(__linux__)
+		#include <sys/mman.h>
+	#endif
+
+#endif
+
+// memory is requested from the system in multiples of this size
+#define KIMURA_BUFFER_POOL_MIN_GRANULARITY (4096ull)
+
+// transparent huge page size on x86-64 and most aarch64 configurations
+#define KIMURA_HUGE_PAGE_SIZE (2ull * 1024ull * 1024ull)
+
+
+//-----------------------------------------------------------------------------
+// PooledBuffer::PooledBuffer
+//-----------------------------------------------------------------------------
+Kimura::PooledBuffer::PooledBuffer(PooledBuffer&& InOther)
+	:
+	Data(InOther.Data),
+	Size(InOther.Size),
+	Capacity(InOther.Capacity),
+	Pool(std::move(InOther.Pool))
+{
+	InOther.Data = nullptr;
+	InOther.Size = 0;
+	InOther.Capacity = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// PooledBuffer::operator=
+//-----------------------------------------------------------------------------
+Kimura::PooledBuffer& Kimura::PooledBuffer::operator=(PooledBuffer&& InOther)
+{
+	if (this != &InOther)
+	{
+		this->Release();
+
+		this->Data = InOther.Data;
+		this->Size = InOther.Size;
+		this->Capacity = InOther.Capacity;
+		this->Pool = std::move(InOther.Pool);
+
+		InOther.Data = nullptr;
+		InOther.Size = 0;
+		InOther.Capacity = 0;
+	}
+
+	return *this;
+}
+
+
+//-----------------------------------------------------------------------------
+// PooledBuffer::~PooledBuffer
+//-----------------------------------------------------------------------------
+Kimura::PooledBuffer::~PooledBuffer()
+{
+	this->Release();
+}
+
+
+//-----------------------------------------------------------------------------
+// PooledBuffer::Release
+//-----------------------------------------------------------------------------
+void Kimura::PooledBuffer::Release()
+{
+	if (this->Data != nullptr && this->Pool != nullptr)
+	{
+		this->Pool->Return(this->Data, this->Capacity);
+	}
+
+	this->Data = nullptr;
+	this->Size = 0;
+	this->Capacity = 0;
+	this->Pool = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// PooledBuffer::Leak
+//-----------------------------------------------------------------------------
+void Kimura::PooledBuffer::Leak()
+{
+	// the pool keeps counting the memory as in use
+	this->Data = nullptr;
+	this->Size = 0;
+	this->Capacity = 0;
+	this->Pool = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::BufferPool
+//-----------------------------------------------------------------------------
+Kimura::BufferPool::BufferPool(uint64 InMaxBytesHeld, bool InUseHugePages)
+	:
+	MaxBytesHeld(InMaxBytesHeld),
+	UseHugePages(InUseHugePages)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::~BufferPool
+//-----------------------------------------------------------------------------
+Kimura::BufferPool::~BufferPool()
+{
+	for (auto& freeBuffer : this->FreeBuffers)
+	{
+		this->FreeMemory(freeBuffer.second);
+	}
+
+	this->FreeBuffers.clear();
+	this->BytesHeld = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::GetSizeClass
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::BufferPool::GetSizeClass(uint64 InSize)
+{
+	// four classes per power of two, which bounds the wasted memory to 25% while letting frames of slightly
+	// different sizes share buffers.
+	uint64 highestPowerOfTwo = 1;
+	while (highestPowerOfTwo <= (InSize >> 1))
+	{
+		highestPowerOfTwo <<= 1;
+	}
+
+	const uint64 granularity = std::max(highestPowerOfTwo / 4, KIMURA_BUFFER_POOL_MIN_GRANULARITY);
+
+	return ((InSize + granularity - 1) / granularity) * granularity;
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::Acquire
+//-----------------------------------------------------------------------------
+Kimura::PooledBuffer Kimura::BufferPool::Acquire(uint64 InSize)
+{
+	PooledBuffer buffer;
+
+	if (InSize == 0)
+	{
+		return buffer;
+	}
+
+	const uint64 sizeClass = GetSizeClass(InSize);
+
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+
+		this->NumRequests++;
+
+		// the smallest idle buffer that fits, as long as it's not wastefully large
+		auto it = this->FreeBuffers.lower_bound(sizeClass);
+		if (it != this->FreeBuffers.end() && it->first < sizeClass * 2)
+		{
+			buffer.Data = it->second;
+			buffer.Capacity = it->first;
+
+			this->BytesHeld -= it->first;
+			this->BytesInUse += it->first;
+			this->FreeBuffers.erase(it);
+
+			this->NumHits++;
+		}
+	}
+
+	if (buffer.Data == nullptr)
+	{
+		buffer.Data = this->AllocateMemory(sizeClass);
+		if (buffer.Data == nullptr)
+		{
+			// out of memory, the caller gets an empty buffer
+			return buffer;
+		}
+
+		buffer.Capacity = sizeClass;
+
+		std::unique_lock<std::mutex> lock(this->Mutex);
+		this->BytesInUse += sizeClass;
+	}
+
+	buffer.Size = InSize;
+	buffer.Pool = this->shared_from_this();
+
+	return buffer;
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::Return
+//-----------------------------------------------------------------------------
+void Kimura::BufferPool::Return(byte* InData, uint64 InCapacity)
+{
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+
+		this->BytesInUse -= InCapacity;
+
+		if (this->BytesHeld + InCapacity <= this->MaxBytesHeld)
+		{
+			this->FreeBuffers.insert(std::make_pair(InCapacity, InData));
+			this->BytesHeld += InCapacity;
+			return;
+		}
+	}
+
+	// the pool is full
+	this->FreeMemory(InData);
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::Purge
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::BufferPool::Purge(uint64 InBytes)
+{
+	std::vector<byte*> buffersToFree;
+	uint64 numBytesFreed = 0;
+
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+
+		while (!this->FreeBuffers.empty() && numBytesFreed < InBytes)
+		{
+			auto it = std::prev(this->FreeBuffers.end());
+
+			buffersToFree.push_back(it->second);
+			numBytesFreed += it->first;
+
+			this->BytesHeld -= it->first;
+			this->FreeBuffers.erase(it);
+		}
+	}
+
+	for (byte* data : buffersToFree)
+	{
+		this->FreeMemory(data);
+	}
+
+	return numBytesFreed;
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::GetBytesHeld
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::BufferPool::GetBytesHeld()
+{
+	std::unique_lock<std::mutex> lock(this->Mutex);
+	return this->BytesHeld;
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::CollectStats
+//-----------------------------------------------------------------------------
+void Kimura::BufferPool::CollectStats(uint64& OutNumHits, uint64& OutNumRequests, uint64& OutBytesHeld, uint64& OutBytesInUse)
+{
+	std::unique_lock<std::mutex> lock(this->Mutex);
+
+	OutNumHits = this->NumHits;
+	OutNumRequests = this->NumRequests;
+	OutBytesHeld = this->BytesHeld;
+	OutBytesInUse = this->BytesInUse;
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::AllocateMemory
+//-----------------------------------------------------------------------------
+Kimura::byte* Kimura::BufferPool::AllocateMemory(uint64 InCapacity)
+{
+
+#if defined(KIMURA_UNREAL)
+
+	return (byte*)FMemory::Malloc((SIZE_T)InCapacity);
+
+#else
+
+	#if defined(__linux__)
+	if (this->UseHugePages && InCapacity >= KIMURA_HUGE_PAGE_SIZE)
+	{
+		// aligning on a huge page boundary lets the kernel back the buffer with transparent huge pages. Unlike 
+		// MAP_HUGETLB, this doesn't require pages to be reserved ahead of time.
+		void* data = nullptr;
+		if (posix_memalign(&data, (size_t)KIMURA_HUGE_PAGE_SIZE, (size_t)InCapacity) == 0)
+		{
+			madvise(data, (size_t)InCapacity, MADV_HUGEPAGE);
+			return (byte*)data;
+		}
+	}
+	#endif
+
+	return (byte*)std::malloc((size_t)InCapacity);
+
+#endif
+
+}
+
+
+//-----------------------------------------------------------------------------
+// BufferPool::FreeMemory
+//-----------------------------------------------------------------------------
+void Kimura::BufferPool::FreeMemory(byte* InData)
+{
+
+#if defined(KIMURA_UNREAL)
+
+	FMemory::Free(InData);
+
+#else
+
+	std::free(InData);
+
+#endif
+
+}
@@ -0,0 +1,487 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "Player.h"
+
+#if defined(KIMURA_UNREAL)
+
+	// files
+	#include "GenericPlatform/GenericPlatformFile.h"
+	#include "Misc/Paths.h"
+
+#elif defined(KIMURA_WINDOWS)
+
+	#include <io.h>
+ 	#include <fcntl.h>
+	#include <climits>
+
+#else
+
+	// default, use fstream. Already included in player.h
+	#include <fstream>
+
+	#if defined(KIMURA_POSIX)
+		#include <sys/mman.h>
+		#include <sys/stat.h>
+		#include <fcntl.h>
+		#include <unistd.h>
+	#endif
+
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Kimura::CreateFileByteSource
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IByteSource> Kimura::CreateFileByteSource(const std::string& InPath, bool InMemoryMap)
+{
+#if defined(KIMURA_POSIX)
+	if (InMemoryMap)
+	{
+		// when mapping fails, simply fall back on reading from the file
+		std::shared_ptr<MappedFileByteSource> mapping = std::make_shared<MappedFileByteSource>();
+		if (mapping->Open(InPath))
+		{
+			return mapping;
+		}
+	}
+#endif
+
+	std::shared_ptr<FileByteSource> file = std::make_shared<FileByteSource>();
+	if (!file->Open(InPath))
+	{
+		return nullptr;
+	}
+
+	return file;
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::CreateMemoryByteSource
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IByteSource> Kimura::CreateMemoryByteSource(std::vector<byte>&& InData)
+{
+	return std::make_shared<MemoryByteSource>(std::move(InData));
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::CreateMemoryByteSource
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IByteSource> Kimura::CreateMemoryByteSource(const void* InData, uint64 InSize)
+{
+	return std::make_shared<MemoryByteSource>(InData, InSize);
+}
+
+
+//-----------------------------------------------------------------------------
+// FileByteSource::~FileByteSource
+//-----------------------------------------------------------------------------
+Kimura::FileByteSource::~FileByteSource()
+{
+#if defined(KIMURA_UNREAL)
+	if (this->UEFileHandle != nullptr)
+	{
+		delete this->UEFileHandle;
+		this->UEFileHandle = nullptr;
+	}
+#elif defined(KIMURA_WINDOWS)
+	if (this->FileHandle >= 0)
+	{
+		_close(this->FileHandle);
+		this->FileHandle = -1;
+	}
+#elif defined(KIMURA_POSIX)
+	if (this->FileDescriptor >= 0)
+	{
+		close(this->FileDescriptor);
+		this->FileDescriptor = -1;
+	}
+#else
+	this->InputFile.close();
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// FileByteSource::Open
+//-----------------------------------------------------------------------------
+bool Kimura::FileByteSource::Open(const std::string& InPath)
+{
+
+#if defined(KIMURA_UNREAL)
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	FString sourceFilename(InPath.c_str());
+
+	// check if the file exists
+	if (!PlatformFile.FileExists(*sourceFilename))
+	{
+		return false;
+	}
+
+	this->UEFileHandle = PlatformFile.OpenRead(*sourceFilename);
+
+	if (this->UEFileHandle == nullptr)
+	{
+		return false;
+	}
+
+	this->Size = (uint64)this->UEFileHandle->Size();
+
+#elif defined(KIMURA_WINDOWS)
+
+	if (_sopen_s(&this->FileHandle, InPath.c_str(), _O_RDONLY | _O_BINARY, _SH_DENYNO, 0))
+	{
+		this->FileHandle = -1;
+		return false;
+	}
+
+	this->Size = (uint64)_filelengthi64(this->FileHandle);
+
+#elif defined(KIMURA_POSIX)
+
+	this->FileDescriptor = open(InPath.c_str(), O_RDONLY);
+	if (this->FileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(this->FileDescriptor, &st) != 0)
+	{
+		return false;
+	}
+
+	this->Size = (uint64)st.st_size;
+
+#else
+
+	this->InputFile.open(InPath, std::ios::in | std::ios::binary);
+	if (!this->InputFile.is_open())
+	{
+		return false;
+	}
+
+	this->InputFile.seekg(0, std::ios::end);
+	this->Size = (uint64)this->InputFile.tellg();
+	this->InputFile.seekg(0, std::ios::beg);
+
+#endif
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// FileByteSource::GetSize
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::FileByteSource::GetSize()
+{
+	return this->Size;
+}
+
+
+//-----------------------------------------------------------------------------
+// FileByteSource::ReadAt
+//-----------------------------------------------------------------------------
+bool Kimura::FileByteSource::ReadAt(uint64 InOffset, void* OutData, uint64 InSize)
+{
+
+#if defined(KIMURA_UNREAL)
+
+	std::unique_lock<std::mutex> lock(this->ReadMutex);
+
+	if (!this->UEFileHandle->Seek(InOffset))
+	{
+		return false;
+	}
+
+	return this->UEFileHandle->Read((uint8*)OutData, InSize);
+
+#elif defined(KIMURA_WINDOWS)
+
+	std::unique_lock<std::mutex> lock(this->ReadMutex);
+
+	if (_lseeki64(this->FileHandle, InOffset, SEEK_SET) != (__int64)InOffset)
+	{
+		return false;
+	}
+
+	// _read takes and returns an int, large ranges are read INT_MAX bytes at a time
+	uint64 numBytesRead = 0;
+	while (numBytesRead < InSize)
+	{
+		const unsigned int size = (unsigned int)std::min<uint64>(InSize - numBytesRead, INT_MAX);
+		const int result = _read(this->FileHandle, (byte*)OutData + numBytesRead, size);
+		if (result <= 0)
+		{
+			return false;
+		}
+
+		numBytesRead += (uint64)result;
+	}
+
+	return true;
+
+#elif defined(KIMURA_POSIX)
+
+	// pread may return less than requested, keep going until the range is complete
+	uint64 numBytesRead = 0;
+	while (numBytesRead < InSize)
+	{
+		ssize_t result = pread(this->FileDescriptor, (byte*)OutData + numBytesRead, (size_t)(InSize - numBytesRead), (off_t)(InOffset + numBytesRead));
+		if (result <= 0)
+		{
+			return false;
+		}
+
+		numBytesRead += (uint64)result;
+	}
+
+	return true;
+
+#else
+
+	std::unique_lock<std::mutex> lock(this->ReadMutex);
+
+	this->InputFile.clear();
+	this->InputFile.seekg(InOffset);
+	this->InputFile.read((char*)OutData, InSize);
+
+	return (uint64)this->InputFile.gcount() == InSize;
+
+#endif
+
+}
+
+
+//-----------------------------------------------------------------------------
+// FileByteSource::GetFileDescriptor
+//-----------------------------------------------------------------------------
+int Kimura::FileByteSource::GetFileDescriptor()
+{
+#if defined(KIMURA_POSIX)
+	return this->FileDescriptor;
+#else
+	return -1;
+#endif
+}
+
+
+
+#if defined(KIMURA_POSIX)
+
+//-----------------------------------------------------------------------------
+// MappedFileByteSource::~MappedFileByteSource
+//-----------------------------------------------------------------------------
+Kimura::MappedFileByteSource::~MappedFileByteSource()
+{
+	if (this->Data != nullptr)
+	{
+		munmap((void*)this->Data, this->Size);
+		this->Data = nullptr;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFileByteSource::Open
+//-----------------------------------------------------------------------------
+bool Kimura::MappedFileByteSource::Open(const std::string& InPath)
+{
+	int fd = open(InPath.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	this->Data = (const byte*)data;
+	this->Size = (uint64)st.st_size;
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFileByteSource::GetSize
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MappedFileByteSource::GetSize()
+{
+	return this->Size;
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFileByteSource::ReadAt
+//-----------------------------------------------------------------------------
+bool Kimura::MappedFileByteSource::ReadAt(uint64 InOffset, void* OutData, uint64 InSize)
+{
+	if (InOffset > this->Size || InSize > this->Size - InOffset)
+	{
+		return false;
+	}
+
+	memcpy(OutData, &this->Data[InOffset], (size_t)InSize);
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFileByteSource::Map
+//-----------------------------------------------------------------------------
+const Kimura::byte* Kimura::MappedFileByteSource::Map()
+{
+	return this->Data;
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFileByteSource::Prefetch
+//-----------------------------------------------------------------------------
+void Kimura::MappedFileByteSource::Prefetch(uint64 InOffset, uint64 InSize)
+{
+	// only what lies within the mapping, as with ReadAt
+	if (InOffset >= this->Size)
+	{
+		return;
+	}
+
+	const uint64 size = std::min(InSize, this->Size - InOffset);
+
+	// madvise requires a page aligned address
+	const uint64 pageSize = (uint64)sysconf(_SC_PAGESIZE);
+	const uint64 alignedOffset = InOffset - (InOffset % pageSize);
+
+	madvise((void*)&this->Data[alignedOffset], (size_t)(size + InOffset - alignedOffset), MADV_WILLNEED);
+}
+
+
+//-----------------------------------------------------------------------------
+// MappedFileByteSource::GetResidentBytes
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MappedFileByteSource::GetResidentBytes()
+{
+	const uint64 pageSize = (uint64)sysconf(_SC_PAGESIZE);
+
+	// queried a few pages at a time, rather than allocating a byte for every page of the mapping
+	const uint64 numPagesPerQuery = 4096;
+
+#if defined(__APPLE__)
+	char pages[numPagesPerQuery];
+#else
+	unsigned char pages[numPagesPerQuery];
+#endif
+
+	uint64 residentPages = 0;
+
+	for (uint64 offset = 0; offset < this->Size; offset += numPagesPerQuery * pageSize)
+	{
+		const uint64 size = std::min(this->Size - offset, numPagesPerQuery * pageSize);
+		if (mincore((void*)&this->Data[offset], (size_t)size, pages) != 0)
+		{
+			return 0;
+		}
+
+		const uint64 numPages = (size + pageSize - 1) / pageSize;
+		for (uint64 i = 0; i < numPages; i++)
+		{
+			residentPages += (pages[i] & 1);
+		}
+	}
+
+	return residentPages * pageSize;
+}
+
+#endif
+
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::MemoryByteSource
+//-----------------------------------------------------------------------------
+Kimura::MemoryByteSource::MemoryByteSource(std::vector<byte>&& InData)
+	:
+	OwnedData(std::move(InData))
+{
+	this->Data = this->OwnedData.data();
+	this->Size = (uint64)this->OwnedData.size();
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::MemoryByteSource
+//-----------------------------------------------------------------------------
+Kimura::MemoryByteSource::MemoryByteSource(const void* InData, uint64 InSize)
+	:
+	Data((const byte*)InData),
+	Size(InSize)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::GetSize
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MemoryByteSource::GetSize()
+{
+	return this->Size;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::ReadAt
+//-----------------------------------------------------------------------------
+bool Kimura::MemoryByteSource::ReadAt(uint64 InOffset, void* OutData, uint64 InSize)
+{
+	if (InOffset > this->Size || InSize > this->Size - InOffset)
+	{
+		return false;
+	}
+
+	memcpy(OutData, &this->Data[InOffset], (size_t)InSize);
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::Map
+//-----------------------------------------------------------------------------
+const Kimura::byte* Kimura::MemoryByteSource::Map()
+{
+	return this->Data;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryByteSource::GetResidentBytes
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MemoryByteSource::GetResidentBytes()
+{
+	return this->Size;
+}
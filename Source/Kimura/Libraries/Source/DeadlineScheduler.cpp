@@ -0,0 +1,105 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "Player.h"
+
+
+//-----------------------------------------------------------------------------
+// DeadlineScheduler::Get
+//-----------------------------------------------------------------------------
+Kimura::DeadlineScheduler& Kimura::DeadlineScheduler::Get()
+{
+	// never destroyed, tasks may still be running as the process exits
+	static DeadlineScheduler* deadlineScheduler = new DeadlineScheduler();
+	return *deadlineScheduler;
+}
+
+
+//-----------------------------------------------------------------------------
+// DeadlineScheduler::Schedule
+//-----------------------------------------------------------------------------
+void Kimura::DeadlineScheduler::Schedule(Player* InPlayer, std::shared_ptr<ITaskScheduler> InScheduler, std::chrono::steady_clock::time_point InDeadline)
+{
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+
+		Entry entry;
+		entry.Player_ = InPlayer;
+		entry.Scheduler = InScheduler.get();
+		entry.Deadline = InDeadline;
+
+		this->Entries.push_back(entry);
+	}
+
+	// one task per load queued, it doesn't matter which load it ends up running
+	ITaskScheduler* scheduler = InScheduler.get();
+	InScheduler->Submit([this, scheduler]() { this->RunNext(scheduler); });
+}
+
+
+//-----------------------------------------------------------------------------
+// DeadlineScheduler::Reschedule
+//-----------------------------------------------------------------------------
+bool Kimura::DeadlineScheduler::Reschedule(Player* InPlayer, std::chrono::steady_clock::time_point InDeadline)
+{
+	std::unique_lock<std::mutex> lock(this->Mutex);
+
+	for (Entry& entry : this->Entries)
+	{
+		if (entry.Player_ == InPlayer)
+		{
+			entry.Deadline = std::min(entry.Deadline, InDeadline);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//-----------------------------------------------------------------------------
+// DeadlineScheduler::SetEarliestDeadlineFirst
+//-----------------------------------------------------------------------------
+void Kimura::DeadlineScheduler::SetEarliestDeadlineFirst(bool InEarliestDeadlineFirst)
+{
+	std::unique_lock<std::mutex> lock(this->Mutex);
+	this->EarliestDeadlineFirst = InEarliestDeadlineFirst;
+}
+
+
+//-----------------------------------------------------------------------------
+// DeadlineScheduler::RunNext
+//-----------------------------------------------------------------------------
+void Kimura::DeadlineScheduler::RunNext(ITaskScheduler* InScheduler)
+{
+	// a few hundred players at most, a linear search is plenty
+	Entry next;
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+
+		size_t iNext = this->Entries.size();
+		for (size_t i = 0; i < this->Entries.size(); i++)
+		{
+			if (this->Entries[i].Scheduler == InScheduler && (iNext == this->Entries.size() || (this->EarliestDeadlineFirst && this->Entries[i].Deadline < this->Entries[iNext].Deadline)))
+			{
+				iNext = i;
+			}
+		}
+
+		if (iNext == this->Entries.size())
+		{
+			return;
+		}
+
+		// entries stay in the order they were queued, loads due at the same time run in that order
+		next = this->Entries[iNext];
+		this->Entries.erase(this->Entries.begin() + iNext);
+	}
+
+	// the player can't go away while it has a load queued or running
+	next.Player_->ExecuteTask(next.Deadline);
+}
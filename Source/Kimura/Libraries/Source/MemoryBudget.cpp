@@ -0,0 +1,232 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "Player.h"
+
+
+//-----------------------------------------------------------------------------
+// Kimura::CreateMemoryBudget
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IMemoryBudget> Kimura::CreateMemoryBudget(uint64 InBytes)
+{
+	return std::make_shared<MemoryBudget>(InBytes);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::GetProcessMemoryBudget
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IMemoryBudget> Kimura::GetProcessMemoryBudget()
+{
+	static std::shared_ptr<IMemoryBudget> processMemoryBudget = std::make_shared<MemoryBudget>(0);
+	return processMemoryBudget;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::MemoryBudget
+//-----------------------------------------------------------------------------
+Kimura::MemoryBudget::MemoryBudget(uint64 InBytes)
+	:
+	Budget(InBytes)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::SetBudget
+//-----------------------------------------------------------------------------
+void Kimura::MemoryBudget::SetBudget(uint64 InBytes)
+{
+	uint64 bytesOverBudget = 0;
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+
+		this->Budget = InBytes;
+		if (this->Budget > 0 && this->BytesUsed > this->Budget)
+		{
+			bytesOverBudget = this->BytesUsed - this->Budget;
+		}
+	}
+
+	// a lower budget applies right away
+	if (bytesOverBudget > 0)
+	{
+		this->Trim(bytesOverBudget);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::GetBudget
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MemoryBudget::GetBudget()
+{
+	std::unique_lock<std::mutex> lock(this->Mutex);
+	return this->Budget;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::GetBytesUsed
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MemoryBudget::GetBytesUsed()
+{
+	std::unique_lock<std::mutex> lock(this->Mutex);
+	return this->BytesUsed;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Trim
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MemoryBudget::Trim(uint64 InBytes)
+{
+	uint64 numBytesReleased = this->Release(InBytes, false, nullptr);
+
+	if (numBytesReleased < InBytes)
+	{
+		numBytesReleased += this->Release(InBytes - numBytesReleased, true, nullptr);
+	}
+
+	return numBytesReleased;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Register
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::MemoryBudget::Client> Kimura::MemoryBudget::Register(Player* InPlayer, int32 InPriority)
+{
+	std::shared_ptr<Client> client = std::make_shared<Client>();
+	client->Player_ = InPlayer;
+	client->Priority = InPriority;
+
+	std::unique_lock<std::mutex> lock(this->Mutex);
+	this->Clients.push_back(client);
+
+	return client;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Unregister
+//-----------------------------------------------------------------------------
+void Kimura::MemoryBudget::Unregister(std::shared_ptr<Client> InClient)
+{
+	// waits for the budget to be done releasing the player's frames, if it's doing so
+	{
+		std::unique_lock<std::mutex> clientLock(InClient->Mutex);
+		InClient->Player_ = nullptr;
+	}
+
+	std::unique_lock<std::mutex> lock(this->Mutex);
+
+	this->BytesUsed -= InClient->BytesUsed;
+	InClient->BytesUsed = 0;
+	InClient->Registered = false;
+
+	this->Clients.erase(std::remove(this->Clients.begin(), this->Clients.end(), InClient), this->Clients.end());
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::SetBytesUsed
+//-----------------------------------------------------------------------------
+void Kimura::MemoryBudget::SetBytesUsed(Client& InClient, uint64 InBytes)
+{
+	std::unique_lock<std::mutex> lock(this->Mutex);
+
+	// the player's last frames may still be coming in as it goes away
+	if (!InClient.Registered)
+	{
+		return;
+	}
+
+	this->BytesUsed -= InClient.BytesUsed;
+	this->BytesUsed += InBytes;
+	InClient.BytesUsed = InBytes;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Admit
+//-----------------------------------------------------------------------------
+bool Kimura::MemoryBudget::Admit(Client& InClient, uint64 InBytes)
+{
+	uint64 numBytesMissing = 0;
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+
+		if (this->Budget == 0 || this->BytesUsed + InBytes <= this->Budget)
+		{
+			return true;
+		}
+
+		numBytesMissing = this->BytesUsed + InBytes - this->Budget;
+	}
+
+	uint64 numBytesReleased = this->Release(numBytesMissing, false, &InClient);
+
+	if (numBytesReleased < numBytesMissing)
+	{
+		this->Release(numBytesMissing - numBytesReleased, true, &InClient);
+	}
+
+	std::unique_lock<std::mutex> lock(this->Mutex);
+	return this->Budget == 0 || this->BytesUsed + InBytes <= this->Budget;
+}
+
+
+//-----------------------------------------------------------------------------
+// MemoryBudget::Release
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::MemoryBudget::Release(uint64 InBytes, bool InLookAhead, const Client* InRequester)
+{
+	// players release their frames without the budget's lock held, they report their new usage as they do
+	std::vector<std::shared_ptr<Client>> clients;
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+
+		for (const std::shared_ptr<Client>& client : this->Clients)
+		{
+			if (client->BytesUsed == 0 || (client.get() == InRequester && InLookAhead))
+			{
+				continue;
+			}
+
+			// a player only takes back buffers from those that don't rank above it, and frames buffered ahead from 
+			// those that rank below it
+			if (InRequester != nullptr && (client->Priority > InRequester->Priority || (InLookAhead && client->Priority == InRequester->Priority)))
+			{
+				continue;
+			}
+
+			clients.push_back(client);
+		}
+	}
+
+	std::stable_sort(clients.begin(), clients.end(), [](const std::shared_ptr<Client>& a, const std::shared_ptr<Client>& b) { return a->Priority < b->Priority; });
+
+	uint64 numBytesReleased = 0;
+
+	for (const std::shared_ptr<Client>& client : clients)
+	{
+		if (numBytesReleased >= InBytes)
+		{
+			break;
+		}
+
+		std::unique_lock<std::mutex> clientLock(client->Mutex);
+		if (client->Player_ != nullptr)
+		{
+			numBytesReleased += client->Player_->ReleaseFrames(InBytes - numBytesReleased, InLookAhead);
+		}
+	}
+
+	return numBytesReleased;
+}
@@ -0,0 +1,392 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "Player.h"
+
+#if defined(KIMURA_SSE2)
+	#include <emmintrin.h>
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Kimura::DecodeTriangles
+//-----------------------------------------------------------------------------
+bool Kimura::DecodeTriangles(const byte* InData, uint64 InSize, byte* OutData, uint64 OutSize, uint32 InIndexSize)
+{
+	if ((InIndexSize != 2 && InIndexSize != 4) || OutSize % (3 * InIndexSize) != 0)
+	{
+		return false;
+	}
+
+	const uint64 numTriangles = OutSize / (3 * InIndexSize);
+	if (numTriangles > InSize)
+	{
+		return false;
+	}
+
+	const byte* codes = InData;
+	const byte* in = InData + numTriangles;
+	const byte* inEnd = InData + InSize;
+
+	// edges and vertices of the last triangles, most recent first from the head
+	uint32 edges[16][2] = {};
+	uint32 vertices[16] = {};
+	uint32 edgeHead = 0;
+	uint32 vertexHead = 0;
+
+	uint32 next = 0;
+	uint32 last = 0;
+
+	auto pushEdge = [&edges, &edgeHead](uint32 InA, uint32 InB)
+	{
+		edges[edgeHead & 15][0] = InA;
+		edges[edgeHead & 15][1] = InB;
+		edgeHead++;
+	};
+
+	auto pushVertex = [&vertices, &vertexHead](uint32 InVertex)
+	{
+		vertices[vertexHead & 15] = InVertex;
+		vertexHead++;
+	};
+
+	// 7 bits at a time, lowest first
+	auto readVarint = [&in, inEnd](uint32& OutValue)
+	{
+		OutValue = 0;
+		for (uint32 shift = 0; shift < 35; shift += 7)
+		{
+			if (in >= inEnd)
+			{
+				return false;
+			}
+
+			const byte b = *in++;
+			OutValue |= (uint32)(b & 127) << shift;
+
+			if (b < 128)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	// explicit vertices are the difference with the last explicit one, zigzagged
+	auto explicitVertex = [&last, &pushVertex](uint32 InValue)
+	{
+		last += (InValue >> 1) ^ (0u - (InValue & 1));
+		pushVertex(last);
+		return last;
+	};
+
+	// vertices of triangles without a known edge: 0 is the next new vertex, 1 to 15 the vertices of the last
+	// triangles, then explicit vertices
+	auto readVertex = [&](uint32& OutVertex)
+	{
+		uint32 value = 0;
+		if (!readVarint(value))
+		{
+			return false;
+		}
+
+		if (value == 0)
+		{
+			OutVertex = next++;
+			pushVertex(OutVertex);
+		}
+		else if (value < 16)
+		{
+			OutVertex = vertices[(vertexHead - value) & 15];
+		}
+		else
+		{
+			OutVertex = explicitVertex(value - 16);
+		}
+
+		return true;
+	};
+
+	const uint32 maxIndex = InIndexSize == 2 ? 0xffff : 0xffffffff;
+
+	for (uint64 iTriangle = 0; iTriangle < numTriangles; iTriangle++)
+	{
+		const uint32 code = codes[iTriangle];
+		const uint32 edgeCode = code >> 4;
+		const uint32 vertexCode = code & 15;
+
+		uint32 a, b, c;
+
+		if (edgeCode < 15)
+		{
+			// shares an edge with one of the last triangles, only the third vertex is coded
+			a = edges[(edgeHead - 1 - edgeCode) & 15][0];
+			b = edges[(edgeHead - 1 - edgeCode) & 15][1];
+
+			if (vertexCode == 0)
+			{
+				c = next++;
+				pushVertex(c);
+			}
+			else if (vertexCode < 15)
+			{
+				c = vertices[(vertexHead - vertexCode) & 15];
+			}
+			else
+			{
+				uint32 value = 0;
+				if (!readVarint(value))
+				{
+					return false;
+				}
+
+				c = explicitVertex(value);
+			}
+
+			pushEdge(c, b);
+			pushEdge(a, c);
+		}
+		else
+		{
+			if (!readVertex(a) || !readVertex(b) || !readVertex(c))
+			{
+				return false;
+			}
+
+			pushEdge(b, a);
+			pushEdge(c, b);
+			pushEdge(a, c);
+		}
+
+		if (a > maxIndex || b > maxIndex || c > maxIndex)
+		{
+			return false;
+		}
+
+		// packed in registers and stored at once, the bytes written past a triangle are overwritten by the next one
+		if (InIndexSize == 2)
+		{
+			const uint64 triangle = (uint64)a | ((uint64)b << 16) | ((uint64)c << 32);
+			memcpy(&OutData[iTriangle * 6], &triangle, iTriangle + 1 < numTriangles ? 8 : 6);
+		}
+		else
+		{
+			const uint64 ab = (uint64)a | ((uint64)b << 32);
+			memcpy(&OutData[iTriangle * 12], &ab, 8);
+			memcpy(&OutData[iTriangle * 12 + 8], &c, 4);
+		}
+	}
+
+	return in == inEnd;
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::DecodeBytePlanes
+//-----------------------------------------------------------------------------
+bool Kimura::DecodeBytePlanes(const byte* InData, uint64 InSize, byte* OutData, uint64 OutSize, uint32 InVertexSize)
+{
+	if (InVertexSize == 0 || InVertexSize > MaxBytePlanes || OutSize % InVertexSize != 0)
+	{
+		return false;
+	}
+
+	const uint64 numVertices = OutSize / InVertexSize;
+
+	const byte* in = InData;
+	const byte* inEnd = InData + InSize;
+
+	// the planes of a block, padded for the last group's loads
+	byte planes[MaxBytePlanes][BytePlanesBlockSize + 16];
+
+	// the previous vertex, which the first one of a block is the difference with
+	byte previous[MaxBytePlanes] = {};
+
+#if defined(KIMURA_SSE2)
+	byte lastBlock[BytePlanesBlockSize * MaxBytePlanes + 8];
+#endif
+
+	for (uint64 blockBegin = 0; blockBegin < numVertices; blockBegin += BytePlanesBlockSize)
+	{
+		const uint32 count = (uint32)std::min<uint64>(BytePlanesBlockSize, numVertices - blockBegin);
+		const uint32 numGroups = (count + 15) / 16;
+		const uint32 headerSize = (numGroups + 3) / 4;
+
+		for (uint32 iPlane = 0; iPlane < InVertexSize; iPlane++)
+		{
+			if ((uint64)(inEnd - in) < headerSize)
+			{
+				return false;
+			}
+
+			const byte* header = in;
+			in += headerSize;
+
+			byte* plane = planes[iPlane];
+
+#if defined(KIMURA_SSE2)
+			__m128i carry = _mm_set1_epi8((char)previous[iPlane]);
+#else
+			byte carry = previous[iPlane];
+#endif
+
+			for (uint32 iGroup = 0; iGroup < numGroups; iGroup++)
+			{
+				// 0, 2, 4 or 8 bits per value, the highest bits of a byte come first
+				const uint32 mode = (header[iGroup / 4] >> ((iGroup % 4) * 2)) & 3;
+				const uint32 groupSize = mode == 0 ? 0 : 2u << mode;
+
+				if ((uint64)(inEnd - in) < groupSize)
+				{
+					return false;
+				}
+
+				byte* group = &plane[iGroup * 16];
+
+#if defined(KIMURA_SSE2)
+
+				// modes are mixed unpredictably, every width is unpacked and the mode's one selected. The 16 bytes loaded 
+				// near the end of the data come from a padded copy.
+				byte padded[16] = {};
+				const byte* source = in;
+				if (inEnd - in < 16)
+				{
+					memcpy(padded, in, (size_t)groupSize);
+					source = padded;
+				}
+
+				const __m128i bytes = _mm_loadu_si128((const __m128i*)source);
+
+				const __m128i nibbles = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(15)), _mm_and_si128(bytes, _mm_set1_epi8(15)));
+
+				const __m128i mask = _mm_set1_epi8(3);
+				const __m128i bits6 = _mm_and_si128(_mm_srli_epi16(bytes, 6), mask);
+				const __m128i bits4 = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+				const __m128i bits2 = _mm_and_si128(_mm_srli_epi16(bytes, 2), mask);
+				const __m128i bits0 = _mm_and_si128(bytes, mask);
+				const __m128i pairs = _mm_unpacklo_epi16(_mm_unpacklo_epi8(bits6, bits4), _mm_unpacklo_epi8(bits2, bits0));
+
+				const __m128i values = mode == 3 ? bytes : mode == 2 ? nibbles : mode == 1 ? pairs : _mm_setzero_si128();
+
+				// zigzag back to signed differences, then summed from the carry of the previous group
+				const __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(values, _mm_set1_epi8(1)));
+				__m128i sums = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(values, 1), _mm_set1_epi8(127)), sign);
+
+				sums = _mm_add_epi8(sums, _mm_slli_si128(sums, 1));
+				sums = _mm_add_epi8(sums, _mm_slli_si128(sums, 2));
+				sums = _mm_add_epi8(sums, _mm_slli_si128(sums, 4));
+				sums = _mm_add_epi8(sums, _mm_slli_si128(sums, 8));
+				sums = _mm_add_epi8(sums, carry);
+
+				_mm_storeu_si128((__m128i*)group, sums);
+
+				// the last value carried to every byte, without going through memory
+				carry = _mm_unpackhi_epi8(sums, sums);
+				carry = _mm_shufflehi_epi16(carry, 0xff);
+				carry = _mm_unpackhi_epi64(carry, carry);
+
+#else
+
+				for (uint32 i = 0; i < 16; i++)
+				{
+					uint32 value = 0;
+					switch (mode)
+					{
+						case 1:		value = (in[i / 4] >> (6 - (i % 4) * 2)) & 3; break;
+						case 2:		value = (in[i / 2] >> (4 - (i % 2) * 4)) & 15; break;
+						case 3:		value = in[i]; break;
+						default:	break;
+					}
+
+					carry = (byte)(carry + ((value >> 1) ^ (0u - (value & 1))));
+					group[i] = carry;
+				}
+
+#endif
+
+				in += groupSize;
+			}
+
+			previous[iPlane] = plane[count - 1];
+		}
+
+		// planes back to vertices
+		byte* out = &OutData[blockBegin * InVertexSize];
+
+#if defined(KIMURA_SSE2)
+
+		// 8 planes of 16 vertices at a time, stored as 8 bytes per vertex. The bytes stored past a vertex are those of 
+		// the next one's first planes, which are stored afterwards: the last planes are done first, each vertex after 
+		// the previous one. The last blocks go through a copy, for the bytes stored past the end.
+		const bool bLastBlock = (blockBegin + count) * InVertexSize + 8 > OutSize;
+		byte* target = bLastBlock ? lastBlock : out;
+
+		for (uint32 iChunk = (InVertexSize + 7) / 8; iChunk-- > 0; )
+		{
+			const uint32 firstPlane = iChunk * 8;
+
+			for (uint32 v = 0; v < count; v += 16)
+			{
+				__m128i p[8];
+				for (uint32 i = 0; i < 8; i++)
+				{
+					p[i] = firstPlane + i < InVertexSize ? _mm_loadu_si128((const __m128i*)&planes[firstPlane + i][v]) : _mm_setzero_si128();
+				}
+
+				const __m128i p01Low = _mm_unpacklo_epi8(p[0], p[1]);
+				const __m128i p01High = _mm_unpackhi_epi8(p[0], p[1]);
+				const __m128i p23Low = _mm_unpacklo_epi8(p[2], p[3]);
+				const __m128i p23High = _mm_unpackhi_epi8(p[2], p[3]);
+				const __m128i p45Low = _mm_unpacklo_epi8(p[4], p[5]);
+				const __m128i p45High = _mm_unpackhi_epi8(p[4], p[5]);
+				const __m128i p67Low = _mm_unpacklo_epi8(p[6], p[7]);
+				const __m128i p67High = _mm_unpackhi_epi8(p[6], p[7]);
+
+				// 4 bytes of 4 vertices each
+				const __m128i p0123[4] = { _mm_unpacklo_epi16(p01Low, p23Low), _mm_unpackhi_epi16(p01Low, p23Low), _mm_unpacklo_epi16(p01High, p23High), _mm_unpackhi_epi16(p01High, p23High) };
+				const __m128i p4567[4] = { _mm_unpacklo_epi16(p45Low, p67Low), _mm_unpackhi_epi16(p45Low, p67Low), _mm_unpacklo_epi16(p45High, p67High), _mm_unpackhi_epi16(p45High, p67High) };
+
+				for (uint32 i = 0; i < 4; i++)
+				{
+					const __m128i vertices[2] = { _mm_unpacklo_epi32(p0123[i], p4567[i]), _mm_unpackhi_epi32(p0123[i], p4567[i]) };
+
+					for (uint32 j = 0; j < 4; j++)
+					{
+						const uint32 iVertex = v + i * 4 + j;
+						if (iVertex >= count)
+						{
+							break;
+						}
+
+						const __m128i vertex = (j & 1) ? _mm_unpackhi_epi64(vertices[j / 2], vertices[j / 2]) : vertices[j / 2];
+						_mm_storel_epi64((__m128i*)&target[iVertex * InVertexSize + firstPlane], vertex);
+					}
+				}
+			}
+		}
+
+		if (bLastBlock)
+		{
+			memcpy(out, lastBlock, (size_t)count * InVertexSize);
+		}
+
+#else
+
+		for (uint32 iPlane = 0; iPlane < InVertexSize; iPlane++)
+		{
+			for (uint32 v = 0; v < count; v++)
+			{
+				out[v * InVertexSize + iPlane] = planes[iPlane][v];
+			}
+		}
+
+#endif
+	}
+
+	return in == inEnd;
+}
@@ -23,6 +23,14 @@
 	// default, use fstream. Already included in player.h
 	#include <fstream>
 
+	#if defined(KIMURA_IO_URING)
+		#include <sys/mman.h>
+		#include <unistd.h>
+		#include <linux/io_uring.h>
+		#include <sys/syscall.h>
+		#include <cerrno>
+	#endif
+
 #endif
 
 const Kimura::Vector2 Kimura::Vector2::ZeroVector(0.0f, 0.0f);
@@ -42,6 +50,15 @@ std::shared_ptr<Kimura::IPlayer>	Kimura::CreatePlayer(const std::string& InPath,
 }
 
 
+//-----------------------------------------------------------------------------
+// Kimura::CreatePlayer
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IPlayer>	Kimura::CreatePlayer(std::shared_ptr<IByteSource> InSource, const Kimura::PlayerOptions& InOptions)
+{
+	return std::make_shared<Player>(InSource, InOptions);
+}
+
+
 //-----------------------------------------------------------------------------
 // Kimura::GetVersion
 //-----------------------------------------------------------------------------
@@ -59,7 +76,45 @@ Kimura::Player::Player(const std::string& InPath, const Kimura::PlayerOptions& I
 {
 	this->InputFilePath = InPath;
 
-	this->Thread = new std::thread([this](){this->ThreadExecute();});
+	this->FrameBufferPool = std::make_shared<BufferPool>(this->Options.MaxPooledFrameBufferBytes, this->Options.UseHugePages);
+
+	this->CreationTime = std::chrono::steady_clock::now();
+	this->LastStatsCollection = std::chrono::high_resolution_clock::now();
+
+	if (this->Options.MemoryBudget != nullptr)
+	{
+		// IMemoryBudget can only be implemented by MemoryBudget, see its private constructor
+		this->SharedMemoryBudget = std::static_pointer_cast<MemoryBudget>(this->Options.MemoryBudget);
+		this->MemoryBudgetClient = this->SharedMemoryBudget->Register(this, this->Options.MemoryBudgetPriority);
+	}
+
+	this->TaskScheduler = this->Options.TaskScheduler != nullptr ? this->Options.TaskScheduler : GetDefaultTaskScheduler();
+	this->WakeUpBufferThread();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Player
+//-----------------------------------------------------------------------------
+Kimura::Player::Player(std::shared_ptr<IByteSource> InSource, const Kimura::PlayerOptions& InOptions)
+	:
+	Options(InOptions),
+	Source(InSource)
+{
+	this->FrameBufferPool = std::make_shared<BufferPool>(this->Options.MaxPooledFrameBufferBytes, this->Options.UseHugePages);
+
+	this->CreationTime = std::chrono::steady_clock::now();
+	this->LastStatsCollection = std::chrono::high_resolution_clock::now();
+
+	if (this->Options.MemoryBudget != nullptr)
+	{
+		// IMemoryBudget can only be implemented by MemoryBudget, see its private constructor
+		this->SharedMemoryBudget = std::static_pointer_cast<MemoryBudget>(this->Options.MemoryBudget);
+		this->MemoryBudgetClient = this->SharedMemoryBudget->Register(this, this->Options.MemoryBudgetPriority);
+	}
+
+	this->TaskScheduler = this->Options.TaskScheduler != nullptr ? this->Options.TaskScheduler : GetDefaultTaskScheduler();
+	this->WakeUpBufferThread();
 }
 
 
@@ -68,6 +123,12 @@ Kimura::Player::Player(const std::string& InPath, const Kimura::PlayerOptions& I
 //-----------------------------------------------------------------------------
 Kimura::Player::~Player()
 {
+	// from here on, other players can't take this one's frames
+	if (this->SharedMemoryBudget != nullptr)
+	{
+		this->SharedMemoryBudget->Unregister(this->MemoryBudgetClient);
+	}
+
 	this->Stop(true);
 }
 
@@ -111,14 +172,70 @@ void Kimura::Player::Stop(bool InWaitToComplete)
 {
 	KIMURA_TRACE("Kimura::Player::Stop");
 
-	this->StopThreadExecution = true;
-	this->WakeUpBufferThreadEvent.notify_one();
+	{
+		std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+		this->StopThreadExecution = true;
+	}
+
+	// release anyone waiting on frames that will never come
+	{
+		std::unique_lock<std::mutex> lock(this->WaitForFrameBufferedMutex);
+	}
+	this->WaitForFrameBufferedEvent.notify_all();
+
+	// and those who asked for frames. Requests can't be added from now on.
+	std::deque<FrameRequest> frameRequests;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		frameRequests.swap(this->PendingFrameRequests);
+	}
+
+	for (FrameRequest& request : frameRequests)
+	{
+		CompleteFrameRequest(request, nullptr);
+	}
+
+	// the task in flight, if any, finds out and doesn't submit another. Decode and bulk load tasks leave the frames 
+	// they haven't started.
 	if (InWaitToComplete)
 	{
-		this->Thread->join();
-		delete this->Thread;
+		std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+		this->TaskCompletedEvent.wait(threadLock, [this]() { return !this->TaskSubmitted && this->NumDecodeTasksRunning == 0 && this->NumBulkLoadTasksRunning == 0; });
+	}
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::WakeUpBufferThread
+//-----------------------------------------------------------------------------
+void Kimura::Player::WakeUpBufferThread()
+{
+	const std::chrono::steady_clock::time_point deadline = this->GetLoadDeadline();
+
+	// the request is flagged under the lock so that it can't be missed by a task about to complete
+	{
+		std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+
+		if (this->StopThreadExecution)
+		{
+			return;
+		}
+
+		if (this->TaskSubmitted)
+		{
+			// a load waiting for its turn may have become more urgent. One that's running looks for more work after.
+			if (!DeadlineScheduler::Get().Reschedule(this, deadline))
+			{
+				this->WakeUpRequested = true;
+			}
+			return;
+		}
+
+		this->TaskSubmitted = true;
 	}
 
+	DeadlineScheduler::Get().Schedule(this, this->TaskScheduler, deadline);
 }
 
 
@@ -127,8 +244,19 @@ void Kimura::Player::Stop(bool InWaitToComplete)
 //-----------------------------------------------------------------------------
 void Kimura::Player::Failure(std::string InErrorMessage)
 {
-	this->Status = PlayerStatus::Failed;
-	this->ErrorMessage = InErrorMessage;
+	// the message is set before the status, which publishes it. Bulk load tasks may fail at the same time, the first 
+	// failure is the one reported.
+	{
+		std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+
+		if (this->Status == PlayerStatus::Failed)
+		{
+			return;
+		}
+
+		this->ErrorMessage = InErrorMessage;
+		this->Status = PlayerStatus::Failed;
+	}
 
 	// stop execution of the running thread
 	this->Stop(false);
@@ -138,51 +266,84 @@ void Kimura::Player::Failure(std::string InErrorMessage)
 //-----------------------------------------------------------------------------
 // Player::ReadTOC
 //-----------------------------------------------------------------------------
-bool Kimura::Player::ReadTOC()
+bool Kimura::Player::ReadTOC(TOCReader& InReader)
 {
 	KIMURA_TRACE("Kimura::Player::ReadTOC");
 
-	this->Read<Version>(this->TOC.Version_);
+	InReader.Read<Version>(this->TOC.Version_);
+
+	// documents from 0.5 on are supported, 0.6 added stream codecs, 0.7 stream encodings and 0.8 mesh bases
+	const Version currentVersion;
+	const bool bSupportedVersion = this->TOC.Version_.A == currentVersion.A && this->TOC.Version_.B >= 5 && this->TOC.Version_.B <= currentVersion.B;
+
+	const bool bStreamCodecs = this->TOC.Version_.B >= 6;
+	const bool bStreamEncodings = this->TOC.Version_.B >= 7;
+	const bool bMeshBases = this->TOC.Version_.B >= 8;
 
-	if (!this->TOC.Version_.CompatibleWith(Version()))
+	if (InReader.HasFailed() || !bSupportedVersion)
 	{
 		this->Failure("Incompatible version");
 		return false;
 	}
 
-	this->Read(this->TOC.SourceFile);
-	this->Read(this->TOC.CreationDate);
+	InReader.Read(this->TOC.SourceFile);
+	InReader.Read(this->TOC.CreationDate);
 
-	this->Read<float>(this->TOC.TimePerFrame);
-	this->Read<float>(this->TOC.FrameRate);
+	InReader.Read<float>(this->TOC.TimePerFrame);
+	InReader.Read<float>(this->TOC.FrameRate);
 
 	uint32 b16BitIndices = 0;
-	this->Read<uint32>(b16BitIndices);
+	InReader.Read<uint32>(b16BitIndices);
 	this->TOC.Force16BitIndices = b16BitIndices ? true : false;
 
 	// meshes
 	{
 		uint32 numMeshes = 0;
-		this->Read<uint32>(numMeshes);
+		InReader.Read<uint32>(numMeshes);
 
-		this->TOC.Meshes.resize(numMeshes);
-
-		for (uint32 iMesh = 0; iMesh < numMeshes; iMesh++)
+		// one at a time, like the basis errors below
+		for (uint32 iMesh = 0; iMesh < numMeshes && !InReader.HasFailed(); iMesh++)
 		{
-			TOCMesh& m = this->TOC.Meshes[iMesh];
+			this->TOC.Meshes.emplace_back();
+			TOCMesh& m = this->TOC.Meshes.back();
+
+			InReader.Read(m.Name);
+
+			InReader.Read(m.Constant);
+			InReader.Read<uint64>(m.MaxVertices);
+			InReader.Read<uint64>(m.MaxSurfaces);
+			InReader.Read<PositionFormat>(m.PositionFormat_);
+			InReader.Read<NormalFormat>(m.NormalFormat_);
+			InReader.Read<TangentFormat>(m.TangentFormat_);
+			InReader.Read<VelocityFormat>(m.VelocityFormat_);
+			InReader.Read<TexCoordFormat>(m.TexCoordFormat_);
+			InReader.Read<ColorFormat>(m.ColorFormat_);
+
+			// formats select the size of the streams' elements, out of range values can't be played
+			if ((uint32)m.PositionFormat_ > (uint32)PositionFormat::Half || (uint32)m.NormalFormat_ > (uint32)NormalFormat::None ||
+				(uint32)m.TangentFormat_ > (uint32)TangentFormat::None || (uint32)m.VelocityFormat_ > (uint32)VelocityFormat::None ||
+				(uint32)m.TexCoordFormat_ > (uint32)TexCoordFormat::None || (uint32)m.ColorFormat_ > (uint32)ColorFormat::None)
+			{
+				this->Failure("Meshes are stored in an unsupported format");
+				return false;
+			}
 
-			this->Read(m.Name);
+			if (bMeshBases)
+			{
+				InReader.Read<uint32>(m.NumBasisVectors);
 
-			this->Read<bool>(m.Constant);
-			this->Read<uint64>(m.MaxVertices);
-			this->Read<uint64>(m.MaxSurfaces);
-			this->Read<PositionFormat>(m.PositionFormat_);
-			this->Read<NormalFormat>(m.NormalFormat_);
-			this->Read<TangentFormat>(m.TangentFormat_);
-			this->Read<VelocityFormat>(m.VelocityFormat_);
-			this->Read<TexCoordFormat>(m.TexCoordFormat_);
-			this->Read<ColorFormat>(m.ColorFormat_);
+				if (m.NumBasisVectors > 0)
+				{
+					InReader.Read<uint64>(m.BasisPosition);
 
+					// one at a time, a corrupted count fails at the end of the file rather than on allocation
+					float error = 0.0f;
+					for (uint32 i = 0; i < m.NumBasisVectors && InReader.Read<float>(error); i++)
+					{
+						m.BasisErrors.push_back(error);
+					}
+				}
+			}
 		}
 	}
 
@@ -191,21 +352,20 @@ bool Kimura::Player::ReadTOC()
 	// image sequences
 	{
 		uint32 numImageSequences = 0;		
-		this->Read<uint32>(numImageSequences);
+		InReader.Read<uint32>(numImageSequences);
 
-		this->TOC.ImageSequences.resize(numImageSequences);
-
-		for (uint32 iIS = 0; iIS < numImageSequences; iIS++)
+		for (uint32 iIS = 0; iIS < numImageSequences && !InReader.HasFailed(); iIS++)
 		{
-			TOCImageSequence& IS = this->TOC.ImageSequences[iIS];
+			this->TOC.ImageSequences.emplace_back();
+			TOCImageSequence& IS = this->TOC.ImageSequences.back();
 
-			this->Read(IS.Name);
-			this->Read<ImageFormat>(IS.Format);
+			InReader.Read(IS.Name);
+			InReader.Read<ImageFormat>(IS.Format);
 
-			this->Read<bool>(IS.Constant);
-			this->Read<uint32>(IS.Width);
-			this->Read<uint32>(IS.Height);
-			this->Read<uint32>(IS.MipMapCount);
+			InReader.Read(IS.Constant);
+			InReader.Read<uint32>(IS.Width);
+			InReader.Read<uint32>(IS.Height);
+			InReader.Read<uint32>(IS.MipMapCount);
 
 
 		}
@@ -217,18 +377,54 @@ bool Kimura::Player::ReadTOC()
 	{
 
 		uint32 numFrames = 0;
-		this->Read<uint32>(numFrames);
+		InReader.Read<uint32>(numFrames);
+
+		// playback steps are taken modulo the number of frames, and constant image sequences are read from the first
+		if (numFrames == 0 && !InReader.HasFailed())
+		{
+			this->Failure("Document doesn't contain any frame");
+			return false;
+		}
+
+		// a corrupted count fails here rather than on allocation
+		if ((uint64)numFrames * TOCFrameEntrySize > InReader.GetRemainingSize())
+		{
+			this->Failure("Table of content is truncated or corrupted");
+			return false;
+		}
+
+		// the rest of the table of content is mostly made of fixed size entries. Get it all in with a single read 
+		// (assuming a single section per mesh, the reader grows as needed otherwise)
+		{
+			const uint64 frameMeshEntrySize = TOCFrameMeshEntrySize + TOCFrameMeshSectionEntrySize + (bStreamCodecs ? TOCFrameMeshCodecsEntrySize : 0) + (bStreamEncodings ? TOCFrameMeshEncodingsEntrySize : 0);
+			const uint64 frameImageEntrySize = sizeof(uint32) + MaxMipmaps * (TOCMipmapEntrySize + (bStreamCodecs ? TOCMipmapCodecEntrySize : 0));
+			const uint64 frameEntrySize = TOCFrameEntrySize + this->TOC.Meshes.size() * frameMeshEntrySize + this->TOC.ImageSequences.size() * frameImageEntrySize;
+
+			InReader.Reserve(numFrames * frameEntrySize);
+		}
+
+		if (InReader.HasFailed())
+		{
+			this->Failure("Table of content is truncated or corrupted");
+			return false;
+		}
 
 		this->TOC.Frames.resize(numFrames);
 
-		this->Frames.resize(numFrames);
+		// with the entire playback buffered, frames can be requested in any order
+		if (this->Options.BufferEntirePlayback)
+		{
+			this->Options.Direction = PlaybackDirection::Forward;
+		}
+
+		this->Frames.resize(this->GetNumPlaybackSteps());
 
 		for (uint32 iFrame = 0; iFrame < numFrames; iFrame++)
 		{
 			TOCFrame& f = this->TOC.Frames[iFrame];
 
-			this->Read<uint64>(f.FilePosition);
-			this->Read<uint64>(f.BufferSize);
+			InReader.Read<uint64>(f.FilePosition);
+			InReader.Read<uint64>(f.BufferSize);
 
 			f.Meshes.resize(this->TOC.Meshes.size());
 
@@ -236,159 +432,74 @@ bool Kimura::Player::ReadTOC()
 			{
 				TOCFrameMesh& fm = f.Meshes[iMesh];
 
-				this->Read<uint32>(fm.Vertices);
-				this->Read<uint32>(fm.Surfaces);
+				InReader.Read<uint32>(fm.Vertices);
+				InReader.Read<uint32>(fm.Surfaces);
 
 				// read the mesh's sections
 				uint32 numSections = 0;
-				this->Read<uint32>(numSections);
+				if (!InReader.Read<uint32>(numSections) || (uint64)numSections * TOCFrameMeshSectionEntrySize > InReader.GetRemainingSize())
+				{
+					this->Failure("Table of content is truncated or corrupted");
+					return false;
+				}
 
 				fm.Sections.resize(numSections);
 				for (TOCFrameMeshSection& s : fm.Sections)
 				{
 
-					this->Read<uint32>(s.VertexStart);
-					this->Read<uint32>(s.IndexStart);
-					this->Read<uint32>(s.NumSurfaces);
-					this->Read<uint32>(s.MinVertexIndex);
-					this->Read<uint32>(s.MaxVertexIndex);
+					InReader.Read<uint32>(s.VertexStart);
+					InReader.Read<uint32>(s.IndexStart);
+					InReader.Read<uint32>(s.NumSurfaces);
+					InReader.Read<uint32>(s.MinVertexIndex);
+					InReader.Read<uint32>(s.MaxVertexIndex);
 
 				}
 
-				this->Read<int32>(fm.SeekIndices);
-				this->Read<uint32>(fm.SizeIndices);
+				InReader.Read<int32>(fm.SeekIndices);
+				InReader.Read<uint32>(fm.SizeIndices);
 
-				this->Read<int32>(fm.SeekPositions);
-				this->Read<uint32>(fm.SizePositions);
-				this->Read<Kimura::Vector3>(fm.PositionQuantizationCenter);
-				this->Read<Kimura::Vector3>(fm.PositionQuantizationExtents);
+				InReader.Read<int32>(fm.SeekPositions);
+				InReader.Read<uint32>(fm.SizePositions);
+				InReader.Read<Kimura::Vector3>(fm.PositionQuantizationCenter);
+				InReader.Read<Kimura::Vector3>(fm.PositionQuantizationExtents);
 
-				this->Read<int32>(fm.SeekNormals);
-				this->Read<uint32>(fm.SizeNormals);
+				InReader.Read<int32>(fm.SeekNormals);
+				InReader.Read<uint32>(fm.SizeNormals);
 
-				this->Read<int32>(fm.SeekTangents);
-				this->Read<uint32>(fm.SizeTangents);
+				InReader.Read<int32>(fm.SeekTangents);
+				InReader.Read<uint32>(fm.SizeTangents);
 
-				this->Read<int32>(fm.SeekVelocities);
-				this->Read<uint32>(fm.SizeVelocities);
-				this->Read<Kimura::Vector3>(fm.VelocityQuantizationCenter);
-				this->Read<Kimura::Vector3>(fm.VelocityQuantizationExtents);
+				InReader.Read<int32>(fm.SeekVelocities);
+				InReader.Read<uint32>(fm.SizeVelocities);
+				InReader.Read<Kimura::Vector3>(fm.VelocityQuantizationCenter);
+				InReader.Read<Kimura::Vector3>(fm.VelocityQuantizationExtents);
 
-				this->Read<int32>(fm.SeekTexCoords[0], MaxTextureCoords);
-				this->Read<uint32>(fm.SizeTexCoords[0], MaxTextureCoords);
+				InReader.Read<int32>(fm.SeekTexCoords[0], MaxTextureCoords);
+				InReader.Read<uint32>(fm.SizeTexCoords[0], MaxTextureCoords);
 
-				this->Read<int32>(fm.SeekColors[0], MaxColorChannels);
-				this->Read<uint32>(fm.SizeColors[0], MaxColorChannels);
-				this->Read<Vector4>(fm.ColorQuantizationExtents[0], MaxColorChannels);
+				InReader.Read<int32>(fm.SeekColors[0], MaxColorChannels);
+				InReader.Read<uint32>(fm.SizeColors[0], MaxColorChannels);
+				InReader.Read<Vector4>(fm.ColorQuantizationExtents[0], MaxColorChannels);
 
-				this->Read<Kimura::Vector3>(fm.BoundingCenter);
-				this->Read<Kimura::Vector3>(fm.BoundingSize);
+				InReader.Read<Kimura::Vector3>(fm.BoundingCenter);
+				InReader.Read<Kimura::Vector3>(fm.BoundingSize);
 
-				// determine dependency on previous frames
+				if (bStreamCodecs)
 				{
-					if (fm.SeekIndices == -1 ||
-						fm.SeekPositions == -1 ||
-						fm.SeekNormals == -1 ||
-						fm.SeekTangents == -1 ||
-						fm.SeekVelocities == -1)
-					{
-						fm.DependsOnPreviousFrame = true;
-					}
-
-					for (uint32 iTexCoord = 0; iTexCoord < MaxTextureCoords; iTexCoord++)
-					{
-						if (fm.SeekTexCoords[iTexCoord] == -1)
-						{
-							fm.DependsOnPreviousFrame = true;
-						}
-					}
-
-					for (uint32 iColor = 0; iColor < MaxColorChannels; iColor++)
-					{
-						if (fm.SeekColors[iColor] == -1)
-						{
-							fm.DependsOnPreviousFrame = true;
-						}
-					}
-
-					if (fm.DependsOnPreviousFrame)
+					InReader.Read<StreamCodec>(fm.StreamCodecs[0], NumStreams);
+					InReader.Read<uint32>(fm.StoredStreamSizes[0], NumStreams);
+				}
+				else
+				{
+					for (uint32 iStream = 0; iStream < NumStreams; iStream++)
 					{
-
-						uint32 iBackFrame = iFrame;
-
-						bool bFoundIndices = false;
-						bool bFoundPositions = false;
-						bool bFoundNormals = false;
-						bool bFoundTangents = false;
-						bool bFoundVelocities = false;
-						bool bFoundTextCoords0 = false;
-						bool bFoundTextCoords1 = false;
-						bool bFoundTextCoords2 = false;
-						bool bFoundTextCoords3 = false;
-						bool bFoundColor0 = false;
-						bool bFoundColor1 = false;
-
-						// backtrack until we find all the components needed for this mesh on this frame
-						while (iBackFrame > 0)
-						{
-
-							TOCFrameMesh& previousFrameMesh = this->TOC.Frames[iBackFrame].Meshes[iMesh];
-
-							if (previousFrameMesh.SeekIndices != -1)
-								bFoundIndices = true;
-
-							if (previousFrameMesh.SeekPositions != -1)
-								bFoundPositions = true;
-
-							if (previousFrameMesh.SeekNormals != -1)
-								bFoundNormals = true;
-
-							if (previousFrameMesh.SeekTangents != -1)
-								bFoundTangents = true;
-
-							if (previousFrameMesh.SeekVelocities != -1)
-								bFoundVelocities = true;
-
-							static_assert(MaxTextureCoords == 4, "Maximum texcoord count changed");
-							if (previousFrameMesh.SeekTexCoords[0] != -1) { bFoundTextCoords0 = true; }
-							if (previousFrameMesh.SeekTexCoords[1] != -1) { bFoundTextCoords1 = true; }
-							if (previousFrameMesh.SeekTexCoords[2] != -1) { bFoundTextCoords2 = true; }
-							if (previousFrameMesh.SeekTexCoords[3] != -1) { bFoundTextCoords3 = true; }
-
-							static_assert(MaxColorChannels == 2, "Maximum color count changed");
-							if (previousFrameMesh.SeekColors[0] != -1) { bFoundColor0 = true; }
-							if (previousFrameMesh.SeekColors[1] != -1) { bFoundColor1 = true; }
-
-							// do we have all the data we need at this point?
-							if (bFoundIndices &&
-								bFoundPositions &&
-								bFoundNormals &&
-								bFoundTangents &&
-								bFoundVelocities &&
-								bFoundTextCoords0 &&
-								bFoundTextCoords1 &&
-								bFoundTextCoords2 &&
-								bFoundTextCoords3 &&
-								bFoundColor0 &&
-								bFoundColor1)
-							{
-								break;
-							}
-
-							iBackFrame--;
-						}
-
-						fm.FrameIndexDependency = iBackFrame;
-
-						// frame containing this mesh must also be updated. 
-						f.DependsOnPreviousFrame = true;
-						if (f.FrameIndexDependency < fm.FrameIndexDependency)
-						{
-							f.FrameIndexDependency = fm.FrameIndexDependency;
-						}
-
+						fm.StoredStreamSizes[iStream] = fm.GetStreamSize(iStream);
 					}
+				}
 
+				if (bStreamEncodings)
+				{
+					InReader.Read<StreamEncoding>(fm.StreamEncodings[0], NumStreams);
 				}
 
 			}
@@ -399,16 +510,26 @@ bool Kimura::Player::ReadTOC()
 			{
 				TOCFrameImage& fi = f.Images[iIS];
 
-				this->Read<uint32>(fi.NumMipmaps);
+				InReader.Read<uint32>(fi.NumMipmaps);
 				for (uint32 iMipmap = 0; iMipmap < MaxMipmaps; iMipmap++)
 				{
-					this->Read<uint32>(fi.Mipmaps[iMipmap].Width);
-					this->Read<uint32>(fi.Mipmaps[iMipmap].Height);
-					this->Read<uint32>(fi.Mipmaps[iMipmap].RowPitch);
-					this->Read<uint32>(fi.Mipmaps[iMipmap].SlicePitch);
+					InReader.Read<uint32>(fi.Mipmaps[iMipmap].Width);
+					InReader.Read<uint32>(fi.Mipmaps[iMipmap].Height);
+					InReader.Read<uint32>(fi.Mipmaps[iMipmap].RowPitch);
+					InReader.Read<uint32>(fi.Mipmaps[iMipmap].SlicePitch);
 
-					this->Read<int32>(fi.Mipmaps[iMipmap].SeekPosition);
-					this->Read<uint32>(fi.Mipmaps[iMipmap].Size);
+					InReader.Read<int32>(fi.Mipmaps[iMipmap].SeekPosition);
+					InReader.Read<uint32>(fi.Mipmaps[iMipmap].Size);
+
+					if (bStreamCodecs)
+					{
+						InReader.Read<StreamCodec>(fi.Mipmaps[iMipmap].Codec);
+						InReader.Read<uint32>(fi.Mipmaps[iMipmap].StoredSize);
+					}
+					else
+					{
+						fi.Mipmaps[iMipmap].StoredSize = fi.Mipmaps[iMipmap].Size;
+					}
 
 				}
 
@@ -418,984 +539,3804 @@ bool Kimura::Player::ReadTOC()
 
 	}
 
+	if (InReader.HasFailed())
+	{
+		this->Failure("Table of content is truncated or corrupted");
+		return false;
+	}
 
-#if defined(KIMURA_UNREAL)
-	this->FrameDataFilePosition = this->UEFileHandle->Tell();
-#elif defined(KIMURA_WINDOWS)
 	// right after the TOC comes the frame data, keep that position offset
-	this->FrameDataFilePosition = _tell(this->FileHandle);
-#else
-	this->FrameDataFilePosition = this->InputFile.tellg();
-#endif
+	this->FrameDataFilePosition = InReader.Tell();
 
-	return true;
+	// frames pointing into a mapped source, and constant meshes, are never read through ReadAt. Whatever they point
+	// to must lie within the source, and within the frame storing it.
+	const uint64 frameDataSize = this->Source->GetSize() - this->FrameDataFilePosition;
 
-}
+	auto isInFrame = [](const TOCFrame& InFrame, int32 InSeek, uint64 InSize)
+	{
+		return InSeek >= 0 && (uint64)InSeek <= InFrame.BufferSize && InSize <= InFrame.BufferSize - (uint64)InSeek;
+	};
 
+	for (const TOCFrame& f : this->TOC.Frames)
+	{
+		if (f.FilePosition > frameDataSize || f.BufferSize > frameDataSize - f.FilePosition)
+		{
+			this->Failure("Frames lie past the end of the file");
+			return false;
+		}
 
-//-----------------------------------------------------------------------------
-// Player::Read
-//-----------------------------------------------------------------------------
-template<typename T>
-Kimura::uint32 Kimura::Player::Read(T& Out, uint32 InCount /*= 1*/)
-{
+		for (const TOCFrameMesh& fm : f.Meshes)
+		{
+			for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+			{
+				// streams stored as is are used in place, with their decoded size
+				const int32 seek = fm.GetStreamSeek(iStream);
+				const bool bStoredAsIs = fm.StreamCodecs[iStream] == StreamCodec::None && fm.StreamEncodings[iStream] == StreamEncoding::Raw;
 
-#if defined(KIMURA_UNREAL)
+				if (seek != -1 && (!isInFrame(f, seek, fm.StoredStreamSizes[iStream]) || (bStoredAsIs && !isInFrame(f, seek, fm.GetStreamSize(iStream)))))
+				{
+					this->Failure("Streams lie past the end of their frame");
+					return false;
+				}
+			}
+		}
 
-	this->UEFileHandle->Read((uint8*)&Out, sizeof(Out) * InCount);
-	return sizeof(Out) * InCount;
+		for (const TOCFrameImage& fi : f.Images)
+		{
+			for (uint32 iMipmap = 0; iMipmap < fi.NumMipmaps && iMipmap < MaxMipmaps; iMipmap++)
+			{
+				const TOCMipmap& m = fi.Mipmaps[iMipmap];
 
-#elif defined(KIMURA_WINDOWS)
+				if (m.SeekPosition != -1 && (!isInFrame(f, m.SeekPosition, m.StoredSize) || (m.Codec == StreamCodec::None && !isInFrame(f, m.SeekPosition, m.Size))))
+				{
+					this->Failure("Image sequences lie past the end of their frame");
+					return false;
+				}
+			}
+		}
+	}
 
-	int bytesRead = _read(this->FileHandle, (void*)&Out, sizeof(Out) * InCount);
-	return bytesRead;
+	// every stream must be decodable before playback starts
+	auto isCodecSupported = [this](StreamCodec InCodec)
+	{
+		return InCodec == StreamCodec::None || InCodec == StreamCodec::LZ4 || (InCodec == StreamCodec::Zstd && this->Options.StreamDecoder != nullptr);
+	};
 
-#else
-	uint64 posBefore = this->InputFile.tellg();
+	// only the streams of animated meshes are encoded, predicted or sparse ones never in the first frame
+	auto isEncodingSupported = [this](const TOCFrameMesh& InFrameMesh, uint32 iMesh, uint32 iStream, bool InFirstFrame)
+	{
+		const TOCMesh& mesh = this->TOC.Meshes[iMesh];
 
-	this->InputFile.read((char*)&Out, sizeof(Out) * InCount);
+		const StreamEncoding encoding = InFrameMesh.StreamEncodings[iStream];
+		if (encoding == StreamEncoding::Raw)
+		{
+			return true;
+		}
 
-	uint64 posAfter = this->InputFile.tellg();
+		if (mesh.Constant)
+		{
+			return false;
+		}
 
-	return (uint32)(posAfter - posBefore);
+		// positions of every vertex of the mesh, from a coefficient for each vector of its basis
+		if (encoding == StreamEncoding::Basis)
+		{
+			const uint64 positionSize = mesh.PositionFormat_ == PositionFormat::Full ? sizeof(Vector3) : 3 * sizeof(int16);
 
-#endif
+			return iStream == StreamPositions && mesh.NumBasisVectors > 0 && InFrameMesh.StreamCodecs[iStream] == StreamCodec::None &&
+				InFrameMesh.StoredStreamSizes[iStream] == mesh.NumBasisVectors * sizeof(float) &&
+				InFrameMesh.Vertices == mesh.MaxVertices && InFrameMesh.GetStreamSize(iStream) == mesh.MaxVertices * positionSize;
+		}
 
-}
+		// indices and vertices of their own codec, decoded straight into their layout
+		if (encoding == StreamEncoding::Triangles || encoding == StreamEncoding::BytePlanes)
+		{
+			const uint64 size = InFrameMesh.GetStreamSize(iStream);
+			if (InFrameMesh.StreamCodecs[iStream] != StreamCodec::None)
+			{
+				return false;
+			}
 
+			if (encoding == StreamEncoding::Triangles)
+			{
+				return iStream == StreamIndices && size % (3 * this->GetIndexSize(InFrameMesh)) == 0;
+			}
 
-//-----------------------------------------------------------------------------
-// Player::Read
-//-----------------------------------------------------------------------------
-Kimura::uint32 Kimura::Player::Read(std::string& s)
-{
+			return iStream != StreamIndices && InFrameMesh.Vertices > 0 && size % InFrameMesh.Vertices == 0 && size / InFrameMesh.Vertices <= MaxBytePlanes;
+		}
 
-#if defined(KIMURA_UNREAL)
+		const uint32 componentSize = mesh.GetComponentSize(iStream);
+		if (InFirstFrame || componentSize == 0)
+		{
+			return false;
+		}
 
-	int size_ = 0;
-	bool bRead = this->UEFileHandle->Read((uint8*)&size_, sizeof(size_));
+		return encoding == StreamEncoding::Sparse || (IsPredicted(encoding) && InFrameMesh.GetStreamSize(iStream) % componentSize == 0);
+	};
 
-	if (size_ > 0)
+	for (uint32 iFrame = 0; iFrame < (uint32)this->TOC.Frames.size(); iFrame++)
 	{
-		char str[1024];
-		this->UEFileHandle->Read((uint8*)str, size_);
-		str[size_] = 0;
+		const TOCFrame& f = this->TOC.Frames[iFrame];
 
-		s = str;
-	}
-	return sizeof(size_) + size_;
+		for (uint32 iMesh = 0; iMesh < (uint32)f.Meshes.size(); iMesh++)
+		{
+			const TOCFrameMesh& fm = f.Meshes[iMesh];
 
-#elif defined(KIMURA_WINDOWS)
+			for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+			{
+				if (fm.GetStreamSeek(iStream) == -1)
+				{
+					continue;
+				}
 
-	int bytesRead = 0;
+				if (!isCodecSupported(fm.StreamCodecs[iStream]))
+				{
+					this->Failure("Streams are compressed with an unsupported codec");
+					return false;
+				}
 
-	int size = 0;
-	bytesRead = _read(this->FileHandle, (void*)&size, sizeof(size));
-	if (size > 0)
-	{
-		char str[1024];
-		bytesRead += _read(this->FileHandle, str, size);
-		str[size] = 0;
+				if (!isEncodingSupported(fm, iMesh, iStream, iFrame == 0))
+				{
+					// encodings of their own say which one doesn't fit
+					switch (fm.StreamEncodings[iStream])
+					{
+						case StreamEncoding::Basis:		this->Failure("Basis stream doesn't match the mesh's basis"); break;
+						case StreamEncoding::Triangles:	this->Failure("Triangles stream doesn't match the mesh's indices"); break;
+						case StreamEncoding::BytePlanes:	this->Failure("Byte planes stream doesn't match the mesh's vertices"); break;
+						default:						this->Failure("Streams are encoded with an unsupported prediction"); break;
+					}
+					return false;
+				}
+			}
+		}
 
-		s = str;
+		for (const TOCFrameImage& fi : f.Images)
+		{
+			for (uint32 iMipmap = 0; iMipmap < fi.NumMipmaps && iMipmap < MaxMipmaps; iMipmap++)
+			{
+				if (fi.Mipmaps[iMipmap].SeekPosition != -1 && !isCodecSupported(fi.Mipmaps[iMipmap].Codec))
+				{
+					this->Failure("Image sequences are compressed with an unsupported codec");
+					return false;
+				}
+			}
+		}
 	}
-	return bytesRead;
 
-#else
-	uint64 posBefore = this->InputFile.tellg();
-
-	int size = 0;
-	this->InputFile.read((char*)&size, sizeof(size));
-	if (size > 0)
+	if (!this->ComputeFrameDependencies())
 	{
-		char str[1024];
-		this->InputFile.read(str, sizeof(char) * size);
-		str[size] = 0;
-
-		s = str;
+		return false;
 	}
 
-	uint64 posAfter = this->InputFile.tellg();
+	this->PrepareReadRanges();
+
+	return true;
 
-	return (uint32)(posAfter - posBefore);
-#endif
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::ThreadExecute
+// Player::ComputeFrameDependencies
 //-----------------------------------------------------------------------------
-void Kimura::Player::ThreadExecute()
+bool Kimura::Player::ComputeFrameDependencies()
 {
-	std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
-
+	KIMURA_TRACE("Kimura::Player::ComputeFrameDependencies");
 
-	// open the file
-	{
+	const uint32 numMeshes = (uint32)this->TOC.Meshes.size();
+	const uint32 numImageSequences = (uint32)this->TOC.ImageSequences.size();
 
-#if defined(KIMURA_UNREAL)
+	// most recent frame storing each stream of each mesh, and each mipmap of each image sequence. Tracking them in a 
+	// single pass over the frames keeps this linear, whatever the number of frames reusing a stream.
+	std::vector<uint32> streamSources(numMeshes * NumStreams, NoStreamSource);
+	std::vector<uint32> mipmapSources(numImageSequences * MaxMipmaps, NoStreamSource);
 
-		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	// keyframes don't depend on any other frame. Every frame keeps track of the closest keyframe at or before it, 
+	// which bounds how far back a seek ever needs to look.
+	uint32 iKeyframe = 0;
 
-		FString sourceFilename(InputFilePath.c_str());
+	for (uint32 iFrame = 0; iFrame < (uint32)this->TOC.Frames.size(); iFrame++)
+	{
+		TOCFrame& f = this->TOC.Frames[iFrame];
 
+		f.DependsOnPreviousFrame = false;
+		f.FrameIndexDependency = iFrame;
 
-		// check if the file exists
-		if (!PlatformFile.FileExists(*sourceFilename))
+		for (uint32 iMesh = 0; iMesh < numMeshes; iMesh++)
 		{
-			return this->Failure("Failed to open the input file: ");
-		}
+			TOCFrameMesh& fm = f.Meshes[iMesh];
 
-		this->UEFileHandle = PlatformFile.OpenRead(*sourceFilename);
+			fm.DependsOnPreviousFrame = false;
+			fm.FrameIndexDependency = iFrame;
 
-		if (this->UEFileHandle == nullptr)
-		{
-			return this->Failure("Failed to open the input file");
-		}
+			for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+			{
+				uint32& source = streamSources[iMesh * NumStreams + iStream];
 
+				if (fm.GetStreamSeek(iStream) != -1)
+				{
+					// sparse streams have the size of the stream their changes apply to, the previous frame's
+					if (fm.StreamEncodings[iStream] == StreamEncoding::Sparse)
+					{
+						// changes are made of whole vertices, of the size the previous frame's stream gives them
+						const TOCFrameMesh* sourceFrameMesh = source != NoStreamSource ? &this->TOC.Frames[source].Meshes[iMesh] : nullptr;
+						const uint32 size = sourceFrameMesh != nullptr ? sourceFrameMesh->GetStreamSize(iStream) : 0;
 
-#elif defined(KIMURA_WINDOWS)
-		if (_sopen_s(&this->FileHandle, this->InputFilePath.c_str(), _O_RDONLY | _O_BINARY, _SH_DENYNO, 0))
-		{
-			return this->Failure("Failed to open the input file: ");
-		}
-#else
+						if (sourceFrameMesh == nullptr || sourceFrameMesh->Vertices != fm.Vertices || (size > 0 && (fm.Vertices == 0 || size % fm.Vertices != 0)))
+						{
+							this->Failure("Sparse streams don't match the vertices of the previous frame");
+							return false;
+						}
 
-/* requires c++ 17
+						fm.SparseStreamSizes[iStream] = fm.GetStreamSize(iStream);
+						fm.SetStreamSize(iStream, size);
+					}
 
-		// validate access to alembic document
-		if (!std::filesystem::exists(this->InputFilePath))
-		{
-			return this->Failure("Couldn't find input file");
-		}
-*/
+					// residuals are added to the previous frame's stream as is, it must be just as large
+					if (IsPredicted(fm.StreamEncodings[iStream]) && (source == NoStreamSource || this->TOC.Frames[source].Meshes[iMesh].GetStreamSize(iStream) != fm.GetStreamSize(iStream)))
+					{
+						this->Failure("Predicted streams don't match the size of the previous frame's");
+						return false;
+					}
 
-		this->InputFile.open(this->InputFilePath, std::ios::in | std::ios::binary);
-		if (!this->InputFile.is_open())
-		{
-			return this->Failure("Failed to open the input file: ");
-		}
-#endif
-	}
+					source = iFrame;
 
-	// read the table of content from the file
-	{
-		if (!this->ReadTOC())
-		{
-			// failed
-			return;
-		}
+					// predicted from the previous frame's stream, or made of its changes
+					if (!IsSelfContained(fm.StreamEncodings[iStream]) && iFrame > 0)
+					{
+						fm.DependsOnPreviousFrame = true;
+						fm.FrameIndexDependency = std::min(fm.FrameIndexDependency, iFrame - 1);
+						f.PredictedFromPreviousFrames = true;
+					}
+				}
+				else if (source != NoStreamSource && this->TOC.Frames[source].Meshes[iMesh].GetStreamSize(iStream) > 0 && !this->TOC.Meshes[iMesh].Constant)
+				{
+					// only a stream actually stored by a previous frame ties this frame to it. Constant meshes are 
+					// loaded once and shared by every frame (see LoadConstantMeshes).
+					fm.DependsOnPreviousFrame = true;
+					fm.FrameIndexDependency = std::min(fm.FrameIndexDependency, source);
 
-		// success! ready to start loading frames
-		this->Status = PlayerStatus::Ready;
-	}
+					if (this->TOC.Frames[source].Meshes[iMesh].StreamEncodings[iStream] != StreamEncoding::Raw)
+					{
+						f.PredictedFromPreviousFrames = true;
+					}
+				}
 
-	// adjust buffering sizes
-	if (this->Options.BufferEntirePlayback || this->Options.PreBufferingSize > (uint32)this->TOC.Frames.size())
-	{
-		this->Options.PreBufferingSize = (uint32)this->TOC.Frames.size();
-	}
+				fm.StreamSources[iStream] = source;
+			}
 
-	// if any of the image sequences stored in the file is flagged as constant, we should read that frame and store it 
-	// immediately. 
-	bool bBufferFirstFrame = false;
-	for (const auto& imageSequence : this->TOC.ImageSequences)
-	{
-		if (imageSequence.Constant)
+			if (fm.DependsOnPreviousFrame)
+			{
+				f.DependsOnPreviousFrame = true;
+				f.FrameIndexDependency = std::min(f.FrameIndexDependency, fm.FrameIndexDependency);
+			}
+		}
+
+		for (uint32 iIS = 0; iIS < numImageSequences; iIS++)
 		{
-			bBufferFirstFrame = true;
-			break;
+			TOCFrameImage& fi = f.Images[iIS];
+
+			for (uint32 iMipmap = 0; iMipmap < fi.NumMipmaps && iMipmap < MaxMipmaps; iMipmap++)
+			{
+				TOCMipmap& m = fi.Mipmaps[iMipmap];
+				uint32& source = mipmapSources[iIS * MaxMipmaps + iMipmap];
+
+				if (m.SeekPosition != -1)
+				{
+					source = iFrame;
+				}
+				else if (source != NoStreamSource && this->TOC.Frames[source].Images[iIS].Mipmaps[iMipmap].Size > 0)
+				{
+					f.DependsOnPreviousFrame = true;
+					f.FrameIndexDependency = std::min(f.FrameIndexDependency, source);
+				}
+
+				m.SourceFrame = source;
+			}
 		}
-	}
-	if (bBufferFirstFrame)
-	{
-		this->LoadFrameAt(0);
-		this->FirstFrame = this->Frames[0];
-	}
 
-	while (!this->StopThreadExecution)
-	{
-		if (!this->BufferNextFrame())
+		if (!f.DependsOnPreviousFrame)
 		{
-			// when buffer is full or contains sufficient frames, pause the thread
-			this->WakeUpBufferThreadEvent.wait(threadLock);
-		}	
-	}
+			iKeyframe = iFrame;
+		}
 
-#if defined(KIMURA_UNREAL)
-	if (this->UEFileHandle != nullptr)
-	{
-		delete this->UEFileHandle;
-		this->UEFileHandle = nullptr;
+		f.Keyframe = iKeyframe;
 	}
-#elif defined(KIMURA_WINDOWS)
-	_close(this->FileHandle);
-	this->FileHandle = -1;
-#else
-	this->InputFile.close();
-#endif
+
+	return true;
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::BufferNextFrame
+// Player::PrepareReadRanges
 //-----------------------------------------------------------------------------
-bool Kimura::Player::BufferNextFrame()
+void Kimura::Player::PrepareReadRanges()
 {
-	// find the index of the next frame to buffer
-	uint32 indexOfFrameToLoad = 0;	
-	{
-		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+	std::vector<TOCFrameReadRange> skippedRanges;
 
-		if (this->FullyBufferedFramesCount >= this->Options.PreBufferingSize)
+	for (TOCFrame& f : this->TOC.Frames)
+	{
+		// data of constant meshes stored in this frame
+		skippedRanges.clear();
+		for (uint32 iMesh = 0; iMesh < this->TOC.Meshes.size(); iMesh++)
 		{
-			// sufficient number of frames are already buffered. There's no need to buffer another frame at this time. 
-			return false;
-		}
+			if (!this->TOC.Meshes[iMesh].Constant)
+			{
+				continue;
+			}
 
-		indexOfFrameToLoad = this->FullyBufferedFramesStart + this->FullyBufferedFramesCount;
-		
-		if (this->Options.Loop)
-		{
-			// wrap around
-			indexOfFrameToLoad %= (uint32)this->TOC.Frames.size();
+			for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+			{
+				const int32 seek = f.Meshes[iMesh].GetStreamSeek(iStream);
+				const uint32 size = f.Meshes[iMesh].StoredStreamSizes[iStream];
+
+				if (seek >= 0 && size > 0)
+				{
+					TOCFrameReadRange r;
+					r.Offset = (uint64)seek;
+					r.Size = size;
+					skippedRanges.push_back(r);
+				}
+			}
 		}
-		else if (indexOfFrameToLoad >= (uint32)this->TOC.Frames.size())
+
+		std::sort(skippedRanges.begin(), skippedRanges.end(), [](const TOCFrameReadRange& a, const TOCFrameReadRange& b) { return a.Offset < b.Offset; });
+
+		f.ReadRanges.clear();
+		f.ReadSize = 0;
+
+		auto addRange = [&f](uint64 InStart, uint64 InEnd)
 		{
-			// Reached the end of the playback. No more frames to buffer
-			return false;
-		}
-	}
+			InEnd = std::min(InEnd, f.BufferSize);
+			if (InEnd <= InStart)
+			{
+				return;
+			}
 
-	TOCFrame& tocFrame = this->TOC.Frames[indexOfFrameToLoad];
+			TOCFrameReadRange r;
+			r.Offset = InStart;
+			r.Size = InEnd - InStart;
 
-	// get ref to previous frame
-	std::shared_ptr<Frame> previousFrame = indexOfFrameToLoad > 0 ? this->Frames[indexOfFrameToLoad - 1] : nullptr;
+			// data keeps the same 16 bytes alignment it has relative to the start of the frame
+			r.BufferOffset = f.ReadSize + ((InStart - f.ReadSize) & 15);
 
-	// if previous frame is required but isn't loaded, we need to backtrack a bit
-	if (previousFrame == nullptr && tocFrame.IsDependantOnPreviousFrame())
-	{
-		for (uint32 i = tocFrame.FrameIndexDependency; i < indexOfFrameToLoad; i++)
-		{	
-			// load as many frames as needed. However!! These frames cannot be considered as fully loaded and 
-			// buffered (because their very own dependencies might not be met)
-			this->LoadFrameAt(i);
+			f.ReadSize = r.BufferOffset + r.Size;
+			f.ReadRanges.push_back(r);
+		};
+
+		uint64 position = 0;
+		for (const TOCFrameReadRange& skipped : skippedRanges)
+		{
+			addRange(position, skipped.Offset);
+			position = std::max(position, skipped.Offset + skipped.Size);
 		}
-	}
 
-	// 
-// 	if (indexOfFrameToLoad == 0 && this->FirstFrame != nullptr)
-// 	{
-// 		this->Frames[indexOfFrameToLoad] = this->FirstFrame;
-// 	}
-// 	else
-	{
-		this->LoadFrameAt(indexOfFrameToLoad);
+		addRange(position, f.BufferSize);
 	}
 
+	// on top of its buffer, a frame retains a copy of the streams the next frames need (see 
+	// TOCFrameMesh::DetachedStreams). Compressed and predicted streams are decoded into that copy, or after the read 
+	// ranges for those used by the frame alone.
+	for (uint32 iFrame = 0; iFrame < (uint32)this->TOC.Frames.size(); iFrame++)
 	{
-		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		TOCFrame& f = this->TOC.Frames[iFrame];
+		const TOCFrame* nextFrame = iFrame + 1 < (uint32)this->TOC.Frames.size() ? &this->TOC.Frames[iFrame + 1] : nullptr;
+		const TOCFrame* frameAfterNext = iFrame + 2 < (uint32)this->TOC.Frames.size() ? &this->TOC.Frames[iFrame + 2] : nullptr;
 
-		uint32 indexOfFrameWeReallyWantLoadedNext = (this->FullyBufferedFramesStart + FullyBufferedFramesCount ) % (uint32)this->TOC.Frames.size();
+		f.DecodedOffset = (f.ReadSize + 15) & ~15ull;
+		f.DecodedSize = 0;
 
-		if (indexOfFrameToLoad == indexOfFrameWeReallyWantLoadedNext)
+		uint64 detachedSize = 0;
+
+		for (uint32 iMesh = 0; iMesh < (uint32)f.Meshes.size(); iMesh++)
 		{
-			this->FullyBufferedFramesCount++;
+			TOCFrameMesh& fm = f.Meshes[iMesh];
+
+			for (uint32 iStream = 0; iStream < NumStreams && !this->TOC.Meshes[iMesh].Constant; iStream++)
+			{
+				if (fm.GetStreamSeek(iStream) == -1)
+				{
+					continue;
+				}
+
+				// the changes of sparse streams are decoded in the frame, the stream they make up has a block of its own
+				if (fm.StreamEncodings[iStream] == StreamEncoding::Sparse)
+				{
+					fm.DecodedStreamOffsets[iStream] = f.DecodedSize;
+					f.DecodedSize = (f.DecodedSize + fm.SparseStreamSizes[iStream] + 15) & ~15ull;
+					detachedSize += fm.GetStreamSize(iStream);
+					continue;
+				}
+
+				// reused by the next frame, or the base of the linear prediction of the frame after it
+				const TOCFrameMesh* nextFrameMesh = nextFrame != nullptr ? &nextFrame->Meshes[iMesh] : nullptr;
+				const bool bReusedByNextFrame = nextFrameMesh != nullptr && nextFrameMesh->GetStreamSeek(iStream) == -1;
+				const bool bPredictedByNextFrame = nextFrameMesh != nullptr && !bReusedByNextFrame && IsPredicted(nextFrameMesh->StreamEncodings[iStream]);
+				const bool bExtrapolatedFrom = bPredictedByNextFrame && frameAfterNext != nullptr && 
+					frameAfterNext->Meshes[iMesh].GetStreamSeek(iStream) != -1 && frameAfterNext->Meshes[iMesh].StreamEncodings[iStream] == StreamEncoding::Linear;
+
+				fm.DetachedStreams[iStream] = bReusedByNextFrame || bExtrapolatedFrom;
+
+				if (fm.DetachedStreams[iStream])
+				{
+					detachedSize += fm.GetStreamSize(iStream);
+				}
+				else if (fm.StreamCodecs[iStream] != StreamCodec::None || fm.StreamEncodings[iStream] != StreamEncoding::Raw)
+				{
+					fm.DecodedStreamOffsets[iStream] = f.DecodedSize;
+					f.DecodedSize = (f.DecodedSize + fm.GetStreamSize(iStream) + 15) & ~15ull;
+				}
+			}
 		}
-		else
+
+		for (uint32 iImage = 0; iImage < (uint32)f.Images.size(); iImage++)
 		{
-			// adjust memory footprint
-			if (this->Frames[indexOfFrameToLoad] != nullptr)
+			for (uint32 iMipmap = 0; iMipmap < f.Images[iImage].NumMipmaps && iMipmap < MaxMipmaps; iMipmap++)
 			{
-				this->Profiling.MemoryUsageForFrames -= (uint64)this->Frames[indexOfFrameToLoad]->Buffer.size();
-			}
+				TOCMipmap& m = f.Images[iImage].Mipmaps[iMipmap];
 
-			this->Frames[indexOfFrameToLoad] = nullptr;
+				if (m.SeekPosition == -1)
+				{
+					continue;
+				}
+
+				if (nextFrame != nullptr && nextFrame->Images[iImage].Mipmaps[iMipmap].SeekPosition == -1)
+				{
+					detachedSize += m.Size;
+				}
+				else if (m.Codec != StreamCodec::None)
+				{
+					m.DecodedOffset = f.DecodedSize;
+					f.DecodedSize = (f.DecodedSize + m.Size + 15) & ~15ull;
+				}
+			}
 		}
-	}
 
-	// 
-	{
-		this->WaitForFrameBufferedEvent.notify_one();
+		f.RetainedSize = (f.DecodedSize > 0 ? f.DecodedOffset + f.DecodedSize : f.ReadSize) + detachedSize;
 	}
+}
 
-	return true;
 
+//-----------------------------------------------------------------------------
+// TOCReader::TOCReader
+//-----------------------------------------------------------------------------
+Kimura::TOCReader::TOCReader(const byte* InData, uint64 InSize)
+	:
+	Data(InData),
+	DataSize(InSize),
+	FileSize(InSize)
+{
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::LoadFrameAt
+// TOCReader::TOCReader
 //-----------------------------------------------------------------------------
-void Kimura::Player::LoadFrameAt(uint32 iFrame)
+Kimura::TOCReader::TOCReader(ReadFunction InReadFunction, uint64 InFileSize)
+	:
+	ReadFile(InReadFunction),
+	FileSize(InFileSize)
 {
-	KIMURA_TRACE("Kimura::Player::LoadFrameAt");
-
-	TOCFrame& tocFrame = this->TOC.Frames[iFrame];
+}
 
-	// get ref to previous frame (if any or necessary)
-	std::shared_ptr<Frame> previousFrame = iFrame > 0 ? this->Frames[iFrame - 1] : nullptr;
 
-	std::shared_ptr<Frame> newFrame = std::make_shared<Frame>();
-	newFrame->FrameIndex = iFrame;
+//-----------------------------------------------------------------------------
+// TOCReader::Reserve
+//-----------------------------------------------------------------------------
+bool Kimura::TOCReader::Reserve(uint64 InSize)
+{
+	if (this->Failed)
+	{
+		return false;
+	}
 
-	// keep references to other frames alive as long as this frame is
-	if (tocFrame.IsDependantOnPreviousFrame())
+	uint64 end = this->Position + InSize;
+	if (end > this->FileSize)
 	{
-		uint32 numFramesDependentOn = iFrame - tocFrame.FrameIndexDependency;
+		end = this->FileSize;
+	}
 
-		newFrame->FrameDependencies.reserve(numFramesDependentOn);
-		for (uint32 i = tocFrame.FrameIndexDependency; i < iFrame; i++)
-		{
-			newFrame->FrameDependencies.push_back(this->Frames[i]);
-		}
+	if (end <= this->DataSize)
+	{
+		return true;
+	}
 
+	// everything is already available when reading from memory
+	if (!this->ReadFile)
+	{
+		return true;
 	}
 
-	// allocate a buffer large enough to contain the entire frame
-	newFrame->Buffer.resize(tocFrame.BufferSize);
-	this->Profiling.BytesReadInLastSecond += tocFrame.BufferSize;
-	this->Profiling.MemoryUsageForFrames += tocFrame.BufferSize;
+	uint64 previousSize = this->Buffer.size();
+	this->Buffer.resize(end);
 
+	if (!this->ReadFile(previousSize, &this->Buffer[previousSize], end - previousSize))
 	{
-		ScopedTime s;
+		this->Failed = true;
+		return false;
+	}
 
-		KIMURA_TRACE("Kimura::Player::LoadFrameAt::read");
+	this->Data = this->Buffer.data();
+	this->DataSize = this->Buffer.size();
 
-		// seek and read the frame's content into the buffer
+	return true;
+}
 
-		uint64 positionOfFrameInFile = this->FrameDataFilePosition + tocFrame.FilePosition;
 
-#if defined(KIMURA_UNREAL)
+//-----------------------------------------------------------------------------
+// TOCReader::Require
+//-----------------------------------------------------------------------------
+bool Kimura::TOCReader::Require(uint64 InSize)
+{
+	if (this->Failed)
+	{
+		return false;
+	}
+
+	if (this->Position + InSize > this->FileSize)
+	{
+		this->Failed = true;
+		return false;
+	}
+
+	if (this->Position + InSize > this->DataSize)
+	{
+		// grow geometrically so that an underestimated table of content only costs a few more reads
+		const uint64 minimumReadSize = 64 * 1024;
 
-		bool bSeek = this->UEFileHandle->Seek(positionOfFrameInFile);
-		if (!bSeek)
+		uint64 growth = this->DataSize > minimumReadSize ? this->DataSize : minimumReadSize;
+		if (growth < InSize)
 		{
-			return this->Failure("Failed to seek in file");
+			growth = InSize;
 		}
 
-		bool bRead = this->UEFileHandle->Read((uint8*)newFrame->Buffer.data(), tocFrame.BufferSize);
-		if (!bRead)
+		if (!this->Reserve(this->DataSize + growth - this->Position))
 		{
-			return this->Failure("Failed to read frame data from file");
+			return false;
 		}
+	}
 
-#elif defined(KIMURA_WINDOWS) 
-
-
-		Kimura::uint64 newOffset = _lseeki64(this->FileHandle, positionOfFrameInFile, SEEK_SET);
-
-		int bytesRead = _read(this->FileHandle, (void*)newFrame->Buffer.data(), (unsigned int)tocFrame.BufferSize);
-
-#else
-		this->InputFile.seekg(positionOfFrameInFile);
-		this->InputFile.read((char*)newFrame->Buffer.data(), tocFrame.BufferSize);
-#endif
+	return true;
+}
 
-		this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond += s.Duration();
 
+//-----------------------------------------------------------------------------
+// TOCReader::Read
+//-----------------------------------------------------------------------------
+bool Kimura::TOCReader::Read(std::string& Out)
+{
+	int32 size = 0;
+	if (!this->Read<int32>(size))
+	{
+		return false;
 	}
 
-	// allocate mesh instances for this frame
-	newFrame->Meshes.resize(tocFrame.Meshes.size());
+	if (size > 0)
+	{
+		if (!this->Require((uint64)size))
+		{
+			return false;
+		}
 
-	byte* bufferAddress = newFrame->Buffer.data();
+		Out.assign((const char*)&this->Data[this->Position], (size_t)size);
+		this->Position += size;
+	}
 
-	ScopedTime timeProcessingFrame;
+	return true;
+}
 
 
-	for (uint32 iMesh = 0; iMesh < (uint32)newFrame->Meshes.size(); iMesh++)
+//-----------------------------------------------------------------------------
+// TOCReader::Read
+//-----------------------------------------------------------------------------
+bool Kimura::TOCReader::Read(bool& Out)
+{
+	// stored as a byte, anything but 0 is true
+	uint8 value = 0;
+	if (!this->Read<uint8>(value))
 	{
-		FrameMesh& frameMesh = newFrame->Meshes[iMesh];
+		return false;
+	}
 
-		TOCMesh& tocMesh = this->TOC.Meshes[iMesh];
-		TOCFrameMesh& tocFrameMesh = tocFrame.Meshes[iMesh];
+	Out = value != 0;
+	return true;
+}
 
-		frameMesh.Vertices = tocFrameMesh.Vertices;
-		frameMesh.Surfaces = tocFrameMesh.Surfaces;
 
-		// a simple copy of the frame mesh's sections
-		frameMesh.Sections = tocFrameMesh.Sections;
+//-----------------------------------------------------------------------------
+// Player::ExecuteTask
+//-----------------------------------------------------------------------------
+void Kimura::Player::ExecuteTask(std::chrono::steady_clock::time_point InDeadline)
+{
+	if (this->Status == PlayerStatus::Initializing && !this->StopThreadExecution)
+	{
+		this->Open();
+	}
 
-		frameMesh.PositionQuantizationCenter = tocFrameMesh.PositionQuantizationCenter;
-		frameMesh.PositionQuantizationExtents = tocFrameMesh.PositionQuantizationExtents;
+	// one load at a time, the next one is queued with its own deadline
+	bool bBufferedFrames = false;
 
-		frameMesh.VelocityQuantizationCenter = tocFrameMesh.VelocityQuantizationCenter;
-		frameMesh.VelocityQuantizationExtents = tocFrameMesh.VelocityQuantizationExtents;
+	if (this->Status == PlayerStatus::Ready && !this->StopThreadExecution)
+	{
+		const uint32 numFramesLoaded = this->NumFramesLoaded;
+		ScopedTime timeLoadingFrames;
 
-		frameMesh.ColorQuantizationExtents[0] = tocFrameMesh.ColorQuantizationExtents[0];
-		frameMesh.ColorQuantizationExtents[1] = tocFrameMesh.ColorQuantizationExtents[1];
+		// frames explicitly requested come first. The bulk load tasks take care of the others, if any.
+		bBufferedFrames = this->LoadRequestedFrame();
 
-		// copy bounds info
-		frameMesh.BoundingCenter = tocFrameMesh.BoundingCenter;
-		frameMesh.BoundingSize = tocFrameMesh.BoundingSize;
+		if (!bBufferedFrames && this->BulkLoadRanges.empty())
+		{
+#if defined(KIMURA_IO_URING)
+			bBufferedFrames = this->Ring != nullptr ? this->BufferNextFramesAsync() : this->BufferNextFrame();
+#else
+			bBufferedFrames = this->BufferNextFrame();
+#endif
+		}
 
-		// number of vertices stored in this frame determines the type of index buffer used
-		if (frameMesh.Vertices <= 0xfffe || this->TOC.Force16BitIndices)
+		// how long frames take to load, the prebuffering window grows along with it
+		if (this->NumFramesLoaded > numFramesLoaded)
 		{
-			// 16bit indices
+			const double frameLoadTime = timeLoadingFrames.Duration() / (double)(this->NumFramesLoaded - numFramesLoaded);
 
-			if (tocFrameMesh.SeekIndices == -1)
-			{
-				// re-use previous frame's indices
-				if (previousFrame != nullptr)
-				{
-					frameMesh.IndicesU16 = previousFrame->Meshes[iMesh].IndicesU16;
-				}
-			}
-			else if (tocFrameMesh.SizeIndices > 0)
+			std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+			this->FrameLoadTime = this->FrameLoadTime == 0.0 ? frameLoadTime : this->FrameLoadTime * 0.9 + frameLoadTime * 0.1;
+
+			if (std::chrono::steady_clock::now() > InDeadline)
 			{
-				frameMesh.IndicesU16 = (uint16*)&bufferAddress[tocFrameMesh.SeekIndices];
+				this->Profiling.NumDeadlineMisses++;
 			}
 		}
-		else
-		{
-			// 32bit indices
 
-			if (tocFrameMesh.SeekIndices == -1)
-			{
-				// re-use previous frame's indices
-				if (previousFrame != nullptr)
-				{
-					frameMesh.IndicesU32 = previousFrame->Meshes[iMesh].IndicesU32;
-				}
-			}
-			else if (tocFrameMesh.SizeIndices > 0)
-			{
-				frameMesh.IndicesU32 = (uint32*)&bufferAddress[tocFrameMesh.SeekIndices];
-			}
+		// residency is relatively expensive to query, the loader does so at most once a second rather than every 
+		// time stats are collected. SourceData is only set once the source is opened, at which point it no longer changes.
+		if (this->SourceData != nullptr && std::chrono::steady_clock::now() > this->NextResidencyQuery)
+		{
+			this->Counters.MappedResidentBytes = this->Source->GetResidentBytes();
+			this->NextResidencyQuery = std::chrono::steady_clock::now() + std::chrono::seconds(1);
 		}
+	}
+
+	// when buffer is full or contains sufficient frames, the player rests until more work is requested
+	{
+		std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+
+		const bool bResubmit = (bBufferedFrames || this->WakeUpRequested) && this->Status == PlayerStatus::Ready && !this->StopThreadExecution;
+		this->WakeUpRequested = false;
 
-		// position
-		switch (tocMesh.PositionFormat_)
+		if (!bResubmit)
 		{
-			case PositionFormat::Full:
-			{
-				if (tocFrameMesh.SeekPositions == -1)
-				{
-					// re-use previous frame's positions
-					if (previousFrame != nullptr)
-					{
-						frameMesh.PositionsF32 = previousFrame->Meshes[iMesh].PositionsF32;
-					}
-				}
-				else if (tocFrameMesh.SizePositions > 0)
-				{
-					frameMesh.PositionsF32 = (Vector3*) &bufferAddress[tocFrameMesh.SeekPositions];
-				}
+			// the player may be destroyed as soon as the lock is released
+			this->TaskSubmitted = false;
+			this->TaskCompletedEvent.notify_all();
+			return;
+		}
+	}
 
-				break;
+	DeadlineScheduler::Get().Schedule(this, this->TaskScheduler, this->GetLoadDeadline());
+}
 
-			}
 
-			case PositionFormat::Half:
-			{				
-				if (tocFrameMesh.SeekPositions == -1)
-				{
-					// re-use previous frame's positions
-					if (previousFrame != nullptr)
-					{
-						frameMesh.PositionsI16 = previousFrame->Meshes[iMesh].PositionsI16;
-					}
+//-----------------------------------------------------------------------------
+// Player::GetLoadDeadline
+//-----------------------------------------------------------------------------
+std::chrono::steady_clock::time_point Kimura::Player::GetLoadDeadline()
+{
+	std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	// opening comes first
+	if (this->Status != PlayerStatus::Ready || this->Frames.empty())
+	{
+		return now;
+	}
+
+	// requested frames are loaded ahead of the window, as soon as possible
+	if (!this->PendingFrameRequests.empty())
+	{
+		return this->PendingFrameRequests.front().RequestTime;
+	}
+
+	const uint32 numSteps = (uint32)this->Frames.size();
+	const uint32 numStepsAhead = this->FullyBufferedFramesCount;
+
+	// the application is already waiting, the longest first
+	if (this->IsStepAwaited((this->FullyBufferedFramesStart + numStepsAhead) % numSteps))
+	{
+		return this->LastRequestTime;
+	}
+
+	double requestRate = this->FrameRequestRate;
+	if (requestRate <= 0.0)
+	{
+		requestRate = this->TOC.TimePerFrame > 0.0f && this->Options.PlaybackSpeed > 0.0f ? this->Options.PlaybackSpeed / this->TOC.TimePerFrame : 30.0;
+	}
+
+	// the first buffered frame is the one the application last asked for. A player that stopped asking is treated 
+	// as if it were about to resume.
+	const double timeFromLastRequest = numStepsAhead / requestRate;
+	const double timeFromNow = (numStepsAhead - 1) / requestRate;
+
+	const std::chrono::steady_clock::time_point deadline = std::max(
+		this->LastRequestTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeFromLastRequest)),
+		now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeFromNow)));
+
+	return deadline;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::IsSourceDataAligned
+//-----------------------------------------------------------------------------
+bool Kimura::Player::IsSourceDataAligned() const
+{
+	// streams stored as is are handed out as typed pointers into the source, which must be aligned to their elements
+	for (const TOCFrame& f : this->TOC.Frames)
+	{
+		const uint64 positionOfFrameInFile = this->FrameDataFilePosition + f.FilePosition;
+
+		for (uint32 iMesh = 0; iMesh < (uint32)f.Meshes.size(); iMesh++)
+		{
+			const TOCFrameMesh& fm = f.Meshes[iMesh];
+
+			for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+			{
+				const int32 seek = fm.GetStreamSeek(iStream);
+				if (seek < 0 || fm.GetStreamSize(iStream) == 0 || fm.StreamCodecs[iStream] != StreamCodec::None || fm.StreamEncodings[iStream] != StreamEncoding::Raw)
+				{
+					continue;
 				}
-				else if (tocFrameMesh.SizePositions > 0)
+
+				const uint64 address = (uint64)(uintptr_t)&this->SourceData[positionOfFrameInFile + seek];
+				if (address % this->GetStreamAlignment(this->TOC.Meshes[iMesh], fm, iStream) != 0)
 				{
-					frameMesh.PositionsI16 = (int16*)&bufferAddress[tocFrameMesh.SeekPositions];
+					return false;
 				}
+			}
+		}
+	}
 
-				break;
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetStreamAlignment
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetStreamAlignment(const TOCMesh& InMesh, const TOCFrameMesh& InFrameMesh, uint32 InStream) const
+{
+	if (InStream == StreamIndices)
+	{
+		return this->GetIndexSize(InFrameMesh);
+	}
+
+	if (InStream >= StreamColors)
+	{
+		switch (InMesh.ColorFormat_)
+		{
+			case ColorFormat::Full:		return 4;
+			case ColorFormat::Half:		return 2;
+			default:					return 1;
+		}
+	}
+
+	if (InStream >= StreamTexCoords)
+	{
+		return InMesh.TexCoordFormat_ == TexCoordFormat::Half ? 2 : 4;
+	}
+
+	return std::max(1u, InMesh.GetComponentSize(InStream));
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::Open
+//-----------------------------------------------------------------------------
+bool Kimura::Player::Open()
+{
+
+	// open the file, unless a source was provided
+	if (this->Source == nullptr)
+	{
+		if (this->InputFilePath.empty())
+		{
+			this->Failure("No input file or byte source provided");
+			return false;
+		}
+
+		this->Source = CreateFileByteSource(this->InputFilePath, this->Options.MemoryMapFile);
+		if (this->Source == nullptr)
+		{
+			this->Failure("Failed to open the input file: ");
+			return false;
+		}
+	}
+
+	this->SourceData = this->Source->Map();
+
+	// read the table of content
+	{
+		bool bTOCRead = false;
+
+		if (this->SourceData != nullptr)
+		{
+			// parse straight from memory
+			TOCReader reader(this->SourceData, this->Source->GetSize());
+			bTOCRead = this->ReadTOC(reader);
+		}
+		else
+		{
+			IByteSource* source = this->Source.get();
+			TOCReader reader([source](uint64 InOffset, void* OutData, uint64 InSize) { return source->ReadAt(InOffset, OutData, InSize); }, source->GetSize());
+			bTOCRead = this->ReadTOC(reader);
+		}
+
+		if (!bTOCRead)
+		{
+			// failed
+			return false;
+		}
+
+		// frames of a source whose streams aren't aligned are read into buffers of their own instead, where they are
+		if (this->SourceData != nullptr && !this->IsSourceDataAligned())
+		{
+			this->SourceData = nullptr;
+		}
+
+#if defined(KIMURA_IO_URING)
+		if (this->Options.IOQueueDepth > 1 && this->SourceData == nullptr && this->Source->GetFileDescriptor() >= 0)
+		{
+			// when the ring can't be created (old kernel, sandboxing, etc), keep reading synchronously
+			std::unique_ptr<IOUring> ring(new IOUring());
+			if (ring->Initialize(this->Options.IOQueueDepth))
+			{
+				this->Ring = std::move(ring);
+			}
+		}
+#endif
+	}
+
+	// adjust buffering sizes
+	if (this->Options.BufferEntirePlayback || this->Options.PreBufferingSize > (uint32)this->Frames.size())
+	{
+		this->Options.PreBufferingSize = (uint32)this->Frames.size();
+	}
+
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		if (this->Options.AdaptivePreBuffering && !this->Options.BufferEntirePlayback)
+		{
+			const uint32 numSteps = (uint32)this->Frames.size();
+			this->Options.MinPreBufferingSize = std::max(1u, std::min(this->Options.MinPreBufferingSize, numSteps));
+			this->Options.MaxPreBufferingSize = std::max(this->Options.MinPreBufferingSize, std::min(this->Options.MaxPreBufferingSize, numSteps));
+			this->Options.PreBufferingSize = std::max(this->Options.MinPreBufferingSize, std::min(this->Options.PreBufferingSize, this->Options.MaxPreBufferingSize));
+
+			// what's read for each frame is what it costs to buffer
+			uint64 totalReadSize = 0;
+			for (const TOCFrame& f : this->TOC.Frames)
+			{
+				totalReadSize += f.ReadSize;
+			}
+			this->AverageFrameReadSize = totalReadSize / std::max<uint64>(1, this->TOC.Frames.size());
+		}
+
+		this->PreBufferingSize = this->Options.PreBufferingSize;
+		this->RequestRateMeasureStart = std::chrono::steady_clock::now();
+		this->LastRequestTime = this->RequestRateMeasureStart;
+	}
+
+	// constant meshes are loaded right away, once and for all
+	if (!this->LoadConstantMeshes())
+	{
+		return false;
+	}
+
+	// so are the bases positions are reconstructed from
+	if (!this->LoadMeshBases())
+	{
+		return false;
+	}
+
+	// if any of the image sequences stored in the file is flagged as constant, we should read that frame and store it 
+	// immediately. 
+	bool bBufferFirstFrame = false;
+	for (const auto& imageSequence : this->TOC.ImageSequences)
+	{
+		if (imageSequence.Constant)
+		{
+			bBufferFirstFrame = true;
+			break;
+		}
+	}
+	if (bBufferFirstFrame)
+	{
+		this->FirstFrame = this->LoadFrameAt(0, nullptr);
+		if (this->FirstFrame == nullptr)
+		{
+			return false;
+		}
+	}
+
+	// success! ready to start loading frames. Not before, the application reads what's set up above as soon as
+	// the player is ready.
+	{
+		std::unique_lock<std::mutex> lock(this->ProfilingMutex);
+		this->StoredProfiling.OpenToReadyTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->CreationTime).count();
+	}
+
+	this->Status = PlayerStatus::Ready;
+
+	// the bulk load tasks stop as soon as the player isn't ready
+	if (this->Options.BufferEntirePlayback && this->Options.NumBulkLoadTasks > 1)
+	{
+		this->StartBulkLoad();
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::LoadConstantMeshes
+//-----------------------------------------------------------------------------
+bool Kimura::Player::LoadConstantMeshes()
+{
+	KIMURA_TRACE("Kimura::Player::LoadConstantMeshes");
+
+	this->ConstantMeshes.resize(this->TOC.Meshes.size());
+
+	if (this->TOC.Frames.empty())
+	{
+		return true;
+	}
+
+	// constant meshes are found in the first frame
+	const TOCFrame& tocFrame = this->TOC.Frames[0];
+	const uint64 positionOfFrameInFile = this->FrameDataFilePosition + tocFrame.FilePosition;
+
+	for (uint32 iMesh = 0; iMesh < this->TOC.Meshes.size(); iMesh++)
+	{
+		if (!this->TOC.Meshes[iMesh].Constant)
+		{
+			continue;
+		}
+
+		const TOCFrameMesh& tocFrameMesh = tocFrame.Meshes[iMesh];
+		FrameMesh& constantMesh = this->ConstantMeshes[iMesh];
+
+		// streams of a mapped source are pointed to directly, unless they need to be decompressed
+		auto isInPlace = [this, &tocFrameMesh](uint32 InStream)
+		{
+			return this->SourceData != nullptr && tocFrameMesh.StreamCodecs[InStream] == StreamCodec::None;
+		};
+
+		// all of the other streams share a single block
+		uint64 blockSize = 0;
+		for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+		{
+			if (tocFrameMesh.GetStreamSeek(iStream) >= 0 && !isInPlace(iStream))
+			{
+				blockSize = ((blockSize + 15) & ~15ull) + tocFrameMesh.GetStreamSize(iStream);
 			}
 		}
 
-		// normal
-		switch (tocMesh.NormalFormat_)
+		std::shared_ptr<PooledBuffer> block = blockSize > 0 ? std::make_shared<PooledBuffer>(this->FrameBufferPool->Acquire(blockSize)) : nullptr;
+		if (block != nullptr && block->GetData() == nullptr)
 		{
-			case NormalFormat::Full:
+			this->Failure("Failed to allocate memory for constant mesh");
+			return false;
+		}
+
+		uint64 offset = 0;
+		for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+		{
+			const int32 seek = tocFrameMesh.GetStreamSeek(iStream);
+			const uint32 size = tocFrameMesh.GetStreamSize(iStream);
+			const uint32 storedSize = tocFrameMesh.StoredStreamSizes[iStream];
+
+			if (seek < 0 || size == 0)
+			{
+				continue;
+			}
+
+			if (isInPlace(iStream))
 			{
-				if (tocFrameMesh.SeekNormals == -1)
+				constantMesh.Streams[iStream] = &this->SourceData[positionOfFrameInFile + seek];
+				continue;
+			}
+
+			offset = (offset + 15) & ~15ull;
+
+			if (tocFrameMesh.StreamCodecs[iStream] == StreamCodec::None)
+			{
+				if (!this->Source->ReadAt(positionOfFrameInFile + seek, &block->GetData()[offset], size))
+				{
+					this->Failure("Failed to read constant mesh data from file");
+					return false;
+				}
+			}
+			else
+			{
+				// the compressed stream is only needed while it's decompressed
+				PooledBuffer compressed;
+				const byte* data = this->SourceData != nullptr ? &this->SourceData[positionOfFrameInFile + seek] : nullptr;
+
+				if (data == nullptr)
 				{
-					if (previousFrame != nullptr)
+					compressed = this->FrameBufferPool->Acquire(storedSize);
+					if (compressed.GetData() == nullptr)
+					{
+						this->Failure("Failed to allocate memory for constant mesh");
+						return false;
+					}
+
+					if (!this->Source->ReadAt(positionOfFrameInFile + seek, compressed.GetData(), storedSize))
 					{
-						frameMesh.NormalsF32 = previousFrame->Meshes[iMesh].NormalsF32;
+						this->Failure("Failed to read constant mesh data from file");
+						return false;
 					}
+
+					data = compressed.GetData();
 				}
-				else if (tocFrameMesh.SizeNormals > 0)
+
+				StreamDecodeJob job;
+				job.Codec = tocFrameMesh.StreamCodecs[iStream];
+				job.Data = data;
+				job.StoredSize = storedSize;
+				job.Decoded = &block->GetData()[offset];
+				job.Size = size;
+
+				if (!DecodeStream(job, this->Options.StreamDecoder.get()))
 				{
-					frameMesh.NormalsF32 = (Vector3*) &bufferAddress[tocFrameMesh.SeekNormals];
+					this->Failure("Failed to decompress constant mesh data");
+					return false;
 				}
+			}
 
-				break;
+			constantMesh.Streams[iStream] = &block->GetData()[offset];
+			constantMesh.StreamBlocks[iStream] = block;
+
+			offset += size;
+		}
+
+		this->Counters.BytesRead += blockSize;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::LoadMeshBases
+//-----------------------------------------------------------------------------
+bool Kimura::Player::LoadMeshBases()
+{
+	KIMURA_TRACE("Kimura::Player::LoadMeshBases");
+
+	this->MeshBases.resize(this->TOC.Meshes.size());
+
+	for (uint32 iMesh = 0; iMesh < this->TOC.Meshes.size(); iMesh++)
+	{
+		const TOCMesh& tocMesh = this->TOC.Meshes[iMesh];
+		MeshBasis& basis = this->MeshBases[iMesh];
+
+		if (tocMesh.NumBasisVectors == 0)
+		{
+			continue;
+		}
+
+		// vectors come in order of importance, only the first ones are needed to stay within the error bound
+		basis.NumVectors = tocMesh.NumBasisVectors;
+		if (this->Options.MaxBasisError > 0.0f)
+		{
+			for (uint32 i = 0; i < (uint32)tocMesh.BasisErrors.size(); i++)
+			{
+				if (tocMesh.BasisErrors[i] <= this->Options.MaxBasisError)
+				{
+					basis.NumVectors = i + 1;
+					break;
+				}
 			}
+		}
+
+		// the mean shape and the vectors are contiguous, read in one go. A corrupted header fails here rather than on 
+		// allocation, without overflowing.
+		const uint64 sourceSize = this->Source->GetSize();
+		const uint64 basisPosition = this->FrameDataFilePosition + tocMesh.BasisPosition;
+		const uint64 maxFloats = basisPosition >= this->FrameDataFilePosition && basisPosition <= sourceSize ? (sourceSize - basisPosition) / sizeof(float) : 0;
+
+		if (tocMesh.MaxVertices == 0 || tocMesh.MaxVertices > maxFloats / 3 || basis.NumVectors + 1ull > maxFloats / (tocMesh.MaxVertices * 3))
+		{
+			this->Failure("Mesh basis lies past the end of the file");
+			return false;
+		}
+
+		basis.NumFloats = tocMesh.MaxVertices * 3;
+		basis.Data.resize(basis.NumFloats * (basis.NumVectors + 1));
+
+		const uint64 size = basis.Data.size() * sizeof(float);
+		if (!this->Source->ReadAt(basisPosition, basis.Data.data(), size))
+		{
+			this->Failure("Failed to read mesh basis from file");
+			return false;
+		}
+
+		this->Counters.BytesRead += size;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::BufferNextFrame
+//-----------------------------------------------------------------------------
+bool Kimura::Player::BufferNextFrame()
+{
+	const bool bPipelined = this->Options.NumDecodeTasks > 0;
+
+	// find the index of the next frame to buffer
+	uint32 stepToLoad = 0;
+	uint32 indexOfFrameToLoad = 0;	
+	std::shared_ptr<Frame> bufferedFrame = nullptr;
+	std::shared_ptr<Frame> previousFrame = nullptr;
+	bool bNeedsMemory = false;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		// frames still being decoded come first
+		uint64 numBytesInFlight = 0;
+		std::shared_ptr<Frame> lastFrameInFlight = nullptr;
+		const uint32 numFramesInFlight = this->GetFramesInFlight(numBytesInFlight, lastFrameInFlight);
+
+		if (this->FullyBufferedFramesCount + numFramesInFlight >= this->PreBufferingSize)
+		{
+			// sufficient number of frames are already buffered. There's no need to buffer another frame at this time. 
+			return false;
+		}
+
+		if (bPipelined && this->DecodeQueue.size() >= this->Options.DecodeQueueDepth)
+		{
+			// decoding can't keep up, the task publishing the frames wakes the player up
+			return false;
+		}
+
+		stepToLoad = this->FullyBufferedFramesStart + this->FullyBufferedFramesCount + numFramesInFlight;
+		
+		if (this->Options.Loop)
+		{
+			// wrap around
+			stepToLoad %= (uint32)this->Frames.size();
+		}
+		else if (stepToLoad >= (uint32)this->Frames.size())
+		{
+			// Reached the end of the playback. No more frames to buffer
+			return false;
+		}
+
+		indexOfFrameToLoad = this->GetFrameAtStep(stepToLoad);
+
+		// in ping pong, frames around the turning points are played twice in a row
+		bufferedFrame = this->FindBufferedFrame(indexOfFrameToLoad);
+
+		if (bufferedFrame == nullptr && !this->FitsBufferedBytesBudget(stepToLoad, numBytesInFlight))
+		{
+			return false;
+		}
+
+		bNeedsMemory = !this->IsStepAwaited(stepToLoad);
+
+		if (lastFrameInFlight != nullptr && lastFrameInFlight->FrameIndex + 1 == indexOfFrameToLoad)
+		{
+			previousFrame = lastFrameInFlight;
+		}
+	}
+
+	if (bufferedFrame != nullptr)
+	{
+		if (bPipelined)
+		{
+			this->QueueFrameForDecode(bufferedFrame, nullptr, nullptr, stepToLoad, true);
+		}
+		else
+		{
+			this->PublishFrame(bufferedFrame, stepToLoad);
+		}
+
+		this->NumFramesLoaded++;
+		return true;
+	}
+
+	// frames the application is waiting for are always loaded, the shared budget only limits those buffered ahead
+	if (bNeedsMemory && !this->AdmitMemory(this->SourceData != nullptr ? 0 : this->TOC.Frames[indexOfFrameToLoad].RetainedSize))
+	{
+		return false;
+	}
+
+	TOCFrame& tocFrame = this->TOC.Frames[indexOfFrameToLoad];
+
+	// get ref to previous frame
+	if (previousFrame == nullptr)
+	{
+		previousFrame = this->GetBufferedPredecessor(indexOfFrameToLoad);
+	}
+
+	// if previous frame is required but isn't loaded (ex: after a seek, or when playing backwards), gather the 
+	// streams this frame reuses rather than loading the entire chain of frames leading to it
+	if (previousFrame == nullptr && tocFrame.Keyframe != indexOfFrameToLoad)
+	{
+		previousFrame = this->ResolvePredecessor(indexOfFrameToLoad);
+		if (previousFrame == nullptr)
+		{
+			return false;
+		}
+	}
+
+	if (bPipelined)
+	{
+		byte* bufferAddress = nullptr;
+		std::shared_ptr<Frame> frame = this->ReadFrame(indexOfFrameToLoad, bufferAddress);
+		if (frame == nullptr)
+		{
+			return false;
+		}
+
+		this->QueueFrameForDecode(frame, bufferAddress, previousFrame, stepToLoad, false);
+	}
+	else
+	{
+		std::shared_ptr<Frame> frame = this->LoadFrameAt(indexOfFrameToLoad, previousFrame);
+		if (frame == nullptr)
+		{
+			return false;
+		}
+
+		this->PublishFrame(frame, stepToLoad);
+	}
+
+	this->NumFramesLoaded++;
+
+	return true;
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::BufferNextFramesAsync
+//-----------------------------------------------------------------------------
+bool Kimura::Player::BufferNextFramesAsync()
+{
+#if defined(KIMURA_IO_URING)
+
+	KIMURA_TRACE("Kimura::Player::BufferNextFramesAsync");
+
+	const uint32 numSteps = (uint32)this->Frames.size();
+	const bool bPipelined = this->Options.NumDecodeTasks > 0;
+
+	// find the range of frames that should be buffered next
+	uint32 firstStepToLoad = 0;
+	uint32 numFramesToLoad = 0;
+	uint64 numBytesToAdmit = 0;
+	uint64 numBytesInFlight = 0;
+	std::shared_ptr<Frame> lastFrameInFlight = nullptr;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		// after the frames still being decoded
+		const uint32 numFramesInFlight = this->GetFramesInFlight(numBytesInFlight, lastFrameInFlight);
+
+		if (this->FullyBufferedFramesCount + numFramesInFlight >= this->PreBufferingSize)
+		{
+			return false;
+		}
+
+		firstStepToLoad = this->FullyBufferedFramesStart + this->FullyBufferedFramesCount + numFramesInFlight;
+		numFramesToLoad = std::min(this->PreBufferingSize - this->FullyBufferedFramesCount - numFramesInFlight, this->Ring->GetQueueDepth());
+
+		if (bPipelined)
+		{
+			const uint32 numFramesQueued = (uint32)this->DecodeQueue.size();
+			if (numFramesQueued >= this->Options.DecodeQueueDepth)
+			{
+				return false;
+			}
+
+			numFramesToLoad = std::min(numFramesToLoad, this->Options.DecodeQueueDepth - numFramesQueued);
+		}
+
+		if (this->Options.Loop)
+		{
+			firstStepToLoad %= numSteps;
+		}
+		else if (firstStepToLoad >= numSteps)
+		{
+			return false;
+		}
+		else
+		{
+			numFramesToLoad = std::min(numFramesToLoad, numSteps - firstStepToLoad);
+		}
+
+		// only take the frames the memory budget allows for. If none, the synchronous path will decide.
+		uint64 numBytesPending = numBytesInFlight;
+		for (uint32 i = 0; i < numFramesToLoad; i++)
+		{
+			const uint32 step = (firstStepToLoad + i) % numSteps;
+			if (!this->FitsBufferedBytesBudget(step, numBytesPending))
+			{
+				numFramesToLoad = std::max(i, 1u);
+				break;
+			}
+
+			const uint64 frameBytes = this->SourceData != nullptr ? 0 : this->TOC.Frames[this->GetFrameAtStep(step)].RetainedSize;
+			numBytesPending += frameBytes;
+
+			if (!this->IsStepAwaited(step))
+			{
+				numBytesToAdmit += frameBytes;
+			}
+		}
+	}
+
+	// when the first frame needs to backtrack through its dependencies, or is already buffered, let the synchronous 
+	// path take care of it
+	const uint32 firstFrameToLoad = this->GetFrameAtStep(firstStepToLoad);
+
+	std::shared_ptr<Frame> firstPreviousFrame = lastFrameInFlight != nullptr && lastFrameInFlight->FrameIndex + 1 == firstFrameToLoad ? lastFrameInFlight : this->GetBufferedPredecessor(firstFrameToLoad);
+	if (this->TOC.Frames[firstFrameToLoad].Keyframe != firstFrameToLoad && firstPreviousFrame == nullptr)
+	{
+		return this->BufferNextFrame();
+	}
+
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		if (this->FindBufferedFrame(firstFrameToLoad) != nullptr || !this->FitsBufferedBytesBudget(firstStepToLoad, numBytesInFlight))
+		{
+			threadLock.unlock();
+			return this->BufferNextFrame();
+		}
+	}
+
+	// the shared budget may not have room for the whole batch, the synchronous path goes frame by frame
+	if (numBytesToAdmit > 0 && !this->AdmitMemory(numBytesToAdmit))
+	{
+		return this->BufferNextFrame();
+	}
+
+	// each frame of the batch is set up from the previous one, which only holds while playing forward. A frame that 
+	// doesn't depend on its predecessor can always be part of it.
+	for (uint32 i = 1; i < numFramesToLoad; i++)
+	{
+		const uint32 iFrame = this->GetFrameAtStep((firstStepToLoad + i) % numSteps);
+		if (iFrame != this->GetFrameAtStep((firstStepToLoad + i - 1) % numSteps) + 1 && this->TOC.Frames[iFrame].Keyframe != iFrame)
+		{
+			numFramesToLoad = i;
+			break;
+		}
+	}
+
+	struct PendingFrame
+	{
+		std::shared_ptr<Frame>	Frame_;
+		byte*					BufferAddress = nullptr;
+		uint64					FilePosition = 0;
+		uint32					NumReadsPending = 0;
+		uint32					Step = 0;
+	};
+
+	std::vector<PendingFrame> pendingFrames(numFramesToLoad);
+
+	// frames are made of one read per read range. Don't queue more reads than the ring can hold, but always take the 
+	// first frame.
+	{
+		uint32 numReads = 0;
+		for (uint32 i = 0; i < numFramesToLoad; i++)
+		{
+			numReads += (uint32)this->TOC.Frames[this->GetFrameAtStep((firstStepToLoad + i) % numSteps)].ReadRanges.size();
+			if (i > 0 && numReads > this->Ring->GetQueueDepth())
+			{
+				numFramesToLoad = i;
+				pendingFrames.resize(numFramesToLoad);
+				break;
+			}
+		}
+	}
+
+	// allocate all the frames and send all the reads at once
+	uint32 numReadsQueued = 0;
+	for (uint32 i = 0; i < numFramesToLoad; i++)
+	{
+		PendingFrame& p = pendingFrames[i];
+
+		p.Step = (firstStepToLoad + i) % numSteps;
+		uint32 iFrame = this->GetFrameAtStep(p.Step);
+
+		p.Frame_ = this->AllocateFrame(iFrame, p.BufferAddress);
+		if (p.Frame_ == nullptr)
+		{
+			this->Ring->DiscardQueued();
+			return false;
+		}
+
+		p.FilePosition = this->FrameDataFilePosition + this->TOC.Frames[iFrame].FilePosition;
+
+		const std::vector<TOCFrameReadRange>& readRanges = this->TOC.Frames[iFrame].ReadRanges;
+		for (uint32 iRange = 0; iRange < (uint32)readRanges.size(); iRange++)
+		{
+			const TOCFrameReadRange& r = readRanges[iRange];
+
+			if (this->Ring->QueueRead(this->Source->GetFileDescriptor(), p.FilePosition + r.Offset, &p.Frame_->Buffer.GetData()[r.BufferOffset], (uint32)r.Size, ((uint64)i << 32) | iRange))
+			{
+				p.NumReadsPending++;
+				numReadsQueued++;
+			}
+			else
+			{
+				// the ring is full (a frame with more ranges than the queue depth), read the range right away
+				if (!this->Source->ReadAt(p.FilePosition + r.Offset, &p.Frame_->Buffer.GetData()[r.BufferOffset], r.Size))
+				{
+					// nothing was submitted yet, the reads queued so far mustn't be on the next call
+					this->Ring->DiscardQueued();
+					this->Failure("Failed to read frame data from file");
+					return false;
+				}
+			}
+		}
+	}
+
+	// reads left in flight would keep landing in the frames' buffers once released. When the ring can't wait for them, 
+	// it's dropped and those buffers are leaked rather than handed back to the pool.
+	auto abandonReads = [this, &pendingFrames]()
+	{
+		if (!this->Ring->Drain())
+		{
+			for (PendingFrame& p : pendingFrames)
+			{
+				if (p.Frame_ != nullptr && p.NumReadsPending > 0)
+				{
+					p.Frame_->Buffer.Leak();
+				}
+			}
+		}
+
+		// go back to synchronous reads from now on
+		this->Ring = nullptr;
+	};
+
+	if (!this->Ring->Submit())
+	{
+		// some of the reads may have been submitted
+		abandonReads();
+		return this->BufferNextFrame();
+	}
+
+	// reads complete in any order, but frames must be set up and published in order since each frame may point into 
+	// its predecessor.
+	uint32 numCompleted = 0;
+	uint32 nextFrameToPublish = 0;
+	bool bReadFailed = false;
+	bool bDiscardRemainingFrames = false;
+	std::shared_ptr<Frame> previousFrameInBatch = firstPreviousFrame;
+
+	while (numCompleted < numReadsQueued || (!bReadFailed && nextFrameToPublish < numFramesToLoad))
+	{
+		// publish the next frame as soon as all of its reads are done. After a failure, only wait for the reads still 
+		// in flight, they can't be left running while their buffers get released.
+		if (!bReadFailed && nextFrameToPublish < numFramesToLoad && pendingFrames[nextFrameToPublish].NumReadsPending == 0)
+		{
+			PendingFrame& next = pendingFrames[nextFrameToPublish];
+			uint32 iFrame = next.Frame_->FrameIndex;
+
+			if (bPipelined)
+			{
+				// decoded elsewhere, and published in order along with the frames it follows
+				this->QueueFrameForDecode(next.Frame_, next.BufferAddress, previousFrameInBatch, next.Step, false);
+				this->NumFramesLoaded++;
+
+				previousFrameInBatch = next.Frame_;
+				next.Frame_ = nullptr;
+				nextFrameToPublish++;
+
+				continue;
+			}
+
+			// the buffering window may have moved while reading. When that happens, the remaining frames lose the 
+			// predecessor they rely on.
+			std::shared_ptr<Frame> previousFrame = this->GetBufferedPredecessor(iFrame);
+			if (this->TOC.Frames[iFrame].Keyframe != iFrame && previousFrame == nullptr)
+			{
+				bDiscardRemainingFrames = true;
+			}
+
+			if (!bDiscardRemainingFrames)
+			{
+				this->SetupFrame(next.Frame_, next.BufferAddress, previousFrame);
+				this->PublishFrame(next.Frame_, next.Step);
+				this->NumFramesLoaded++;
+			}
+
+			next.Frame_ = nullptr;
+			nextFrameToPublish++;
+
+			continue;
+		}
+
+		uint64 userData = 0;
+		int32 result = 0;
+
+		{
+			ScopedTime s;
+
+			if (!this->Ring->WaitForCompletion(userData, result))
+			{
+				// the frames of the batch not published yet are dropped, and loaded again synchronously
+				abandonReads();
+				return this->BufferNextFrame();
+			}
+
+			this->Counters.ReadTime += s.Nanoseconds();
+		}
+
+		PendingFrame& p = pendingFrames[userData >> 32];
+		const TOCFrameReadRange& r = this->TOC.Frames[p.Frame_->FrameIndex].ReadRanges[userData & 0xffffffff];
+
+		// short or failed reads are completed synchronously
+		uint64 numBytesRead = result > 0 ? (uint64)result : 0;
+		if (numBytesRead < r.Size)
+		{
+			if (!this->Source->ReadAt(p.FilePosition + r.Offset + numBytesRead, &p.Frame_->Buffer.GetData()[r.BufferOffset + numBytesRead], r.Size - numBytesRead))
+			{
+				bReadFailed = true;
+			}
+		}
+
+		p.NumReadsPending--;
+		numCompleted++;
+	}
+
+	if (bReadFailed)
+	{
+		this->Failure("Failed to read frame data from file");
+		return false;
+	}
+
+	return true;
+
+#else
+
+	return this->BufferNextFrame();
+
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::PublishFrame
+//-----------------------------------------------------------------------------
+void Kimura::Player::PublishFrame(std::shared_ptr<Frame> InFrame, uint32 InStep)
+{
+	std::vector<FrameRequest> frameRequests;
+	bool bFullyResident = false;
+
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		uint32 stepWeReallyWantLoadedNext = (this->FullyBufferedFramesStart + FullyBufferedFramesCount ) % (uint32)this->Frames.size();
+
+		// otherwise, the buffering window moved while the frame was loading. It's simply dropped.
+		if (InStep == stepWeReallyWantLoadedNext)
+		{
+			// on short clips, the window may wrap around into the back buffer
+			this->TrimBackBuffer(this->FullyBufferedFramesCount + 1);
+
+			this->Frames[InStep] = InFrame;
+			this->FullyBufferedFramesCount++;
+			this->FullyBufferedBytes += this->GetFrameMemoryUsage(*InFrame);
+
+			if (this->SeekPending && InStep == this->SeekStep)
+			{
+				this->SeekPending = false;
+				this->Profiling.LastSeekLatency = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->SeekStartTime).count();
+				this->TotalSeekLatency += this->Profiling.LastSeekLatency;
+				this->Profiling.NumSeeks++;
+			}
+
+			if (!this->PendingFrameRequests.empty())
+			{
+				this->TakeFrameRequests(this->GetFrameAtStep(InStep), frameRequests);
+			}
+
+			bFullyResident = this->Options.BufferEntirePlayback && this->FullyBufferedFramesCount == (uint32)this->Frames.size();
+		}
+
+		this->ReportMemoryUsage();
+	}
+
+	if (bFullyResident)
+	{
+		std::unique_lock<std::mutex> lock(this->ProfilingMutex);
+		this->StoredProfiling.TimeToFullyResident = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->CreationTime).count();
+	}
+
+	// 
+	{
+		std::unique_lock<std::mutex> lock(this->WaitForFrameBufferedMutex);
+		this->NumFrameBufferedEvents++;
+	}
+	this->WaitForFrameBufferedEvent.notify_all();
+
+	for (FrameRequest& request : frameRequests)
+	{
+		CompleteFrameRequest(request, InFrame);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetFramesInFlight
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetFramesInFlight(uint64& OutBytes, std::shared_ptr<Frame>& OutLastFrame) const
+{
+	const uint32 numSteps = (uint32)this->Frames.size();
+	const uint32 firstStep = this->FullyBufferedFramesStart + this->FullyBufferedFramesCount;
+
+	// frames read for steps the window has moved away from are dropped when published, the others follow it
+	uint32 nextStep = firstStep;
+	for (const DecodeJob& job : this->DecodeQueue)
+	{
+		if (job.Step == nextStep % numSteps && (this->Options.Loop || nextStep < numSteps))
+		{
+			OutBytes += job.bSetUp || this->SourceData != nullptr ? 0 : this->TOC.Frames[job.Frame_->FrameIndex].RetainedSize;
+			OutLastFrame = job.Frame_;
+			nextStep++;
+		}
+	}
+
+	return nextStep - firstStep;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::QueueFrameForDecode
+//-----------------------------------------------------------------------------
+void Kimura::Player::QueueFrameForDecode(std::shared_ptr<Frame> InFrame, byte* InBufferAddress, std::shared_ptr<Frame> InPreviousFrame, uint32 InStep, bool InSetUp)
+{
+	bool bSubmitDecodeTask = false;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		this->Counters.DecodeQueueDepthSum += this->DecodeQueue.size();
+		this->Counters.NumFramesQueued++;
+
+		this->DecodeQueue.emplace_back();
+
+		DecodeJob& job = this->DecodeQueue.back();
+		job.Frame_ = InFrame;
+		job.BufferAddress = InBufferAddress;
+		job.PreviousFrame = InPreviousFrame;
+		job.Step = InStep;
+		job.bSetUp = InSetUp;
+		job.bDecodeStarted = InSetUp;
+		job.bDecoded = InSetUp;
+
+		// tasks keep decoding until there's nothing left, more are started as long as there's room
+		if (!InSetUp && this->NumDecodeTasksRunning < this->Options.NumDecodeTasks)
+		{
+			this->NumDecodeTasksRunning++;
+			bSubmitDecodeTask = true;
+		}
+	}
+
+	if (bSubmitDecodeTask)
+	{
+		this->TaskScheduler->SubmitCompute([this]() { this->ExecuteDecodeTask(); });
+	}
+	else if (InSetUp)
+	{
+		this->PublishDecodedFrames(nullptr);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ExecuteDecodeTask
+//-----------------------------------------------------------------------------
+void Kimura::Player::ExecuteDecodeTask()
+{
+	for (;;)
+	{
+		DecodeJob* job = nullptr;
+
+		// Stop waits for decode tasks under ThreadEventMutex, queued frames are under FrameAccessMutex
+		{
+			std::unique_lock<std::mutex> eventLock(this->ThreadEventMutex);
+			std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+			if (!this->StopThreadExecution)
+			{
+				for (DecodeJob& j : this->DecodeQueue)
+				{
+					if (!j.bDecodeStarted)
+					{
+						j.bDecodeStarted = true;
+						job = &j;
+						break;
+					}
+				}
+			}
+
+			if (job == nullptr)
+			{
+				// the player may be destroyed as soon as the locks are released
+				this->NumDecodeTasksRunning--;
+				this->TaskCompletedEvent.notify_all();
+				return;
+			}
+		}
+
+		this->DecodeFrame(*job->Frame_, job->BufferAddress);
+		this->PublishDecodedFrames(job);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::PublishDecodedFrames
+//-----------------------------------------------------------------------------
+void Kimura::Player::PublishDecodedFrames(DecodeJob* InDecodedJob)
+{
+	std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+	if (InDecodedJob != nullptr)
+	{
+		InDecodedJob->bDecoded = true;
+	}
+
+	// the task already publishing takes care of it
+	if (this->bPublishingDecodedFrames)
+	{
+		return;
+	}
+
+	this->bPublishingDecodedFrames = true;
+
+	// frames are linked to the previous one and published in the order they were read
+	bool bPublished = false;
+	while (!this->DecodeQueue.empty() && this->DecodeQueue.front().bDecoded)
+	{
+		DecodeJob job = std::move(this->DecodeQueue.front());
+		this->DecodeQueue.pop_front();
+
+		threadLock.unlock();
+
+		if (!job.bSetUp)
+		{
+			this->LinkFrame(*job.Frame_, job.PreviousFrame.get());
+		}
+
+		this->PublishFrame(job.Frame_, job.Step);
+		bPublished = true;
+
+		threadLock.lock();
+	}
+
+	this->bPublishingDecodedFrames = false;
+	threadLock.unlock();
+
+	// there's room in the queue again
+	if (bPublished)
+	{
+		this->WakeUpBufferThread();
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::StartBulkLoad
+//-----------------------------------------------------------------------------
+void Kimura::Player::StartBulkLoad()
+{
+	const uint32 numFrames = (uint32)this->TOC.Frames.size();
+	const uint32 numTasks = std::min(this->Options.NumBulkLoadTasks, numFrames);
+
+	// more ranges than tasks, so that they all finish around the same time
+	const uint32 numRanges = std::min(numTasks * 4, numFrames);
+
+	for (uint32 iRange = 0; iRange < numRanges; iRange++)
+	{
+		uint32 firstFrame = (uint32)((uint64)iRange * numFrames / numRanges);
+
+		// a range starting on a keyframe doesn't depend on the one before. Otherwise, the streams its first frame 
+		// reuses are read on their own (see ResolvePredecessor).
+		const uint32 iKeyframe = this->TOC.Frames[firstFrame].Keyframe;
+		if (firstFrame - iKeyframe <= numFrames / numRanges / 2)
+		{
+			firstFrame = iKeyframe;
+		}
+
+		if (this->BulkLoadRanges.empty() || firstFrame > this->BulkLoadRanges.back())
+		{
+			this->BulkLoadRanges.push_back(firstFrame);
+		}
+	}
+
+	this->NumBulkLoadTasksRunning = numTasks;
+
+	for (uint32 i = 0; i < numTasks; i++)
+	{
+		this->TaskScheduler->Submit([this]() { this->ExecuteBulkLoadTask(); });
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ExecuteBulkLoadTask
+//-----------------------------------------------------------------------------
+void Kimura::Player::ExecuteBulkLoadTask()
+{
+	const uint32 numFrames = (uint32)this->TOC.Frames.size();
+
+	for (uint32 iRange = this->NextBulkLoadRange++; iRange < (uint32)this->BulkLoadRanges.size(); iRange = this->NextBulkLoadRange++)
+	{
+		const uint32 firstFrame = this->BulkLoadRanges[iRange];
+		const uint32 endFrame = iRange + 1 < (uint32)this->BulkLoadRanges.size() ? this->BulkLoadRanges[iRange + 1] : numFrames;
+
+		// each frame of the range is set up from the one before
+		std::shared_ptr<Frame> previousFrame = this->GetBufferedPredecessor(firstFrame);
+
+		for (uint32 iFrame = firstFrame; iFrame < endFrame && this->Status == PlayerStatus::Ready && !this->StopThreadExecution; iFrame++)
+		{
+			// requested by the application in the meantime
+			{
+				std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+				if (this->Frames[iFrame] != nullptr)
+				{
+					previousFrame = this->Frames[iFrame];
+					continue;
+				}
+			}
+
+			if (previousFrame == nullptr && this->TOC.Frames[iFrame].Keyframe != iFrame)
+			{
+				previousFrame = this->ResolvePredecessor(iFrame);
+			}
+
+			std::shared_ptr<Frame> frame = previousFrame != nullptr || this->TOC.Frames[iFrame].Keyframe == iFrame ? this->LoadFrameAt(iFrame, previousFrame) : nullptr;
+			if (frame == nullptr)
+			{
+				// the buffer thread leaves the frames of the range to this task, they would be waited for forever
+				if (!this->StopThreadExecution)
+				{
+					this->Failure("Failed to load frame " + std::to_string(iFrame));
+				}
+				break;
+			}
+
+			this->StoreBulkLoadedFrame(frame);
+			previousFrame = frame;
+		}
+	}
+
+	// the player may be destroyed as soon as the lock is released
+	std::unique_lock<std::mutex> threadLock(this->ThreadEventMutex);
+	this->NumBulkLoadTasksRunning--;
+	this->TaskCompletedEvent.notify_all();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::StoreBulkLoadedFrame
+//-----------------------------------------------------------------------------
+void Kimura::Player::StoreBulkLoadedFrame(std::shared_ptr<Frame> InFrame)
+{
+	const uint32 iFrame = InFrame->FrameIndex;
+
+	std::vector<FrameRequest> frameRequests;
+	bool bFullyResident = false;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		// a requested frame may have been loaded twice
+		if (this->Frames[iFrame] != nullptr)
+		{
+			return;
+		}
+
+		this->Frames[iFrame] = InFrame;
+		this->FullyBufferedFramesCount++;
+		this->FullyBufferedBytes += this->GetFrameMemoryUsage(*InFrame);
+
+		this->TakeFrameRequests(iFrame, frameRequests);
+
+		bFullyResident = this->FullyBufferedFramesCount == (uint32)this->Frames.size();
+
+		this->ReportMemoryUsage();
+	}
+
+	if (bFullyResident)
+	{
+		std::unique_lock<std::mutex> lock(this->ProfilingMutex);
+		this->StoredProfiling.TimeToFullyResident = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->CreationTime).count();
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(this->WaitForFrameBufferedMutex);
+		this->NumFrameBufferedEvents++;
+	}
+	this->WaitForFrameBufferedEvent.notify_all();
+
+	for (FrameRequest& request : frameRequests)
+	{
+		CompleteFrameRequest(request, InFrame);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::TrimBackBuffer
+//-----------------------------------------------------------------------------
+void Kimura::Player::TrimBackBuffer(uint32 InNumFramesReserved)
+{
+	const uint32 numFramesTotal = (uint32)this->Frames.size();
+
+	// oldest frames go first. InNumFramesReserved are the frames from FullyBufferedFramesStart on that the back 
+	// buffer must leave alone.
+	while (this->BackBufferedFramesCount > 0 && (this->BackBufferedFramesCount > this->Options.BackBufferSize || this->BackBufferedBytes > this->Options.MaxBackBufferBytes || this->BackBufferedFramesCount + InNumFramesReserved > numFramesTotal))
+	{
+		const uint32 iOldestFrame = (this->FullyBufferedFramesStart + numFramesTotal - this->BackBufferedFramesCount) % numFramesTotal;
+
+		this->BackBufferedBytes -= this->GetFrameMemoryUsage(*this->Frames[iOldestFrame]);
+		this->Frames[iOldestFrame] = nullptr;
+		this->BackBufferedFramesCount--;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::UpdatePreBufferingSize
+//-----------------------------------------------------------------------------
+void Kimura::Player::UpdatePreBufferingSize(bool InStarved)
+{
+	if (InStarved)
+	{
+		this->Profiling.NumStarvedRequests++;
+	}
+
+	// running short of frames calls for a deeper window right away, which then slowly goes back to normal
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	const double elapsed = std::chrono::duration<double>(now - this->RequestRateMeasureStart).count();
+
+	if (InStarved)
+	{
+		this->StallBoost = std::min(this->StallBoost * 1.5, 8.0);
+	}
+	else if (elapsed >= 2.0)
+	{
+		// playback was paused, keep on with the rate it had before
+		this->NumStepsRequested = 0;
+		this->RequestRateMeasureStart = now;
+		return;
+	}
+	else if (elapsed >= 0.25)
+	{
+		const double requestRate = this->NumStepsRequested / elapsed;
+		this->FrameRequestRate = this->FrameRequestRate == 0.0 ? requestRate : this->FrameRequestRate * 0.5 + requestRate * 0.5;
+		this->StallBoost = std::max(this->StallBoost * 0.95, 1.0);
+
+		this->NumStepsRequested = 0;
+		this->RequestRateMeasureStart = now;
+	}
+	else
+	{
+		return;
+	}
+
+	// the request rate is measured regardless, it's what the deadlines of the loads are based on
+	if (!this->Options.AdaptivePreBuffering || this->Options.BufferEntirePlayback || this->FrameRequestRate == 0.0)
+	{
+		return;
+	}
+
+	// the busier the loader is keeping up with requests, the further ahead it has to be
+	const double loaderUsage = this->FrameLoadTime * this->FrameRequestRate;
+	const double lookAheadTime = this->Options.PreBufferingTime * std::max(1.0, loaderUsage * 2.0) * this->StallBoost;
+
+	uint64 size = (uint64)std::ceil(this->FrameRequestRate * lookAheadTime);
+
+	if (this->AverageFrameReadSize > 0)
+	{
+		size = std::min(size, std::max<uint64>(1, this->Options.MaxPreBufferingBytes / this->AverageFrameReadSize));
+	}
+
+	this->PreBufferingSize = (uint32)std::max<uint64>(this->Options.MinPreBufferingSize, std::min<uint64>(size, this->Options.MaxPreBufferingSize));
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::FitsBufferedBytesBudget
+//-----------------------------------------------------------------------------
+bool Kimura::Player::FitsBufferedBytesBudget(uint32 InStep, uint64 InBytesPending) const
+{
+	if (this->Options.MaxBufferedBytes == 0 || this->Options.BufferEntirePlayback || this->IsStepAwaited(InStep))
+	{
+		return true;
+	}
+
+	// frames pointing into the source don't retain any memory of their own
+	const uint64 frameBytes = this->SourceData != nullptr ? 0 : this->TOC.Frames[this->GetFrameAtStep(InStep)].RetainedSize;
+
+	return this->FullyBufferedBytes + InBytesPending + frameBytes <= this->Options.MaxBufferedBytes;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::IsStepAwaited
+//-----------------------------------------------------------------------------
+bool Kimura::Player::IsStepAwaited(uint32 InStep) const
+{
+	// the frame needed next, and those leading to the one the application is waiting for, whatever their cost. 
+	// Otherwise, a request landing past a window the budget keeps from growing would never be served.
+	const uint32 numSteps = (uint32)this->Frames.size();
+	const uint32 numStepsAhead = (InStep + numSteps - this->FullyBufferedFramesStart) % numSteps;
+
+	if (numStepsAhead == 0)
+	{
+		return true;
+	}
+
+	if (this->LastStarvedStep >= numSteps)
+	{
+		return false;
+	}
+
+	const uint32 numStepsToStarvedStep = (this->LastStarvedStep + numSteps - this->FullyBufferedFramesStart) % numSteps;
+
+	return numStepsToStarvedStep < this->PreBufferingSize && numStepsAhead <= numStepsToStarvedStep;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::AdmitMemory
+//-----------------------------------------------------------------------------
+bool Kimura::Player::AdmitMemory(uint64 InBytes)
+{
+	if (this->SharedMemoryBudget == nullptr || this->Options.BufferEntirePlayback || InBytes == 0)
+	{
+		return true;
+	}
+
+	return this->SharedMemoryBudget->Admit(*this->MemoryBudgetClient, InBytes);
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ReportMemoryUsage
+//-----------------------------------------------------------------------------
+void Kimura::Player::ReportMemoryUsage()
+{
+	if (this->SharedMemoryBudget != nullptr)
+	{
+		this->SharedMemoryBudget->SetBytesUsed(*this->MemoryBudgetClient, this->GetMemoryUsage());
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetMemoryUsage
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::Player::GetMemoryUsage()
+{
+	uint64 keyframeCacheBytes = 0;
+	{
+		std::unique_lock<std::mutex> cacheLock(this->KeyframeCacheMutex);
+		keyframeCacheBytes = this->KeyframeCacheBytes;
+	}
+
+	return this->FullyBufferedBytes + this->BackBufferedBytes + keyframeCacheBytes + this->FrameBufferPool->GetBytesHeld();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ReleaseFrames
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::Player::ReleaseFrames(uint64 InBytes, bool InLookAhead)
+{
+	std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+	if (this->Options.BufferEntirePlayback || this->Frames.empty())
+	{
+		// nothing to give up but idle buffers
+		const uint64 numBytesPurged = this->FrameBufferPool->Purge(InBytes);
+		this->ReportMemoryUsage();
+
+		return numBytesPurged;
+	}
+
+	const uint64 memoryUsage = this->GetMemoryUsage();
+
+	// idle buffers first, nothing has to be loaded again for them
+	const uint64 numBytesPurged = this->FrameBufferPool->Purge(InBytes);
+
+	const uint32 numSteps = (uint32)this->Frames.size();
+	uint64 numBytesReleased = numBytesPurged;
+
+	if (!InLookAhead)
+	{
+		// then keyframes kept for seeks
+		std::list<std::shared_ptr<Frame>> keyframes;
+		{
+			std::unique_lock<std::mutex> cacheLock(this->KeyframeCacheMutex);
+
+			keyframes.swap(this->KeyframeCache);
+			numBytesReleased += this->KeyframeCacheBytes;
+			this->KeyframeCacheBytes = 0;
+		}
+		keyframes.clear();
+
+		// oldest frames of the back buffer
+		while (this->BackBufferedFramesCount > 0 && numBytesReleased < InBytes)
+		{
+			const uint32 iOldestFrame = (this->FullyBufferedFramesStart + numSteps - this->BackBufferedFramesCount) % numSteps;
+			const uint64 frameMemoryUsage = this->GetFrameMemoryUsage(*this->Frames[iOldestFrame]);
+
+			this->BackBufferedBytes -= frameMemoryUsage;
+			this->Frames[iOldestFrame] = nullptr;
+			this->BackBufferedFramesCount--;
+
+			numBytesReleased += frameMemoryUsage;
+		}
+	}
+	else
+	{
+		// furthest frames first, the frame needed next stays
+		while (this->FullyBufferedFramesCount > 1 && numBytesReleased < InBytes)
+		{
+			const uint32 iFurthestFrame = (this->FullyBufferedFramesStart + this->FullyBufferedFramesCount - 1) % numSteps;
+			const uint64 frameMemoryUsage = this->GetFrameMemoryUsage(*this->Frames[iFurthestFrame]);
+
+			this->FullyBufferedBytes -= frameMemoryUsage;
+			this->Frames[iFurthestFrame] = nullptr;
+			this->FullyBufferedFramesCount--;
+
+			numBytesReleased += frameMemoryUsage;
+		}
+	}
+
+	// released frames handed their buffers back to the pool, unless something else still holds on to them
+	if (numBytesReleased > numBytesPurged)
+	{
+		this->FrameBufferPool->Purge(numBytesReleased - numBytesPurged);
+	}
+
+	this->ReportMemoryUsage();
+
+	const uint64 newMemoryUsage = this->GetMemoryUsage();
+	return memoryUsage > newMemoryUsage ? memoryUsage - newMemoryUsage : 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetFrameMemoryUsage
+//-----------------------------------------------------------------------------
+Kimura::uint64 Kimura::Player::GetFrameMemoryUsage(const Frame& InFrame) const
+{
+	uint64 size = InFrame.Buffer.GetSize();
+
+	// streams the frame detached from its buffer. Blocks reused from previous frames are counted by the frame that 
+	// stores them, those of constant meshes are shared by every frame and not counted at all.
+	const TOCFrame& tocFrame = this->TOC.Frames[InFrame.FrameIndex];
+
+	for (uint32 iMesh = 0; iMesh < InFrame.Meshes.size(); iMesh++)
+	{
+		for (uint32 iStream = 0; iStream < NumStreams && !this->TOC.Meshes[iMesh].Constant; iStream++)
+		{
+			if (InFrame.Meshes[iMesh].StreamBlocks[iStream] != nullptr && tocFrame.Meshes[iMesh].GetStreamSeek(iStream) != -1)
+			{
+				size += InFrame.Meshes[iMesh].StreamBlocks[iStream]->GetSize();
+			}
+		}
+	}
+
+	for (uint32 iImage = 0; iImage < InFrame.Images.size(); iImage++)
+	{
+		for (uint32 iMipmap = 0; iMipmap < MaxMipmaps; iMipmap++)
+		{
+			if (InFrame.Images[iImage].Mipmaps[iMipmap].Block != nullptr && tocFrame.Images[iImage].Mipmaps[iMipmap].SeekPosition != -1)
+			{
+				size += InFrame.Images[iImage].Mipmaps[iMipmap].Block->GetSize();
+			}
+		}
+	}
+
+	return size;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::LoadFrameAt
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Player::LoadFrameAt(uint32 iFrame, std::shared_ptr<Frame> InPreviousFrame)
+{
+	KIMURA_TRACE("Kimura::Player::LoadFrameAt");
+
+	byte* bufferAddress = nullptr;
+	std::shared_ptr<Frame> newFrame = this->ReadFrame(iFrame, bufferAddress);
+	if (newFrame == nullptr)
+	{
+		return nullptr;
+	}
+
+	this->SetupFrame(newFrame, bufferAddress, InPreviousFrame);
+
+	return newFrame;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ReadFrame
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Player::ReadFrame(uint32 iFrame, byte*& OutBufferAddress)
+{
+	std::shared_ptr<Frame> newFrame = this->AllocateFrame(iFrame, OutBufferAddress);
+	if (newFrame == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (newFrame->MappedSource == nullptr)
+	{
+		ScopedTime s;
+
+		KIMURA_TRACE("Kimura::Player::ReadFrame");
+
+		// read the frame's content into the buffer
+		uint64 positionOfFrameInFile = this->FrameDataFilePosition + this->TOC.Frames[iFrame].FilePosition;
+
+		for (const TOCFrameReadRange& r : this->TOC.Frames[iFrame].ReadRanges)
+		{
+			if (!this->Source->ReadAt(positionOfFrameInFile + r.Offset, &newFrame->Buffer.GetData()[r.BufferOffset], r.Size))
+			{
+				this->Failure("Failed to read frame data from file");
+				return nullptr;
+			}
+		}
+
+		this->Counters.ReadTime += s.Nanoseconds();
+	}
+
+	return newFrame;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetBufferedPredecessor
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Player::GetBufferedPredecessor(uint32 iFrame)
+{
+	if (iFrame == 0)
+	{
+		return nullptr;
+	}
+
+	std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+	return this->FindBufferedFrame(iFrame - 1);
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetNumPlaybackSteps
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetNumPlaybackSteps() const
+{
+	const uint32 numFrames = (uint32)this->TOC.Frames.size();
+
+	if (this->Options.Direction == PlaybackDirection::PingPong && numFrames > 1)
+	{
+		// the first frame is played again when the playback ends, but when looping that's the next round's
+		return this->Options.Loop ? numFrames * 2 - 2 : numFrames * 2 - 1;
+	}
+
+	return numFrames;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetFrameAtStep
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetFrameAtStep(uint32 InStep) const
+{
+	const uint32 numFrames = (uint32)this->TOC.Frames.size();
+
+	switch (this->Options.Direction)
+	{
+		case PlaybackDirection::Reverse:	return numFrames - 1 - InStep;
+		case PlaybackDirection::PingPong:	return InStep < numFrames ? InStep : numFrames * 2 - 2 - InStep;
+		case PlaybackDirection::Forward:
+		default:							return InStep;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetStepOfFrame
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetStepOfFrame(uint32 iFrame) const
+{
+	const uint32 numFrames = (uint32)this->TOC.Frames.size();
+	const uint32 numSteps = (uint32)this->Frames.size();
+
+	switch (this->Options.Direction)
+	{
+		case PlaybackDirection::Reverse:	return numFrames - 1 - iFrame;
+		case PlaybackDirection::Forward:	return iFrame;
+		default:							break;
+	}
+
+	// in ping pong, the frame is played on the way forward and on the way back
+	const uint32 steps[2] = { iFrame, (numFrames * 2 - 2 - iFrame) % numSteps };
+	if (steps[0] == steps[1])
+	{
+		return steps[0];
+	}
+
+	// prefer the step that's buffered ahead, or about to be, then the one played recently. The window only moves on 
+	// when frames ahead are requested.
+	for (uint32 step : steps)
+	{
+		if ((step + numSteps - this->FullyBufferedFramesStart) % numSteps < this->FullyBufferedFramesCount)
+		{
+			return step;
+		}
+	}
+
+	for (uint32 step : steps)
+	{
+		if ((step + numSteps - this->FullyBufferedFramesStart) % numSteps < this->PreBufferingSize && (this->Options.Loop || step >= this->FullyBufferedFramesStart))
+		{
+			return step;
+		}
+	}
+
+	for (uint32 step : steps)
+	{
+		const uint32 numStepsBehind = (this->FullyBufferedFramesStart + numSteps - step) % numSteps;
+		if (numStepsBehind > 0 && numStepsBehind <= this->BackBufferedFramesCount)
+		{
+			return step;
+		}
+	}
+
+	// otherwise keep going the same way
+	return this->FullyBufferedFramesStart < numFrames - 1 ? steps[0] : steps[1];
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::FindBufferedFrame
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Player::FindBufferedFrame(uint32 iFrame) const
+{
+	const uint32 numFrames = (uint32)this->TOC.Frames.size();
+
+	// steps outside of the buffered windows are always empty
+	std::shared_ptr<Frame> frame = this->Frames[this->Options.Direction == PlaybackDirection::Reverse ? numFrames - 1 - iFrame : iFrame];
+
+	if (frame == nullptr && this->Options.Direction == PlaybackDirection::PingPong && numFrames > 1)
+	{
+		frame = this->Frames[(numFrames * 2 - 2 - iFrame) % this->Frames.size()];
+	}
+
+	return frame;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ResolvePredecessor
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Player::ResolvePredecessor(uint32 iFrame)
+{
+	KIMURA_TRACE("Kimura::Player::ResolvePredecessor");
+
+	const TOCFrame& tocFrame = this->TOC.Frames[iFrame];
+
+	// predicted streams need the actual previous frame
+	if (tocFrame.PredictedFromPreviousFrames)
+	{
+		return this->DecodeFramesUpTo(iFrame - 1);
+	}
+
+	// stands in for the previous frame, only the streams reused by iFrame are set
+	std::shared_ptr<Frame> predecessor = std::make_shared<Frame>();
+	predecessor->FrameIndex = iFrame - 1;
+	predecessor->Meshes.resize(tocFrame.Meshes.size());
+	predecessor->Images.resize(tocFrame.Images.size());
+
+	if (this->SourceData != nullptr)
+	{
+		predecessor->MappedSource = this->Source;
+	}
+
+	// streams stored by the keyframe are shared with it, the others are read on their own from the frame storing them
+	std::shared_ptr<Frame> keyframe = nullptr;
+
+	// when playing backwards, the following frame is usually buffered. The streams it reuses as well are the same.
+	std::shared_ptr<Frame> successor = nullptr;
+	if (iFrame + 1 < (uint32)this->TOC.Frames.size())
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		successor = this->FindBufferedFrame(iFrame + 1);
+	}
+
+	for (uint32 iMesh = 0; iMesh < tocFrame.Meshes.size(); iMesh++)
+	{
+		if (this->TOC.Meshes[iMesh].Constant)
+		{
+			continue;
+		}
+
+		const TOCFrameMesh& tocFrameMesh = tocFrame.Meshes[iMesh];
+		FrameMesh& predecessorMesh = predecessor->Meshes[iMesh];
+
+		for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+		{
+			const uint32 iSourceFrame = tocFrameMesh.StreamSources[iStream];
+			if (tocFrameMesh.GetStreamSeek(iStream) != -1 || iSourceFrame == NoStreamSource)
+			{
+				continue;
+			}
+
+			const TOCFrameMesh& sourceFrameMesh = this->TOC.Frames[iSourceFrame].Meshes[iMesh];
+			if (sourceFrameMesh.GetStreamSize(iStream) == 0)
+			{
+				continue;
+			}
+
+			if (successor != nullptr && this->TOC.Frames[iFrame + 1].Meshes[iMesh].GetStreamSeek(iStream) == -1)
+			{
+				predecessorMesh.Streams[iStream] = successor->Meshes[iMesh].Streams[iStream];
+				predecessorMesh.StreamBlocks[iStream] = successor->Meshes[iMesh].StreamBlocks[iStream];
+
+				if (predecessorMesh.Streams[iStream] != nullptr && predecessorMesh.StreamBlocks[iStream] == nullptr)
+				{
+					predecessorMesh.Streams[iStream] = this->DetachStream(*successor, predecessorMesh.Streams[iStream], sourceFrameMesh.GetStreamSize(iStream), true, predecessorMesh.StreamBlocks[iStream]);
+				}
+			}
+			else if (iSourceFrame <= tocFrame.Keyframe)
+			{
+				if (keyframe == nullptr && (keyframe = this->GetKeyframe(tocFrame.Keyframe)) == nullptr)
+				{
+					return nullptr;
+				}
+
+				predecessorMesh.Streams[iStream] = keyframe->Meshes[iMesh].Streams[iStream];
+				predecessorMesh.StreamBlocks[iStream] = keyframe->Meshes[iMesh].StreamBlocks[iStream];
+
+				if (predecessorMesh.Streams[iStream] != nullptr && predecessorMesh.StreamBlocks[iStream] == nullptr)
+				{
+					predecessorMesh.Streams[iStream] = this->DetachStream(*keyframe, predecessorMesh.Streams[iStream], sourceFrameMesh.GetStreamSize(iStream), true, predecessorMesh.StreamBlocks[iStream]);
+				}
+			}
+			else
+			{
+				predecessorMesh.Streams[iStream] = this->ReadStream(iSourceFrame, sourceFrameMesh.GetStreamSeek(iStream), sourceFrameMesh.StoredStreamSizes[iStream], sourceFrameMesh.StreamCodecs[iStream], sourceFrameMesh.GetStreamSize(iStream), predecessorMesh.StreamBlocks[iStream]);
+				if (predecessorMesh.Streams[iStream] == nullptr)
+				{
+					return nullptr;
+				}
+			}
+		}
+	}
+
+	for (uint32 iImage = 0; iImage < tocFrame.Images.size(); iImage++)
+	{
+		for (uint32 iMipmap = 0; iMipmap < tocFrame.Images[iImage].NumMipmaps && iMipmap < MaxMipmaps; iMipmap++)
+		{
+			const uint32 iSourceFrame = tocFrame.Images[iImage].Mipmaps[iMipmap].SourceFrame;
+			if (tocFrame.Images[iImage].Mipmaps[iMipmap].SeekPosition != -1 || iSourceFrame == NoStreamSource)
+			{
+				continue;
+			}
+
+			const TOCMipmap& sourceMipmap = this->TOC.Frames[iSourceFrame].Images[iImage].Mipmaps[iMipmap];
+			FrameImageMipmap& predecessorMipmap = predecessor->Images[iImage].Mipmaps[iMipmap];
+
+			if (sourceMipmap.Size == 0)
+			{
+				continue;
+			}
+
+			predecessorMipmap.Size = sourceMipmap.Size;
+
+			if (successor != nullptr && this->TOC.Frames[iFrame + 1].Images[iImage].Mipmaps[iMipmap].SeekPosition == -1)
+			{
+				const FrameImageMipmap& successorMipmap = successor->Images[iImage].Mipmaps[iMipmap];
+				predecessorMipmap.Data = successorMipmap.Data;
+				predecessorMipmap.Block = successorMipmap.Block;
+
+				if (predecessorMipmap.Data != nullptr && predecessorMipmap.Block == nullptr)
+				{
+					predecessorMipmap.Data = this->DetachStream(*successor, (const byte*)predecessorMipmap.Data, sourceMipmap.Size, true, predecessorMipmap.Block);
+				}
+			}
+			else if (iSourceFrame <= tocFrame.Keyframe)
+			{
+				if (keyframe == nullptr && (keyframe = this->GetKeyframe(tocFrame.Keyframe)) == nullptr)
+				{
+					return nullptr;
+				}
+
+				const FrameImageMipmap& keyframeMipmap = keyframe->Images[iImage].Mipmaps[iMipmap];
+				predecessorMipmap.Data = keyframeMipmap.Data;
+				predecessorMipmap.Block = keyframeMipmap.Block;
+
+				if (predecessorMipmap.Data != nullptr && predecessorMipmap.Block == nullptr)
+				{
+					predecessorMipmap.Data = this->DetachStream(*keyframe, (const byte*)predecessorMipmap.Data, sourceMipmap.Size, true, predecessorMipmap.Block);
+				}
+			}
+			else
+			{
+				predecessorMipmap.Data = this->ReadStream(iSourceFrame, sourceMipmap.SeekPosition, sourceMipmap.StoredSize, sourceMipmap.Codec, sourceMipmap.Size, predecessorMipmap.Block);
+				if (predecessorMipmap.Data == nullptr)
+				{
+					return nullptr;
+				}
+			}
+		}
+	}
+
+	return predecessor;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::DecodeFramesUpTo
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Player::DecodeFramesUpTo(uint32 iFrame)
+{
+	KIMURA_TRACE("Kimura::Player::DecodeFramesUpTo");
+
+	const uint32 iKeyframe = this->TOC.Frames[iFrame].Keyframe;
+
+	// start from the closest buffered frame, the keyframe at worst
+	std::shared_ptr<Frame> frame = nullptr;
+	uint32 iStart = iKeyframe;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		for (uint32 i = iFrame; i > iKeyframe && frame == nullptr; i--)
+		{
+			if ((frame = this->FindBufferedFrame(i)) != nullptr)
+			{
+				iStart = i;
+			}
+		}
+	}
+
+	if (frame == nullptr && (frame = this->GetKeyframe(iKeyframe)) == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (uint32 i = iStart + 1; i <= iFrame && frame != nullptr; i++)
+	{
+		frame = this->LoadFrameAt(i, frame);
+	}
+
+	return frame;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::ReadStream
+//-----------------------------------------------------------------------------
+const Kimura::byte* Kimura::Player::ReadStream(uint32 iFrame, int32 InSeek, uint32 InStoredSize, StreamCodec InCodec, uint32 InSize, std::shared_ptr<PooledBuffer>& OutBlock)
+{
+	const uint64 positionInFile = this->FrameDataFilePosition + this->TOC.Frames[iFrame].FilePosition + (uint64)InSeek;
+
+	this->Counters.BytesRead += InStoredSize;
+
+	const byte* data = nullptr;
+	PooledBuffer compressed;
+
+	if (this->SourceData != nullptr)
+	{
+		this->Source->Prefetch(positionInFile, InStoredSize);
+		data = &this->SourceData[positionInFile];
+
+		if (InCodec == StreamCodec::None)
+		{
+			return data;
+		}
+	}
+	else
+	{
+		ScopedTime s;
+
+		// compressed streams are read aside and decompressed in the block
+		byte* readAddress = nullptr;
+		if (InCodec == StreamCodec::None)
+		{
+			OutBlock = std::make_shared<PooledBuffer>(this->FrameBufferPool->Acquire(InSize));
+			readAddress = OutBlock->GetData();
+		}
+		else
+		{
+			compressed = this->FrameBufferPool->Acquire(InStoredSize);
+			readAddress = compressed.GetData();
+		}
+
+		if (readAddress == nullptr && InStoredSize > 0)
+		{
+			OutBlock = nullptr;
+			this->Failure("Failed to allocate memory for frame");
+			return nullptr;
+		}
+
+		if (!this->Source->ReadAt(positionInFile, readAddress, InStoredSize))
+		{
+			OutBlock = nullptr;
+			this->Failure("Failed to read frame data from file");
+			return nullptr;
+		}
+
+		this->Counters.ReadTime += s.Nanoseconds();
+
+		if (InCodec == StreamCodec::None)
+		{
+			return OutBlock->GetData();
+		}
+
+		data = compressed.GetData();
+	}
+
+	OutBlock = std::make_shared<PooledBuffer>(this->FrameBufferPool->Acquire(InSize));
+	if (OutBlock->GetData() == nullptr && InSize > 0)
+	{
+		OutBlock = nullptr;
+		this->Failure("Failed to allocate memory for frame");
+		return nullptr;
+	}
+
+	std::vector<StreamDecodeJob> jobs(1);
+	jobs[0].Codec = InCodec;
+	jobs[0].Data = data;
+	jobs[0].StoredSize = InStoredSize;
+	jobs[0].Decoded = OutBlock->GetData();
+	jobs[0].Size = InSize;
+
+	if (!this->DecodeStreams(jobs))
+	{
+		OutBlock = nullptr;
+		this->Failure("Failed to decompress frame data");
+		return nullptr;
+	}
+
+	return OutBlock->GetData();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetKeyframe
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Player::GetKeyframe(uint32 iFrame)
+{
+	// already buffered?
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		std::shared_ptr<Frame> frame = this->FindBufferedFrame(iFrame);
+		if (frame != nullptr)
+		{
+			return frame;
+		}
+	}
+
+	// recently decoded?
+	{
+		std::unique_lock<std::mutex> cacheLock(this->KeyframeCacheMutex);
+
+		for (auto it = this->KeyframeCache.begin(); it != this->KeyframeCache.end(); ++it)
+		{
+			if ((*it)->FrameIndex == iFrame)
+			{
+				std::shared_ptr<Frame> keyframe = *it;
+
+				this->KeyframeCache.erase(it);
+				this->KeyframeCache.push_front(keyframe);
+
+				return keyframe;
+			}
+		}
+	}
+
+	std::shared_ptr<Frame> keyframe = this->LoadFrameAt(iFrame, nullptr);
+
+	if (keyframe != nullptr && this->Options.KeyframeCacheSize > 0)
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		{
+			std::unique_lock<std::mutex> cacheLock(this->KeyframeCacheMutex);
+
+			this->KeyframeCache.push_front(keyframe);
+			this->KeyframeCacheBytes += this->GetFrameMemoryUsage(*keyframe);
+
+			while (this->KeyframeCache.size() > this->Options.KeyframeCacheSize)
+			{
+				this->KeyframeCacheBytes -= this->GetFrameMemoryUsage(*this->KeyframeCache.back());
+				this->KeyframeCache.pop_back();
+			}
+		}
+
+		this->ReportMemoryUsage();
+	}
+
+	return keyframe;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::AllocateFrame
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::Frame> Kimura::Player::AllocateFrame(uint32 iFrame, byte*& OutBufferAddress)
+{
+	TOCFrame& tocFrame = this->TOC.Frames[iFrame];
+
+	std::shared_ptr<Frame> newFrame = std::make_shared<Frame>();
+	newFrame->FrameIndex = iFrame;
+
+	if (this->SourceData != nullptr)
+	{
+		// the frame points straight into the source. There's nothing to allocate or copy, and no need to keep 
+		// previous frames alive since the data they point to is owned by the source.
+		uint64 positionOfFrameInFile = this->FrameDataFilePosition + tocFrame.FilePosition;
+
+		newFrame->MappedSource = this->Source;
+		OutBufferAddress = (byte*)&this->SourceData[positionOfFrameInFile];
+
+		// get the pages in ahead of the render thread
+		for (const TOCFrameReadRange& r : tocFrame.ReadRanges)
+		{
+			this->Source->Prefetch(positionOfFrameInFile + r.Offset, r.Size);
+		}
+		this->Counters.BytesRead += tocFrame.ReadSize;
+
+		// only compressed streams need memory of their own
+		if (tocFrame.DecodedSize > 0)
+		{
+			newFrame->Buffer = this->FrameBufferPool->Acquire(tocFrame.DecodedSize);
+			if (newFrame->Buffer.GetData() == nullptr)
+			{
+				this->Failure("Failed to allocate memory for frame");
+				return nullptr;
+			}
+		}
+
+		return newFrame;
+	}
+
+	// get a buffer large enough to contain the frame's read ranges and decompressed streams, recycled from retired 
+	// frames whenever possible. Its content is undefined, the caller is responsible for filling it.
+	const uint64 bufferSize = tocFrame.DecodedSize > 0 ? tocFrame.DecodedOffset + tocFrame.DecodedSize : tocFrame.ReadSize;
+	newFrame->Buffer = this->FrameBufferPool->Acquire(bufferSize);
+	if (newFrame->Buffer.GetData() == nullptr && bufferSize > 0)
+	{
+		this->Failure("Failed to allocate memory for frame");
+		return nullptr;
+	}
+
+	this->Counters.BytesRead += tocFrame.ReadSize;
+
+	OutBufferAddress = newFrame->Buffer.GetData();
+
+	return newFrame;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::SetupFrame
+//-----------------------------------------------------------------------------
+void Kimura::Player::SetupFrame(std::shared_ptr<Frame> InFrame, byte* InBufferAddress, std::shared_ptr<Frame> InPreviousFrame)
+{
+	KIMURA_TRACE("Kimura::Player::SetupFrame");
+
+	this->DecodeFrame(*InFrame, InBufferAddress);
+	this->LinkFrame(*InFrame, InPreviousFrame.get());
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::DecodeFrame
+//-----------------------------------------------------------------------------
+void Kimura::Player::DecodeFrame(Frame& InFrame, byte* InBufferAddress)
+{
+	KIMURA_TRACE("Kimura::Player::DecodeFrame");
+
+	Frame& newFrame = InFrame;
+	byte* bufferAddress = InBufferAddress;
+
+	uint32 iFrame = newFrame.FrameIndex;
+
+	TOCFrame& tocFrame = this->TOC.Frames[iFrame];
+
+	// mipmaps reused by the next frame are detached from this frame's buffer (see TOCFrameMesh::DetachedStreams for 
+	// streams)
+	TOCFrame* nextTOCFrame = iFrame + 1 < (uint32)this->TOC.Frames.size() ? &this->TOC.Frames[iFrame + 1] : nullptr;
+
+	// frames read from the source are packed (see TOCFrame::ReadRanges), frames pointing into the source aren't
+	const bool bPackedBuffer = newFrame.MappedSource == nullptr;
+
+	// compressed streams are decompressed once all of them are known, several at once
+	byte* decodedAddress = newFrame.Buffer.GetData() + (bPackedBuffer ? tocFrame.DecodedOffset : 0);
+	std::vector<StreamDecodeJob> decodeJobs;
+
+	// in a block of their own when needed by the next frames, same as DetachStream
+	auto queueDecode = [this, &decodeJobs](StreamCodec InCodec, const byte* InData, uint64 InStoredSize, byte* InDecoded, uint64 InSize, bool InReusedByNextFrame, std::shared_ptr<PooledBuffer>& OutBlock)
+	{
+		if (InReusedByNextFrame)
+		{
+			OutBlock = std::make_shared<PooledBuffer>(this->FrameBufferPool->Acquire(InSize));
+			InDecoded = OutBlock->GetData();
+
+			if (InDecoded == nullptr)
+			{
+				OutBlock = nullptr;
+				this->Failure("Failed to allocate memory for frame");
+				return (const byte*)nullptr;
+			}
+		}
+
+		StreamDecodeJob job;
+		job.Codec = InCodec;
+		job.Data = InData;
+		job.StoredSize = InStoredSize;
+		job.Decoded = InDecoded;
+		job.Size = InSize;
+		decodeJobs.push_back(job);
+
+		return (const byte*)InDecoded;
+	};
+
+	// positions reconstructed from a basis are split in ranges of vertices, decoded by as many tasks
+	auto queueBasis = [this, &decodeJobs, &queueDecode](uint32 iMesh, const TOCFrameMesh& InFrameMesh, const byte* InCoefficients, byte* InDecoded, bool InReusedByNextFrame, std::shared_ptr<PooledBuffer>& OutBlock)
+	{
+		const uint64 size = InFrameMesh.GetStreamSize(StreamPositions);
+		const byte* decoded = queueDecode(StreamCodec::None, InCoefficients, InFrameMesh.StoredStreamSizes[StreamPositions], InDecoded, size, InReusedByNextFrame, OutBlock);
+		if (decoded == nullptr)
+		{
+			// no job was queued, the player failed
+			return decoded;
+		}
+
+		StreamDecodeJob job = decodeJobs.back();
+		decodeJobs.pop_back();
+
+		job.Basis = &this->MeshBases[iMesh];
+		job.Format = this->TOC.Meshes[iMesh].PositionFormat_;
+		job.QuantizationCenter = InFrameMesh.PositionQuantizationCenter;
+		job.QuantizationExtents = InFrameMesh.PositionQuantizationExtents;
+
+		const uint64 numVerticesPerJob = 16 * 1024;
+		const uint64 vertexSize = size / InFrameMesh.Vertices;
+
+		for (uint64 first = 0; first < InFrameMesh.Vertices; first += numVerticesPerJob)
+		{
+			job.FirstVertex = first;
+			job.Decoded = const_cast<byte*>(decoded) + first * vertexSize;
+			job.Size = std::min<uint64>(numVerticesPerJob, InFrameMesh.Vertices - first) * vertexSize;
+			decodeJobs.push_back(job);
+
+			// the coefficients are only counted once
+			job.StoredSize = 0;
+		}
+
+		return decoded;
+	};
+
+	// allocate mesh instances for this frame
+	newFrame.Meshes.resize(tocFrame.Meshes.size());
+
+	ScopedTime timeProcessingFrame;
+
+
+	for (uint32 iMesh = 0; iMesh < (uint32)newFrame.Meshes.size(); iMesh++)
+	{
+		FrameMesh& frameMesh = newFrame.Meshes[iMesh];
+
+		TOCMesh& tocMesh = this->TOC.Meshes[iMesh];
+		TOCFrameMesh& tocFrameMesh = tocFrame.Meshes[iMesh];
+
+		frameMesh.Vertices = tocFrameMesh.Vertices;
+		frameMesh.Surfaces = tocFrameMesh.Surfaces;
+
+		// a simple copy of the frame mesh's sections
+		frameMesh.Sections = tocFrameMesh.Sections;
+
+		frameMesh.PositionQuantizationCenter = tocFrameMesh.PositionQuantizationCenter;
+		frameMesh.PositionQuantizationExtents = tocFrameMesh.PositionQuantizationExtents;
+
+		frameMesh.VelocityQuantizationCenter = tocFrameMesh.VelocityQuantizationCenter;
+		frameMesh.VelocityQuantizationExtents = tocFrameMesh.VelocityQuantizationExtents;
+
+		frameMesh.ColorQuantizationExtents[0] = tocFrameMesh.ColorQuantizationExtents[0];
+		frameMesh.ColorQuantizationExtents[1] = tocFrameMesh.ColorQuantizationExtents[1];
+
+		// copy bounds info
+		frameMesh.BoundingCenter = tocFrameMesh.BoundingCenter;
+		frameMesh.BoundingSize = tocFrameMesh.BoundingSize;
+
+		// constant meshes and streams reused from the previous frame are linked afterwards
+		if (tocMesh.Constant)
+		{
+			continue;
+		}
+
+		for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+		{
+			const int32 seek = tocFrameMesh.GetStreamSeek(iStream);
+
+			if (seek != -1 && tocFrameMesh.GetStreamSize(iStream) > 0)
+			{
+				const bool bDetached = tocFrameMesh.DetachedStreams[iStream];
+
+				const uint64 offset = bPackedBuffer ? tocFrame.GetBufferOffset(seek) : (uint64)seek;
+
+				// residuals of predicted streams are decoded as well, LinkFrame adds their prediction in place. The changes 
+				// of sparse streams are applied there too.
+				if (tocFrameMesh.StreamEncodings[iStream] == StreamEncoding::Basis)
+				{
+					frameMesh.Streams[iStream] = queueBasis(iMesh, tocFrameMesh, &bufferAddress[offset], &decodedAddress[tocFrameMesh.DecodedStreamOffsets[iStream]], bDetached, frameMesh.StreamBlocks[iStream]);
+				}
+				else if (tocFrameMesh.StreamEncodings[iStream] == StreamEncoding::Sparse)
+				{
+					frameMesh.Streams[iStream] = queueDecode(tocFrameMesh.StreamCodecs[iStream], &bufferAddress[offset], tocFrameMesh.StoredStreamSizes[iStream], &decodedAddress[tocFrameMesh.DecodedStreamOffsets[iStream]], tocFrameMesh.SparseStreamSizes[iStream], false, frameMesh.StreamBlocks[iStream]);
+				}
+				else if (tocFrameMesh.StreamCodecs[iStream] != StreamCodec::None || tocFrameMesh.StreamEncodings[iStream] != StreamEncoding::Raw)
+				{
+					frameMesh.Streams[iStream] = queueDecode(tocFrameMesh.StreamCodecs[iStream], &bufferAddress[offset], tocFrameMesh.StoredStreamSizes[iStream], &decodedAddress[tocFrameMesh.DecodedStreamOffsets[iStream]], tocFrameMesh.GetStreamSize(iStream), bDetached, frameMesh.StreamBlocks[iStream]);
+
+					StreamDecodeJob& job = decodeJobs.back();
+					job.Encoding = tocFrameMesh.StreamEncodings[iStream];
+					job.ElementSize = iStream == StreamIndices ? this->GetIndexSize(tocFrameMesh) : (uint32)(tocFrameMesh.GetStreamSize(iStream) / std::max(1u, tocFrameMesh.Vertices));
+				}
+				else
+				{
+					frameMesh.Streams[iStream] = this->DetachStream(newFrame, &bufferAddress[offset], tocFrameMesh.GetStreamSize(iStream), bDetached, frameMesh.StreamBlocks[iStream]);
+				}
+			}
+		}
+	}
+
+	// setup the frame's image sequence data
+	newFrame.Images.resize(tocFrame.Images.size());
+	for (uint32 iImageSequence = 0; iImageSequence < newFrame.Images.size(); iImageSequence++)
+	{
+		// copy number of mipmaps used
+		newFrame.Images[iImageSequence].NumMipmaps = tocFrame.Images[iImageSequence].NumMipmaps;
+
+		// for each mipmap, store pointer to data + size of data
+		TOCMipmap* pTOCMipmap = tocFrame.Images[iImageSequence].Mipmaps;
+		FrameImageMipmap* pFrameMipmap = newFrame.Images[iImageSequence].Mipmaps;
+		for (uint32 iMipmap = 0; iMipmap < tocFrame.Images[iImageSequence].NumMipmaps; iMipmap++)
+		{
+			if (pTOCMipmap->SeekPosition != -1)
+			{
+				bool bReusedByNextFrame = nextTOCFrame != nullptr && nextTOCFrame->Images[iImageSequence].Mipmaps[iMipmap].SeekPosition == -1;
+
+				const uint64 offset = bPackedBuffer ? tocFrame.GetBufferOffset(pTOCMipmap->SeekPosition) : (uint64)pTOCMipmap->SeekPosition;
+
+				if (pTOCMipmap->Codec != StreamCodec::None)
+				{
+					pFrameMipmap->Data = queueDecode(pTOCMipmap->Codec, &bufferAddress[offset], pTOCMipmap->StoredSize, &decodedAddress[pTOCMipmap->DecodedOffset], pTOCMipmap->Size, bReusedByNextFrame, pFrameMipmap->Block);
+				}
+				else
+				{
+					pFrameMipmap->Data = this->DetachStream(newFrame, &bufferAddress[offset], pTOCMipmap->Size, bReusedByNextFrame, pFrameMipmap->Block);
+				}
+				pFrameMipmap->Size = pTOCMipmap->Size;
+			}
+
+			pFrameMipmap++;
+			pTOCMipmap++;
+		}
+
+	}
+
+	if (!this->DecodeStreams(decodeJobs))
+	{
+		this->Failure("Failed to decompress frame data");
+	}
+
+	this->Counters.ProcessingTime += timeProcessingFrame.Nanoseconds();
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::LinkFrame
+//-----------------------------------------------------------------------------
+void Kimura::Player::LinkFrame(Frame& InFrame, const Frame* InPreviousFrame)
+{
+	Frame& newFrame = InFrame;
+
+	TOCFrame& tocFrame = this->TOC.Frames[newFrame.FrameIndex];
+
+	// frame (or stand-in, see ResolvePredecessor) that reused streams are taken from
+	const Frame* previousFrame = InPreviousFrame;
+
+	// the previous frame's streams the next frame extrapolates from are kept along
+	const TOCFrame* nextTOCFrame = newFrame.FrameIndex + 1 < (uint32)this->TOC.Frames.size() ? &this->TOC.Frames[newFrame.FrameIndex + 1] : nullptr;
+
+	ScopedTime timeProcessingFrame;
+
+	for (uint32 iMesh = 0; iMesh < (uint32)newFrame.Meshes.size(); iMesh++)
+	{
+		FrameMesh& frameMesh = newFrame.Meshes[iMesh];
+
+		TOCMesh& tocMesh = this->TOC.Meshes[iMesh];
+		TOCFrameMesh& tocFrameMesh = tocFrame.Meshes[iMesh];
+
+		for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+		{
+			if (tocMesh.Constant)
+			{
+				// loaded once, when the player opened
+				frameMesh.Streams[iStream] = this->ConstantMeshes[iMesh].Streams[iStream];
+				frameMesh.StreamBlocks[iStream] = this->ConstantMeshes[iMesh].StreamBlocks[iStream];
+			}
+			else if (tocFrameMesh.GetStreamSeek(iStream) == -1)
+			{
+				// re-use previous frame's stream, along with the block that keeps it alive
+				if (previousFrame != nullptr)
+				{
+					frameMesh.Streams[iStream] = previousFrame->Meshes[iMesh].Streams[iStream];
+					frameMesh.StreamBlocks[iStream] = previousFrame->Meshes[iMesh].StreamBlocks[iStream];
+				}
+			}
+			else if (tocFrameMesh.StreamEncodings[iStream] == StreamEncoding::Sparse && frameMesh.Streams[iStream] != nullptr)
+			{
+				const FrameMesh* previousMesh = previousFrame != nullptr ? &previousFrame->Meshes[iMesh] : nullptr;
+				if (previousMesh == nullptr || previousMesh->Streams[iStream] == nullptr)
+				{
+					this->Failure("Sparse stream without the previous frame");
+					continue;
+				}
+
+				const byte* changes = frameMesh.Streams[iStream];
+				const uint32 changesSize = tocFrameMesh.SparseStreamSizes[iStream];
+				const uint64 size = tocFrameMesh.GetStreamSize(iStream);
+
+				uint32 numRuns = 0;
+				memcpy(&numRuns, changes, std::min<size_t>(changesSize, 4));
+
+				// nothing changed, the previous frame's stream is shared as is. Unless it lies in that frame's buffer, which 
+				// may be released before this frame.
+				const PooledBuffer& previousBuffer = previousFrame->Buffer;
+				const bool bInPreviousBuffer = previousMesh->Streams[iStream] >= previousBuffer.GetData() && previousMesh->Streams[iStream] < previousBuffer.GetData() + previousBuffer.GetSize();
+
+				if (changesSize == 4 && numRuns == 0 && !bInPreviousBuffer)
+				{
+					frameMesh.Streams[iStream] = previousMesh->Streams[iStream];
+					frameMesh.StreamBlocks[iStream] = previousMesh->StreamBlocks[iStream];
+					continue;
+				}
+
+				// streams are handed out in one piece, the unchanged ranges are copied
+				std::shared_ptr<PooledBuffer> block = std::make_shared<PooledBuffer>(this->FrameBufferPool->Acquire(size));
+				if (block->GetData() == nullptr && size > 0)
+				{
+					this->Failure("Failed to allocate memory for frame");
+					continue;
+				}
+
+				const uint64 elementSize = frameMesh.Vertices > 0 && size % frameMesh.Vertices == 0 ? size / frameMesh.Vertices : 0;
+				if (!ApplySparseStream(changes, changesSize, previousMesh->Streams[iStream], block->GetData(), size, elementSize))
+				{
+					this->Failure("Sparse stream changes are out of bounds");
+					continue;
+				}
+
+				frameMesh.Streams[iStream] = block->GetData();
+				frameMesh.StreamBlocks[iStream] = block;
+			}
+			else if (IsPredicted(tocFrameMesh.StreamEncodings[iStream]) && frameMesh.Streams[iStream] != nullptr)
+			{
+				const FrameMesh* previousMesh = previousFrame != nullptr ? &previousFrame->Meshes[iMesh] : nullptr;
+				if (previousMesh == nullptr || previousMesh->Streams[iStream] == nullptr)
+				{
+					this->Failure("Predicted stream without the previous frame");
+					continue;
+				}
+
+				// linear prediction needs the stream of the frame before the previous one, which the previous frame 
+				// only keeps when it predicted the stream too
+				const byte* beforePrevious = tocFrameMesh.StreamEncodings[iStream] == StreamEncoding::Linear ? previousMesh->PreviousStreams[iStream] : nullptr;
+				const StreamEncoding encoding = beforePrevious != nullptr ? StreamEncoding::Linear : StreamEncoding::Delta;
+
+				// the residuals were decoded in memory owned by this frame (see DecodeFrame)
+				byte* data = const_cast<byte*>(frameMesh.Streams[iStream]);
+				ReconstructStream(encoding, tocMesh.GetComponentSize(iStream), data, previousMesh->Streams[iStream], beforePrevious, data, tocFrameMesh.GetStreamSize(iStream));
+
+				const TOCFrameMesh* nextTOCFrameMesh = nextTOCFrame != nullptr ? &nextTOCFrame->Meshes[iMesh] : nullptr;
+				if (nextTOCFrameMesh != nullptr && nextTOCFrameMesh->GetStreamSeek(iStream) != -1 && nextTOCFrameMesh->StreamEncodings[iStream] == StreamEncoding::Linear)
+				{
+					frameMesh.PreviousStreams[iStream] = previousMesh->Streams[iStream];
+					frameMesh.PreviousStreamBlocks[iStream] = previousMesh->StreamBlocks[iStream];
+				}
+			}
+		}
+
+		// number of vertices stored in this frame determines the type of index buffer used
+		frameMesh.AssignStreams(tocMesh, this->GetIndexSize(tocFrameMesh) == 2);
+	}
+
+	for (uint32 iImageSequence = 0; iImageSequence < newFrame.Images.size() && previousFrame != nullptr; iImageSequence++)
+	{
+		TOCMipmap* pTOCMipmap = tocFrame.Images[iImageSequence].Mipmaps;
+		FrameImageMipmap* pFrameMipmap = newFrame.Images[iImageSequence].Mipmaps;
+		for (uint32 iMipmap = 0; iMipmap < tocFrame.Images[iImageSequence].NumMipmaps; iMipmap++)
+		{
+			if (pTOCMipmap->SeekPosition == -1)
+			{
+				pFrameMipmap->Data = previousFrame->Images[iImageSequence].Mipmaps[iMipmap].Data;
+				pFrameMipmap->Size = previousFrame->Images[iImageSequence].Mipmaps[iMipmap].Size;
+				pFrameMipmap->Block = previousFrame->Images[iImageSequence].Mipmaps[iMipmap].Block;
+			}
+
+			pFrameMipmap++;
+			pTOCMipmap++;
+		}
+	}
+
+	this->Counters.ProcessingTime += timeProcessingFrame.Nanoseconds();
+	this->Counters.NumFramesProcessed++;
+
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::DetachStream
+//-----------------------------------------------------------------------------
+const Kimura::byte* Kimura::Player::DetachStream(const Frame& InFrame, const byte* InData, uint64 InSize, bool InReusedByNextFrame, std::shared_ptr<PooledBuffer>& OutBlock)
+{
+	// data owned by the source outlives every frame, there's no need to detach anything. Streams used by this frame 
+	// alone remain in its buffer.
+	const bool bInFrameBuffer = InData >= InFrame.Buffer.GetData() && InData < InFrame.Buffer.GetData() + InFrame.Buffer.GetSize();
+	if (!InReusedByNextFrame || !bInFrameBuffer)
+	{
+		return InData;
+	}
+
+	// copy the stream into a block of its own, so that frames reusing it don't retain this frame's entire buffer
+	OutBlock = std::make_shared<PooledBuffer>(this->FrameBufferPool->Acquire(InSize));
+	if (OutBlock->GetData() == nullptr)
+	{
+		OutBlock = nullptr;
+		this->Failure("Failed to allocate memory for frame");
+		return nullptr;
+	}
+
+	memcpy(OutBlock->GetData(), InData, (size_t)InSize);
+
+	return OutBlock->GetData();
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::DecodeStreams
+//-----------------------------------------------------------------------------
+bool Kimura::Player::DecodeStreams(std::vector<StreamDecodeJob>& InJobs)
+{
+	if (InJobs.empty())
+	{
+		return true;
+	}
+
+	// shared with the tasks helping out, which may only start after the caller is done with them
+	struct SharedJobs
+	{
+		std::vector<StreamDecodeJob>	Jobs;
+		std::shared_ptr<IStreamDecoder>	Decoder;
+		std::atomic<uint32>				NextJob{0};
+
+		std::mutex						Mutex;
+		std::condition_variable			JobsDoneEvent;
+		uint32							NumJobsDone = 0;
+		uint64							DecodeTime = 0;
+		bool							bFailed = false;
+	};
+
+	std::shared_ptr<SharedJobs> shared = std::make_shared<SharedJobs>();
+	shared->Jobs = std::move(InJobs);
+	shared->Decoder = this->Options.StreamDecoder;
+
+	uint64 numBytesCompressed = 0;
+	uint64 numBytesDecompressed = 0;
+	for (const StreamDecodeJob& job : shared->Jobs)
+	{
+		numBytesCompressed += job.StoredSize;
+		numBytesDecompressed += job.Size;
+	}
+
+	// largest first, so that the tasks finish around the same time
+	std::sort(shared->Jobs.begin(), shared->Jobs.end(), [](const StreamDecodeJob& a, const StreamDecodeJob& b) { return a.Size > b.Size; });
+
+	auto decodeJobs = [](SharedJobs& InShared)
+	{
+		const uint32 numJobs = (uint32)InShared.Jobs.size();
+
+		for (uint32 iJob = InShared.NextJob++; iJob < numJobs; iJob = InShared.NextJob++)
+		{
+			ScopedTime s;
+			const bool bDecoded = DecodeStream(InShared.Jobs[iJob], InShared.Decoder.get());
+
+			std::unique_lock<std::mutex> lock(InShared.Mutex);
+			InShared.DecodeTime += s.Nanoseconds();
+			InShared.bFailed |= !bDecoded;
+
+			if (++InShared.NumJobsDone == numJobs)
+			{
+				InShared.JobsDoneEvent.notify_all();
+			}
+		}
+	};
+
+	// small frames aren't worth the trip through the scheduler
+	const uint64 minBytesPerTask = 256 * 1024;
+	const uint32 numTasks = (uint32)std::min<uint64>({ (uint64)std::max(1u, this->Options.NumDecompressionTasks), (uint64)shared->Jobs.size(), std::max<uint64>(1, numBytesDecompressed / minBytesPerTask) });
+
+	for (uint32 i = 1; i < numTasks; i++)
+	{
+		this->TaskScheduler->SubmitCompute([shared, decodeJobs]() { decodeJobs(*shared); });
+	}
+
+	// the caller takes its share, and whatever the other tasks haven't started yet
+	decodeJobs(*shared);
+
+	std::unique_lock<std::mutex> lock(shared->Mutex);
+	shared->JobsDoneEvent.wait(lock, [&shared]() { return shared->NumJobsDone == (uint32)shared->Jobs.size(); });
+
+	this->Counters.DecompressionTime += shared->DecodeTime;
+	this->Counters.BytesCompressed += numBytesCompressed;
+	this->Counters.BytesDecompressed += numBytesDecompressed;
+
+	return !shared->bFailed;
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::DecodeStream
+//-----------------------------------------------------------------------------
+bool Kimura::Player::DecodeStream(const StreamDecodeJob& InJob, IStreamDecoder* InDecoder)
+{
+	if (InJob.Basis != nullptr)
+	{
+		const uint64 vertexSize = InJob.Format == PositionFormat::Full ? sizeof(Vector3) : 3 * sizeof(int16);
+
+		ReconstructFromBasis(*InJob.Basis, InJob.Data, InJob.FirstVertex, InJob.Size / vertexSize, InJob.Format, InJob.QuantizationCenter, InJob.QuantizationExtents, InJob.Decoded);
+		return true;
+	}
+
+	if (InJob.Encoding == StreamEncoding::Triangles)
+	{
+		return DecodeTriangles(InJob.Data, InJob.StoredSize, InJob.Decoded, InJob.Size, InJob.ElementSize);
+	}
+
+	if (InJob.Encoding == StreamEncoding::BytePlanes)
+	{
+		return DecodeBytePlanes(InJob.Data, InJob.StoredSize, InJob.Decoded, InJob.Size, InJob.ElementSize);
+	}
+
+	// residuals stored as is, copied where their prediction is added
+	if (InJob.Codec == StreamCodec::None)
+	{
+		if (InJob.StoredSize != InJob.Size)
+		{
+			return false;
+		}
+
+		memcpy(InJob.Decoded, InJob.Data, (size_t)InJob.Size);
+		return true;
+	}
+
+	if (InJob.Codec == StreamCodec::LZ4)
+	{
+		return DecodeLZ4(InJob.Data, InJob.StoredSize, InJob.Decoded, InJob.Size);
+	}
+
+	return InDecoder != nullptr && InDecoder->Decode(InJob.Codec, InJob.Data, InJob.StoredSize, InJob.Decoded, InJob.Size);
+}
+
+
+//-----------------------------------------------------------------------------
+// FrameMesh::AssignStreams
+//-----------------------------------------------------------------------------
+void Kimura::FrameMesh::AssignStreams(const TOCMesh& InMesh, bool In16BitIndices)
+{
+	if (In16BitIndices)
+	{
+		this->IndicesU16 = (const uint16*)this->Streams[StreamIndices];
+	}
+	else
+	{
+		this->IndicesU32 = (const uint32*)this->Streams[StreamIndices];
+	}
+
+	switch (InMesh.PositionFormat_)
+	{
+		case PositionFormat::Full:		this->PositionsF32 = (const Vector3*)this->Streams[StreamPositions]; break;
+		case PositionFormat::Half:		this->PositionsI16 = (const int16*)this->Streams[StreamPositions]; break;
+	}
+
+	switch (InMesh.NormalFormat_)
+	{
+		case NormalFormat::Full:		this->NormalsF32 = (const Vector3*)this->Streams[StreamNormals]; break;
+		case NormalFormat::Half:		this->NormalsI16 = (const int16*)this->Streams[StreamNormals]; break;
+		case NormalFormat::Byte:		this->NormalsI8 = (const int8*)this->Streams[StreamNormals]; break;
+		case NormalFormat::None:
+		default:						break;
+	}
+
+	switch (InMesh.TangentFormat_)
+	{
+		case TangentFormat::Full:		this->TangentsF32 = (const Vector4*)this->Streams[StreamTangents]; break;
+		case TangentFormat::Half:		this->TangentsI16 = (const int16*)this->Streams[StreamTangents]; break;
+		case TangentFormat::Byte:		this->TangentsI8 = (const int8*)this->Streams[StreamTangents]; break;
+		case TangentFormat::None:
+		default:						break;
+	}
+
+	switch (InMesh.VelocityFormat_)
+	{
+		case VelocityFormat::Full:		this->VelocitiesF32 = (const Vector3*)this->Streams[StreamVelocities]; break;
+		case VelocityFormat::Half:		this->VelocitiesI16 = (const int16*)this->Streams[StreamVelocities]; break;
+		case VelocityFormat::Byte:		this->VelocitiesI8 = (const int8*)this->Streams[StreamVelocities]; break;
+		case VelocityFormat::None:
+		default:						break;
+	}
+
+	for (uint32 iTC = 0; iTC < MaxTextureCoords; iTC++)
+	{
+		switch (InMesh.TexCoordFormat_)
+		{
+			case TexCoordFormat::Full:	this->TexCoordsF32[iTC] = (const float*)this->Streams[StreamTexCoords + iTC]; break;
+			case TexCoordFormat::Half:	this->TexCoordsU16[iTC] = (const uint16*)this->Streams[StreamTexCoords + iTC]; break;
+			case TexCoordFormat::None:
+			default:					break;
+		}
+	}
+
+	for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
+	{
+		switch (InMesh.ColorFormat_)
+		{
+			case ColorFormat::Full:		this->ColorsF32[iCC] = (const float*)this->Streams[StreamColors + iCC]; break;
+			case ColorFormat::Half:		this->ColorsU16[iCC] = (const uint16*)this->Streams[StreamColors + iCC]; break;
+			case ColorFormat::Byte:
+			case ColorFormat::ByteHDR:	this->ColorsU8[iCC] = (const uint8*)this->Streams[StreamColors + iCC]; break;
+			case ColorFormat::None:
+			default:					break;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Player::GetNumFrames
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Player::GetNumFrames()
+{
+	if (this->Status != Kimura::PlayerStatus::Ready)
+	{
+		return 0;
+	}
 
-			case NormalFormat::Half:
-			{
-				if (tocFrameMesh.SeekNormals == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.NormalsI16 = previousFrame->Meshes[iMesh].NormalsI16;
-					}
-				}
-				else if (tocFrameMesh.SizeNormals > 0)
-				{
-					frameMesh.NormalsI16 = (int16*)&bufferAddress[tocFrameMesh.SeekNormals];
-				}
+	return (Kimura::uint32)this->TOC.Frames.size();
+}
 
-				break;
-			}
 
-			case NormalFormat::Byte:
-			{
-				if (tocFrameMesh.SeekNormals == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.NormalsI8 = previousFrame->Meshes[iMesh].NormalsI8;
-					}
-				}
-				else if (tocFrameMesh.SizeNormals > 0)
-				{
-					frameMesh.NormalsI8 = (int8*)&bufferAddress[tocFrameMesh.SeekNormals];
-				}
+//-----------------------------------------------------------------------------
+// Player::GetFrameAt
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IFrame> Kimura::Player::GetFrameAt(uint32 iFrame, bool InForceWait)
+{
+	return this->GetFrameUntil(iFrame, InForceWait, std::chrono::steady_clock::time_point::max());
+}
 
-				break;
-			}
 
-			case NormalFormat::None:
-			default:
-			{
-				break;
-			}
+//-----------------------------------------------------------------------------
+// Player::GetFrameAt
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IFrame> Kimura::Player::GetFrameAt(uint32 iFrame, std::chrono::steady_clock::time_point InDeadline)
+{
+	return this->GetFrameUntil(iFrame, true, InDeadline);
+}
 
-		}
 
+//-----------------------------------------------------------------------------
+// Player::GetFrameUntil
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IFrame> Kimura::Player::GetFrameUntil(uint32 iFrame, bool InForceWait, std::chrono::steady_clock::time_point InDeadline)
+{
+	std::shared_ptr<Kimura::IFrame> r = nullptr;
 
-		// Tangent
-		switch (tocMesh.TangentFormat_)
+	// the application asks for the same frame on every tick until the next one is due. It's still at the start of 
+	// the buffered window, which only this thread moves.
+	if (this->LastServedFrame != nullptr && this->LastServedFrameIndex == iFrame)
+	{
+		// the loader may have rested with room left, when running out of memory budget for instance
+		if (!this->TaskSubmitted && this->FullyBufferedFramesCount < this->PreBufferingSize)
 		{
-			case TangentFormat::Full:
-			{
-				if (tocFrameMesh.SeekTangents == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.TangentsF32 = previousFrame->Meshes[iMesh].TangentsF32;
-					}
-				}
-				else if (tocFrameMesh.SizeTangents > 0)
-				{
-					frameMesh.TangentsF32 = (Vector4*) &bufferAddress[tocFrameMesh.SeekTangents];
-				}
+			this->WakeUpBufferThread();
+		}
 
-				break;
-			}
+		return this->LastServedFrame;
+	}
 
-			case TangentFormat::Half:
-			{
-				if (tocFrameMesh.SeekTangents == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.TangentsI16 = previousFrame->Meshes[iMesh].TangentsI16;
-					}
-				}
-				else if (tocFrameMesh.SizeTangents > 0)
-				{
-					frameMesh.TangentsI16 = (int16*)&bufferAddress[tocFrameMesh.SeekTangents];
-				}
+	// nothing to look at until the TOC is read
+	if (this->Status != PlayerStatus::Ready)
+	{
+		return nullptr;
+	}
 
-				break;
-			}
+	uint32 numFramesTotal = (uint32)this->TOC.Frames.size();
 
-			case TangentFormat::Byte:
-			{
-				if (tocFrameMesh.SeekTangents == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.TangentsI8 = previousFrame->Meshes[iMesh].TangentsI8;
-					}
-				}
-				else if (tocFrameMesh.SizeTangents > 0)
-				{
-					frameMesh.TangentsI8 = (int8*)&bufferAddress[tocFrameMesh.SeekTangents];
-				}
+	// when waiting, any frame buffered from this point on may be the one we're after
+	uint64 numFrameBufferedEvents = 0;
+	if (InForceWait)
+	{
+		std::unique_lock<std::mutex> lock(this->WaitForFrameBufferedMutex);
+		numFrameBufferedEvents = this->NumFrameBufferedEvents;
+	}
 
-				break;
-			}
+	// expected that the frame index be within the full range of the playback
+	if (iFrame >= numFramesTotal)
+	{
+		// complain
+		return nullptr;
+	}
 
-			case TangentFormat::None:
-			default:
-			{
-				break;
-			}
+	// special case when 'buffer entire playback' is on
+	if (this->Options.BufferEntirePlayback)
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
 
+		// frames are never released, but bulk loads don't buffer them in order
+		if (this->Frames[iFrame] != nullptr)
+		{
+			return this->Frames[iFrame];
 		}
 
+	}
+	else
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
 
+		// the buffered window is made of playback steps
+		const uint32 numSteps = (uint32)this->Frames.size();
+		const uint32 step = this->GetStepOfFrame(iFrame);
 
-		// velocity
-		switch (tocMesh.VelocityFormat_)
-		{
-
-			case VelocityFormat::Full:
-			{
-				if (tocFrameMesh.SeekVelocities == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.VelocitiesF32 = previousFrame->Meshes[iMesh].VelocitiesF32;
-					}
-				}
-				else if (tocFrameMesh.SizeVelocities > 0)
-				{
-					frameMesh.VelocitiesF32 = (Vector3*)&bufferAddress[tocFrameMesh.SeekVelocities];
-				}
+		this->LastRequestTime = std::chrono::steady_clock::now();
 
-				break;
-			}
+		// first, is this frame buffered? or in queue to be buffered?
+		bool bFrameBuffered = (step >= this->FullyBufferedFramesStart) && (step < this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
+		bFrameBuffered |= ((step+numSteps) >= this->FullyBufferedFramesStart) && ((step+numSteps)< this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
 
-			case VelocityFormat::Half:
-			{
-				if (tocFrameMesh.SeekVelocities == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.VelocitiesI16 = previousFrame->Meshes[iMesh].VelocitiesI16;
-					}
-				}
-				else if (tocFrameMesh.SizeVelocities > 0)
-				{
-					frameMesh.VelocitiesI16 = (int16*)&bufferAddress[tocFrameMesh.SeekVelocities];
-				}
+		// without looping, the window stops at the end rather than wrapping around to the start
+		bool bFrameIntentedToBeBuffered = (step >= this->FullyBufferedFramesStart) && (step < this->FullyBufferedFramesStart + this->PreBufferingSize);
+		bFrameIntentedToBeBuffered |= this->Options.Loop && ((step+numSteps) >= this->FullyBufferedFramesStart) && ((step + numSteps) < this->FullyBufferedFramesStart + this->PreBufferingSize);
 
-				break;
-			}
+		// or was it played recently?
+		const uint32 numStepsBehind = (this->FullyBufferedFramesStart + numSteps - step) % numSteps;
+		const bool bFrameBackBuffered = numStepsBehind > 0 && numStepsBehind <= this->BackBufferedFramesCount;
 
-			case VelocityFormat::Byte:
-			{
-				if (tocFrameMesh.SeekVelocities == -1)
-				{
-					if (previousFrame != nullptr)
-					{
-						frameMesh.VelocitiesI8 = previousFrame->Meshes[iMesh].VelocitiesI8;
-					}
-				}
-				else if (tocFrameMesh.SizeVelocities > 0)
-				{
-					frameMesh.VelocitiesI8 = (int8*)&bufferAddress[tocFrameMesh.SeekVelocities];
-				}
+		if (bFrameBuffered)
+		{
 
-				break;
-			}
+			//std::printf("Obtaining frame %d\n", iFrame);
 
-			case VelocityFormat::None:
-			default:
-			{
-				break;
-			}			
+			// this is the frame we want to return
+			r = this->Frames[step];
 
-		}
+			this->LastServedFrame = this->Frames[step];
+			this->LastServedFrameIndex = iFrame;
 
-		// texture coords
-		switch (tocMesh.TexCoordFormat_)
-		{
-			case TexCoordFormat::Full:
+			// previous frames move to the back buffer
+			if (!this->Options.BufferEntirePlayback)
 			{
-				for (uint32 iTC = 0; iTC < MaxTextureCoords; iTC++)
+				while (this->FullyBufferedFramesStart != step)
 				{
-					if (tocFrameMesh.SeekTexCoords[iTC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.TexCoordsF32[iTC] = previousFrame->Meshes[iMesh].TexCoordsF32[iTC];
-						}
-					}
-					else if (tocFrameMesh.SizeTexCoords[iTC] > 0)
-					{
-						frameMesh.TexCoordsF32[iTC] = (float*)&bufferAddress[tocFrameMesh.SeekTexCoords[iTC]];
-					}
-				}
+					//std::printf("Removing frame %d\n", this->FullyBufferedFramesStart);
 
-				break;
-			}
+					const uint64 frameMemoryUsage = this->GetFrameMemoryUsage(*this->Frames[this->FullyBufferedFramesStart]);
+					this->FullyBufferedBytes -= frameMemoryUsage;
+					this->BackBufferedBytes += frameMemoryUsage;
+					this->BackBufferedFramesCount++;
 
-			case TexCoordFormat::Half:
-			{
-				for (uint32 iTC = 0; iTC < MaxTextureCoords; iTC++)
-				{
-					if (tocFrameMesh.SeekTexCoords[iTC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.TexCoordsU16[iTC] = previousFrame->Meshes[iMesh].TexCoordsU16[iTC];
-						}
-					}
-					else if (tocFrameMesh.SizeTexCoords[iTC] > 0)
-					{
-						frameMesh.TexCoordsU16[iTC] = (uint16*)&bufferAddress[tocFrameMesh.SeekTexCoords[iTC]];
-					}
+					this->FullyBufferedFramesStart++;
+					this->FullyBufferedFramesStart %= numSteps;
+
+					this->FullyBufferedFramesCount--;
+					this->NumStepsRequested++;
 				}
 
-				break;
+				this->TrimBackBuffer(this->FullyBufferedFramesCount);
+				this->UpdatePreBufferingSize(false);
+				this->ReportMemoryUsage();
 			}
+		}
+		else if (bFrameBackBuffered)
+		{
+			// stepping backwards. The buffered window stays where it is, playback resumes from it.
+			r = this->Frames[step];
+			this->Profiling.BackBufferHits++;
+		}
+		else if (bFrameIntentedToBeBuffered)
+		{
+			// frame isn't loaded at this time but the player is already working to get there. Do nothing.
+			//std::printf("Frame %d isn't available yet but will be. Waiting...\n", iFrame);
 
-			case TexCoordFormat::None:
-			default:
+			// the window should have been deeper. Only once per frame, a waiting request asks again and again.
+			if (step != this->LastStarvedStep)
 			{
-				break;
-			}			
-
+				this->LastStarvedStep = step;
+				this->UpdatePreBufferingSize(true);
+			}
 		}
+		else
+		{
 
+			//std::printf("Requesting frame from non-buffered section. Clearing %d buffered frames and jumping to frame %d \n", this->FullyBufferedFramesCount, iFrame);
 
-		switch (tocMesh.ColorFormat_)
-		{
-			case ColorFormat::Full:
+			// a step backwards the back buffer couldn't serve
+			if (numStepsBehind > 0 && numStepsBehind < (step + numSteps - this->FullyBufferedFramesStart) % numSteps)
 			{
-				for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
-				{
-					if (tocFrameMesh.SeekColors[iCC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.ColorsF32[iCC] = previousFrame->Meshes[iMesh].ColorsF32[iCC];
-						}
-					}
-					else if (tocFrameMesh.SizeColors[iCC] > 0)
-					{
-						frameMesh.ColorsF32[iCC] = (float*)&bufferAddress[tocFrameMesh.SeekColors[iCC]];
-					}
-				}
-			
-				break;
+				this->Profiling.BackBufferMisses++;
 			}
 
-			case ColorFormat::Half:
+			// clear all buffered frames, including the back buffer which won't precede the new window
+			this->TrimBackBuffer(numSteps);
+
+			while (this->FullyBufferedFramesCount > 0)
 			{
-				for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
-				{
-					if (tocFrameMesh.SeekColors[iCC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.ColorsU16[iCC] = previousFrame->Meshes[iMesh].ColorsU16[iCC];
-						}
-					}
-					else if (tocFrameMesh.SizeColors[iCC] > 0)
-					{
-						frameMesh.ColorsU16[iCC] = (uint16*)&bufferAddress[tocFrameMesh.SeekColors[iCC]];
-					}
-				}
-				break;
+				this->Frames[this->FullyBufferedFramesStart] = nullptr;
+				this->FullyBufferedFramesStart++;
+				this->FullyBufferedFramesStart %= numSteps;
+
+				this->FullyBufferedFramesCount--;
 			}
 
-			case ColorFormat::Byte:
-			case ColorFormat::ByteHDR:
-			{
+			this->FullyBufferedBytes = 0;
+			this->ReportMemoryUsage();
 
-				for (uint32 iCC = 0; iCC < MaxColorChannels; iCC++)
-				{
-					if (tocFrameMesh.SeekColors[iCC] == -1)
-					{
-						if (previousFrame != nullptr)
-						{
-							frameMesh.ColorsU8[iCC] = previousFrame->Meshes[iMesh].ColorsU8[iCC];
-						}
-					}
-					else if (tocFrameMesh.SizeColors[iCC] > 0)
-					{
-						frameMesh.ColorsU8[iCC] = (uint8*)&bufferAddress[tocFrameMesh.SeekColors[iCC]];
-					}
-				}
+			this->LastServedFrame = nullptr;
 
-				break;
-			}
+			// set new buffer start 
+			this->FullyBufferedFramesStart = step;
 
-			case ColorFormat::None:
-			default:
-			{
-				break;
-			}			
+			// measure how long it takes for the frame to become available
+			this->SeekPending = true;
+			this->SeekStep = step;
+			this->LastStarvedStep = 0xffffffff;
+			this->SeekStartTime = std::chrono::steady_clock::now();
 		}
+
 	}
 
-	// setup the frame's image sequence data
-	newFrame->Images.resize(tocFrame.Images.size());
-	for (uint32 iImageSequence = 0; iImageSequence < newFrame->Images.size(); iImageSequence++)
-	{
-		// copy number of mipmaps used
-		newFrame->Images[iImageSequence].NumMipmaps = tocFrame.Images[iImageSequence].NumMipmaps;
+	// wake up the player's thread and look for more work to do. 
+	this->WakeUpBufferThread();
 
-		// for each mipmap, store pointer to data + size of data
-		TOCMipmap* pTOCMipmap = tocFrame.Images[iImageSequence].Mipmaps;
-		FrameImageMipmap* pFrameMipmap = newFrame->Images[iImageSequence].Mipmaps;
-		for (uint32 iMipmap = 0; iMipmap < tocFrame.Images[iImageSequence].NumMipmaps; iMipmap++)
+	// This will force blocking until the desired frame is ready
+	while (r == nullptr && InForceWait && !this->StopThreadExecution)
+	{
+		// wait until a frame has been obtained
 		{
-			if (pTOCMipmap->SeekPosition == -1)
+			std::unique_lock<std::mutex> threadLock(this->WaitForFrameBufferedMutex);
+			auto frameBuffered = [this, numFrameBufferedEvents]() { return this->NumFrameBufferedEvents != numFrameBufferedEvents || this->StopThreadExecution; };
+
+			if (InDeadline == std::chrono::steady_clock::time_point::max())
 			{
-				if (previousFrame != nullptr)
-				{
-					pFrameMipmap->Data = previousFrame->Images[iImageSequence].Mipmaps[iMipmap].Data;
-					pFrameMipmap->Size = previousFrame->Images[iImageSequence].Mipmaps[iMipmap].Size;
-				}
+				this->WaitForFrameBufferedEvent.wait(threadLock, frameBuffered);
 			}
-			else
+			else if (!this->WaitForFrameBufferedEvent.wait_until(threadLock, InDeadline, frameBuffered))
 			{
-				pFrameMipmap->Data = (void*)&bufferAddress[pTOCMipmap->SeekPosition];
-				pFrameMipmap->Size = pTOCMipmap->Size;
+				// nothing was buffered in time
+				return nullptr;
 			}
 
-			pFrameMipmap++;
-			pTOCMipmap++;
+			numFrameBufferedEvents = this->NumFrameBufferedEvents;
 		}
 
-	}
-
-	this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond += timeProcessingFrame.Duration();
-	this->Profiling.NumFramesProcessedInLastSecond++;
+		// *try* to get the frame but do not wait this time
+		r = this->GetFrameAt(iFrame, false);
 
-	// store the frame
-	{
-		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
-		this->Frames[iFrame] = newFrame;
 	}
 
+	return r;
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::GetNumFrames
+// Player::RequestFrame
 //-----------------------------------------------------------------------------
-Kimura::uint32 Kimura::Player::GetNumFrames()
+std::shared_future<std::shared_ptr<Kimura::IFrame>> Kimura::Player::RequestFrame(uint32 iFrame, FrameRequestCallback InCallback)
 {
-	if (this->Status != Kimura::PlayerStatus::Ready)
+	FrameRequest request;
+	request.FrameIndex = iFrame;
+	request.Callback = std::move(InCallback);
+	request.RequestTime = std::chrono::steady_clock::now();
+
+	std::shared_future<std::shared_ptr<IFrame>> future = request.Promise.get_future().share();
+
+	std::shared_ptr<Frame> frame = nullptr;
+	bool bPending = false;
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		// until the TOC is read, the request is kept and checked once it is. Stop completes whatever is pending, 
+		// nothing can be added after it.
+		const bool bReady = this->Status == PlayerStatus::Ready;
+
+		if (!this->StopThreadExecution && (!bReady || iFrame < (uint32)this->TOC.Frames.size()))
+		{
+			frame = bReady ? this->FindBufferedFrame(iFrame) : nullptr;
+
+			if (frame == nullptr)
+			{
+				this->PendingFrameRequests.push_back(std::move(request));
+				bPending = true;
+			}
+		}
+	}
+
+	if (bPending)
+	{
+		this->WakeUpBufferThread();
+	}
+	else
 	{
-		return 0;
+		CompleteFrameRequest(request, frame);
 	}
 
-	return (Kimura::uint32)this->Frames.size();
+	return future;
 }
 
 
 //-----------------------------------------------------------------------------
-// Player::GetFrameAt
+// Player::LoadRequestedFrame
 //-----------------------------------------------------------------------------
-std::shared_ptr<Kimura::IFrame> Kimura::Player::GetFrameAt(uint32 iFrame, bool InForceWait)
+bool Kimura::Player::LoadRequestedFrame()
 {
-	std::shared_ptr<Kimura::IFrame> r = nullptr;
-
-	uint32 numFramesTotal = (uint32)this->Frames.size();
-
-	// expected that the frame index be within the full range of the playback
-	if (iFrame >= numFramesTotal)
-	{
-		// complain
-		return nullptr;
-	}
+	std::vector<FrameRequest> frameRequests;
+	std::vector<std::shared_ptr<Frame>> frames;
 
-	// special case when 'buffer entire playback' is on
-	if (this->Options.BufferEntirePlayback)
+	bool bLoad = false;
+	uint32 iFrame = 0;
+	bool bPublish = false;
+	uint32 stepToPublish = 0;
 	{
 		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
 
-		bool bFrameBuffered = (iFrame >= this->FullyBufferedFramesStart) && (iFrame < this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
-		bFrameBuffered |= ((iFrame + numFramesTotal) >= this->FullyBufferedFramesStart) && ((iFrame + numFramesTotal) < this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
+		// frames buffered in the meantime, or which don't exist
+		const uint32 numFrames = (uint32)this->TOC.Frames.size();
+		for (auto it = this->PendingFrameRequests.begin(); it != this->PendingFrameRequests.end();)
+		{
+			std::shared_ptr<Frame> frame = it->FrameIndex < numFrames ? this->FindBufferedFrame(it->FrameIndex) : nullptr;
 
-		if (bFrameBuffered)
+			if (frame != nullptr || it->FrameIndex >= numFrames)
+			{
+				frameRequests.push_back(std::move(*it));
+				frames.push_back(frame);
+				it = this->PendingFrameRequests.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		if (!this->PendingFrameRequests.empty())
 		{
-			return this->Frames[iFrame];
+			bLoad = true;
+			iFrame = this->PendingFrameRequests.front().FrameIndex;
+
+			// when it's the frame the window buffers next, it's published there as well
+			const uint32 numSteps = (uint32)this->Frames.size();
+			const uint32 nextStep = this->FullyBufferedFramesStart + this->FullyBufferedFramesCount;
+			stepToPublish = nextStep % numSteps;
+			bPublish = this->GetStepOfFrame(iFrame) == stepToPublish && this->FullyBufferedFramesCount < this->PreBufferingSize && (this->Options.Loop || nextStep < numSteps) && this->BulkLoadRanges.empty();
 		}
+	}
 
+	for (size_t i = 0; i < frameRequests.size(); i++)
+	{
+		CompleteFrameRequest(frameRequests[i], frames[i]);
 	}
-	else
+
+	if (!bLoad)
 	{
-		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		// done with requests, no need to hold on to the last frame loaded
+		this->LastRequestedFrame = nullptr;
+		return false;
+	}
 
-		// first, is this frame buffered? or in queue to be buffered?
-		bool bFrameBuffered = (iFrame >= this->FullyBufferedFramesStart) && (iFrame < this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
-		bFrameBuffered |= ((iFrame+numFramesTotal) >= this->FullyBufferedFramesStart) && ((iFrame+numFramesTotal)< this->FullyBufferedFramesStart + this->FullyBufferedFramesCount);
+	// frames are often requested one after the other, the previous one is then at hand
+	std::shared_ptr<Frame> previousFrame = this->GetBufferedPredecessor(iFrame);
+	if (previousFrame == nullptr && this->LastRequestedFrame != nullptr && this->LastRequestedFrame->FrameIndex + 1 == iFrame)
+	{
+		previousFrame = this->LastRequestedFrame;
+	}
 
-		bool bFrameIntentedToBeBuffered = (iFrame >= this->FullyBufferedFramesStart) && (iFrame < this->FullyBufferedFramesStart + this->Options.PreBufferingSize);
-		bFrameIntentedToBeBuffered |= ((iFrame+numFramesTotal) >= this->FullyBufferedFramesStart) && ((iFrame + numFramesTotal) < this->FullyBufferedFramesStart + this->Options.PreBufferingSize);
+	if (previousFrame == nullptr && this->TOC.Frames[iFrame].Keyframe != iFrame)
+	{
+		previousFrame = this->ResolvePredecessor(iFrame);
+	}
 
-		if (bFrameBuffered)
-		{
+	std::shared_ptr<Frame> frame = nullptr;
+	if (previousFrame != nullptr || this->TOC.Frames[iFrame].Keyframe == iFrame)
+	{
+		frame = this->LoadFrameAt(iFrame, previousFrame);
+	}
 
-			//std::printf("Obtaining frame %d\n", iFrame);
+	// completes the requests for it, unless the window moved in the meantime
+	if (frame != nullptr && bPublish)
+	{
+		this->PublishFrame(frame, stepToPublish);
+	}
+	else if (frame != nullptr && !this->BulkLoadRanges.empty())
+	{
+		this->StoreBulkLoadedFrame(frame);
+	}
 
-			// this is the frame we want to return
-			r = this->Frames[iFrame];
+	frameRequests.clear();
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+		this->TakeFrameRequests(iFrame, frameRequests);
+	}
 
-			// remove previous frames 
-			if (!this->Options.BufferEntirePlayback)
-			{
-				while (this->FullyBufferedFramesStart != iFrame)
-				{
-					//std::printf("Removing frame %d\n", this->FullyBufferedFramesStart);
+	for (FrameRequest& request : frameRequests)
+	{
+		CompleteFrameRequest(request, frame);
+	}
 
-					// adjust memory footprint
-					if (this->Frames[this->FullyBufferedFramesStart] != nullptr)
-					{
-						this->Profiling.MemoryUsageForFrames -= (uint64)this->Frames[this->FullyBufferedFramesStart]->Buffer.size();
-					}
+	this->LastRequestedFrame = frame;
 
-					this->Frames[this->FullyBufferedFramesStart] = nullptr;
-					this->FullyBufferedFramesStart++;
-					this->FullyBufferedFramesStart %= numFramesTotal;
+	return true;
+}
 
-					this->FullyBufferedFramesCount--;
-				}
-			}
-		}
-		else if (bFrameIntentedToBeBuffered)
+
+//-----------------------------------------------------------------------------
+// Player::TakeFrameRequests
+//-----------------------------------------------------------------------------
+void Kimura::Player::TakeFrameRequests(uint32 iFrame, std::vector<FrameRequest>& OutRequests)
+{
+	for (auto it = this->PendingFrameRequests.begin(); it != this->PendingFrameRequests.end();)
+	{
+		if (it->FrameIndex == iFrame)
 		{
-			// frame isn't loaded at this time but the player is already working to get there. Do nothing.
-			//std::printf("Frame %d isn't available yet but will be. Waiting...\n", iFrame);
+			OutRequests.push_back(std::move(*it));
+			it = this->PendingFrameRequests.erase(it);
 		}
 		else
 		{
-
-			//std::printf("Requesting frame from non-buffered section. Clearing %d buffered frames and jumping to frame %d \n", this->FullyBufferedFramesCount, iFrame);
-
-			// clear all buffered frames
-			while (this->FullyBufferedFramesCount > 0)
-			{
-				// adjust memory footprint
-				if (this->Frames[this->FullyBufferedFramesStart] != nullptr)
-				{
-					this->Profiling.MemoryUsageForFrames -= this->Frames[this->FullyBufferedFramesStart]->Buffer.size();
-				}
-
-				this->Frames[this->FullyBufferedFramesStart] = nullptr;
-				this->FullyBufferedFramesStart++;
-				this->FullyBufferedFramesStart %= numFramesTotal;
-
-				this->FullyBufferedFramesCount--;
-			}
-
-			// set new buffer start 
-			this->FullyBufferedFramesStart = iFrame;
+			++it;
 		}
-
 	}
+}
 
-	// wake up the player's thread and look for more work to do. 
-	this->WakeUpBufferThreadEvent.notify_one();
 
-	// This will force blocking until the desired frame is ready
-	while (r == nullptr && InForceWait)
+//-----------------------------------------------------------------------------
+// Player::CompleteFrameRequest
+//-----------------------------------------------------------------------------
+void Kimura::Player::CompleteFrameRequest(FrameRequest& InRequest, std::shared_ptr<IFrame> InFrame)
+{
+	// the callback has run by the time the future is ready
+	if (InRequest.Callback)
 	{
-		// wait until a frame has been obtained
-		std::unique_lock<std::mutex> threadLock(this->WaitForFrameBufferedMutex);
-		this->WaitForFrameBufferedEvent.wait(threadLock);
-
-		// *try* to get the frame but do not wait this time
-		r = this->GetFrameAt(iFrame, false);
-
+		InRequest.Callback(InFrame);
 	}
 
-	return r;
+	InRequest.Promise.set_value(InFrame);
 }
 
 
@@ -1498,25 +4439,57 @@ bool Kimura::Player::RetrievePlaybackInformation(PlaybackInformation& OutInfo)
 void Kimura::Player::CollectStats(PlayerStats& OutStats)
 {
 
+	std::unique_lock<std::mutex> profilingLock(this->ProfilingMutex);
+
 	const std::chrono::time_point<std::chrono::high_resolution_clock> now = std::chrono::high_resolution_clock::now();
 	if (now > this->NextStatsCollection)
 	{
-		std::unique_lock<std::mutex> threadLock(this->ProfilingMutex);
-
-		this->StoredProfiling.BytesReadInLastSecond = this->Profiling.BytesReadInLastSecond;
-		this->StoredProfiling.MemoryUsageForFrames = this->Profiling.MemoryUsageForFrames;
+		// the loader keeps counting while they're taken
+		const uint64 numBytesRead = this->Counters.BytesRead.exchange(0);
+		const double readTime = this->Counters.ReadTime.exchange(0) * 1e-9;
+		const double processingTime = this->Counters.ProcessingTime.exchange(0) * 1e-9;
+		const uint32 numFramesProcessed = this->Counters.NumFramesProcessed.exchange(0);
+		const uint64 decodeQueueDepthSum = this->Counters.DecodeQueueDepthSum.exchange(0);
+		const uint32 numFramesQueued = this->Counters.NumFramesQueued.exchange(0);
+		const double decompressionTime = this->Counters.DecompressionTime.exchange(0) * 1e-9;
+		const uint64 numBytesCompressed = this->Counters.BytesCompressed.exchange(0);
+		const uint64 numBytesDecompressed = this->Counters.BytesDecompressed.exchange(0);
+
+		const double elapsedTime = std::chrono::duration<double>(now - this->LastStatsCollection).count();
+		this->LastStatsCollection = now;
+
+		this->StoredProfiling.BytesReadInLastSecond = numBytesRead;
 
 		// update stats
-		this->StoredProfiling.AvgTimeSpentOnReadingFromDiskPerFrame = this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond / (double)this->Profiling.NumFramesProcessedInLastSecond;
-		this->StoredProfiling.AvgTimeSpentOnProcessingPerFrames = this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond / (double)this->Profiling.NumFramesProcessedInLastSecond;
-		this->StoredProfiling.TotalTimeSpentOnReadingFromDiskInLastSecond = this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond;
-		this->StoredProfiling.TotalTimeSpentOnProcessingFramesInLastSecond = this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond;
-		this->StoredProfiling.NumFramesProcessedInLastSecond = this->Profiling.NumFramesProcessedInLastSecond;
+		this->StoredProfiling.AvgTimeSpentOnReadingFromDiskPerFrame = readTime / (double)numFramesProcessed;
+		this->StoredProfiling.AvgTimeSpentOnProcessingPerFrames = processingTime / (double)numFramesProcessed;
+		this->StoredProfiling.TotalTimeSpentOnReadingFromDiskInLastSecond = readTime;
+		this->StoredProfiling.TotalTimeSpentOnProcessingFramesInLastSecond = processingTime;
+		this->StoredProfiling.NumFramesProcessedInLastSecond = numFramesProcessed;
+
+		this->StoredProfiling.CompressionRatio = numBytesCompressed > 0 ? (double)numBytesDecompressed / (double)numBytesCompressed : 0.0;
+		this->StoredProfiling.TotalTimeSpentOnDecompressingInLastSecond = decompressionTime;
+		this->StoredProfiling.AvgTimeSpentOnDecompressingPerFrame = numFramesProcessed > 0 ? decompressionTime / (double)numFramesProcessed : 0.0;
+
+		// the player's task reads, decoding runs on the decode tasks when there are any
+		this->StoredProfiling.AvgDecodeQueueDepth = numFramesQueued > 0 ? (double)decodeQueueDepthSum / (double)numFramesQueued : 0.0;
+		this->StoredProfiling.ReadStageUtilization = elapsedTime > 0.0 ? readTime / elapsedTime : 0.0;
+		this->StoredProfiling.DecodeStageUtilization = elapsedTime > 0.0 ? processingTime / (elapsedTime * std::max(1u, this->Options.NumDecodeTasks)) : 0.0;
+
+		// residency is queried by the loader. SourceData is only set once the source is opened, at which point it no 
+		// longer changes.
+		if (this->Status == PlayerStatus::Ready && this->SourceData != nullptr)
+		{
+			this->StoredProfiling.MappedBytes = this->Source->GetSize();
+			this->StoredProfiling.MappedResidentBytes = this->Counters.MappedResidentBytes;
+		}
 
-		this->Profiling.BytesReadInLastSecond = 0;
-		this->Profiling.TotalTimeSpentOnProcessingFramesInLastSecond = 0;
-		this->Profiling.TotalTimeSpentOnReadingFromDiskInLastSecond = 0;
-		this->Profiling.NumFramesProcessedInLastSecond = 0;
+		// every frame buffer and detached stream comes from the pool. What it has handed out is what frames, buffered 
+		// or held by the application, really retain.
+		uint64 numPoolHits = 0;
+		uint64 numPoolRequests = 0;
+		this->FrameBufferPool->CollectStats(numPoolHits, numPoolRequests, this->StoredProfiling.FrameBufferPoolBytesHeld, this->StoredProfiling.MemoryUsageForFrames);
+		this->StoredProfiling.FrameBufferPoolHitRate = numPoolRequests > 0 ? (double)numPoolHits / (double)numPoolRequests : 0.0;
 
 		// c++ 14
 		//using namespace std::literals;
@@ -1528,10 +4501,35 @@ void Kimura::Player::CollectStats(PlayerStats& OutStats)
 	}
 
 	OutStats = this->StoredProfiling;
+	profilingLock.unlock();
 
-	OutStats.BufferedFramesStart = this->FullyBufferedFramesStart;
 	OutStats.BufferedFramesCount = this->FullyBufferedFramesCount;
 
+	{
+		std::unique_lock<std::mutex> threadLock(this->FrameAccessMutex);
+
+		// the frames are laid out by the task reading the TOC
+		const bool bOpened = this->Status == PlayerStatus::Ready && !this->Frames.empty();
+
+		OutStats.BufferedFramesStart = bOpened ? this->GetFrameAtStep(this->FullyBufferedFramesStart) : 0;
+		OutStats.BufferedBytes = this->FullyBufferedBytes;
+		OutStats.DecodeQueueDepth = (uint32)this->DecodeQueue.size();
+		OutStats.PercentLoaded = bOpened && this->Options.BufferEntirePlayback ? 100.0 * this->FullyBufferedFramesCount / this->Frames.size() : 0.0;
+
+		OutStats.NumSeeks = this->Profiling.NumSeeks;
+		OutStats.LastSeekLatency = this->Profiling.LastSeekLatency;
+		OutStats.AvgSeekLatency = this->Profiling.NumSeeks > 0 ? this->TotalSeekLatency / (double)this->Profiling.NumSeeks : 0.0;
+
+		OutStats.PreBufferingSize = this->PreBufferingSize;
+		OutStats.FrameRequestRate = this->FrameRequestRate;
+		OutStats.NumStarvedRequests = this->Profiling.NumStarvedRequests;
+		OutStats.NumDeadlineMisses = this->Profiling.NumDeadlineMisses;
+
+		OutStats.BackBufferedFramesCount = this->BackBufferedFramesCount;
+		OutStats.BackBufferHits = this->Profiling.BackBufferHits;
+		OutStats.BackBufferMisses = this->Profiling.BackBufferMisses;
+	}
+
 
 }
 
@@ -1988,3 +4986,265 @@ bool Kimura::Frame::GetImageData(uint32 InImageIndex, uint32 InMipmap, const voi
 }
 
 
+
+#if defined(KIMURA_IO_URING)
+
+//-----------------------------------------------------------------------------
+// IOUring::~IOUring
+//-----------------------------------------------------------------------------
+Kimura::IOUring::~IOUring()
+{
+	if (this->SQEntries != nullptr)
+	{
+		munmap(this->SQEntries, this->SQEntriesSize);
+	}
+
+	if (this->CQRing != nullptr && this->CQRing != this->SQRing)
+	{
+		munmap(this->CQRing, this->CQRingSize);
+	}
+
+	if (this->SQRing != nullptr)
+	{
+		munmap(this->SQRing, this->SQRingSize);
+	}
+
+	if (this->RingFile >= 0)
+	{
+		close(this->RingFile);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// IOUring::Initialize
+//-----------------------------------------------------------------------------
+bool Kimura::IOUring::Initialize(uint32 InQueueDepth)
+{
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	this->RingFile = (int)syscall(__NR_io_uring_setup, InQueueDepth, &params);
+	if (this->RingFile < 0)
+	{
+		return false;
+	}
+
+	this->QueueDepth = params.sq_entries;
+
+	this->SQRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32);
+	this->CQRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	// recent kernels map both rings at once
+	const bool bSingleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (bSingleMapping)
+	{
+		this->SQRingSize = std::max(this->SQRingSize, this->CQRingSize);
+		this->CQRingSize = this->SQRingSize;
+	}
+
+	this->SQRing = mmap(nullptr, this->SQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->RingFile, IORING_OFF_SQ_RING);
+	if (this->SQRing == MAP_FAILED)
+	{
+		this->SQRing = nullptr;
+		return false;
+	}
+
+	if (bSingleMapping)
+	{
+		this->CQRing = this->SQRing;
+	}
+	else
+	{
+		this->CQRing = mmap(nullptr, this->CQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->RingFile, IORING_OFF_CQ_RING);
+		if (this->CQRing == MAP_FAILED)
+		{
+			this->CQRing = nullptr;
+			return false;
+		}
+	}
+
+	this->SQEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	void* sqEntries = mmap(nullptr, this->SQEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->RingFile, IORING_OFF_SQES);
+	if (sqEntries == MAP_FAILED)
+	{
+		return false;
+	}
+	this->SQEntries = (io_uring_sqe*)sqEntries;
+
+	byte* sq = (byte*)this->SQRing;
+	this->SQTail = (uint32*)(sq + params.sq_off.tail);
+	this->SQMask = (uint32*)(sq + params.sq_off.ring_mask);
+	this->SQArray = (uint32*)(sq + params.sq_off.array);
+
+	byte* cq = (byte*)this->CQRing;
+	this->CQHead = (uint32*)(cq + params.cq_off.head);
+	this->CQTail = (uint32*)(cq + params.cq_off.tail);
+	this->CQMask = (uint32*)(cq + params.cq_off.ring_mask);
+	this->CQEntries = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// IOUring::QueueRead
+//-----------------------------------------------------------------------------
+bool Kimura::IOUring::QueueRead(int InFile, uint64 InOffset, void* OutData, uint32 InSize, uint64 InUserData)
+{
+	if (this->NumQueued >= this->QueueDepth)
+	{
+		return false;
+	}
+
+	// only this thread produces entries, the kernel only reads the tail
+	uint32 tail = *this->SQTail + this->NumQueued;
+	uint32 index = tail & *this->SQMask;
+
+	io_uring_sqe* sqe = &this->SQEntries[index];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = InFile;
+	sqe->off = InOffset;
+	sqe->addr = (uint64)OutData;
+	sqe->len = InSize;
+	sqe->user_data = InUserData;
+
+	this->SQArray[index] = index;
+	this->NumQueued++;
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// IOUring::Submit
+//-----------------------------------------------------------------------------
+bool Kimura::IOUring::Submit()
+{
+	if (this->NumQueued == 0)
+	{
+		return true;
+	}
+
+	// publish the new entries before telling the kernel about them
+	__atomic_store_n(this->SQTail, *this->SQTail + this->NumQueued, __ATOMIC_RELEASE);
+
+	uint32 numPending = this->NumQueued;
+	this->NumQueued = 0;
+
+	// the kernel may take fewer entries than asked for, the others are handed to it again
+	while (numPending > 0)
+	{
+		const int numSubmitted = (int)syscall(__NR_io_uring_enter, this->RingFile, numPending, 0, 0, nullptr, 0);
+		if (numSubmitted < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (numSubmitted <= 0)
+		{
+			this->NumUnsubmitted = numPending;
+			return false;
+		}
+
+		this->NumInFlight += (uint32)numSubmitted;
+		numPending -= (uint32)numSubmitted;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// IOUring::WaitForCompletion
+//-----------------------------------------------------------------------------
+bool Kimura::IOUring::WaitForCompletion(uint64& OutUserData, int32& OutResult)
+{
+	while (true)
+	{
+		uint32 head = *this->CQHead;
+
+		while (head == __atomic_load_n(this->CQTail, __ATOMIC_ACQUIRE))
+		{
+			if (syscall(__NR_io_uring_enter, this->RingFile, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+			{
+				return false;
+			}
+		}
+
+		io_uring_cqe* cqe = &this->CQEntries[head & *this->CQMask];
+		OutUserData = cqe->user_data;
+		OutResult = cqe->res;
+
+		// hand the entry back to the kernel
+		__atomic_store_n(this->CQHead, head + 1, __ATOMIC_RELEASE);
+
+		if (OutUserData != CancelUserData)
+		{
+			this->NumInFlight--;
+			return true;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// IOUring::Drain
+//-----------------------------------------------------------------------------
+bool Kimura::IOUring::Drain()
+{
+	// entries the kernel didn't take could still be submitted by any later call
+	if (this->NumUnsubmitted > 0)
+	{
+		return false;
+	}
+
+	this->NumQueued = 0;
+
+	if (this->NumInFlight == 0)
+	{
+		return true;
+	}
+
+#if defined(IORING_ASYNC_CANCEL_ANY)
+
+	// reads of regular files can rarely be cancelled once started, the others are. Older kernels reject the request, 
+	// the reads are then waited for.
+	{
+		const uint32 tail = *this->SQTail;
+		const uint32 index = tail & *this->SQMask;
+
+		io_uring_sqe* sqe = &this->SQEntries[index];
+		memset(sqe, 0, sizeof(io_uring_sqe));
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+		sqe->user_data = CancelUserData;
+
+		this->SQArray[index] = index;
+		__atomic_store_n(this->SQTail, tail + 1, __ATOMIC_RELEASE);
+
+		while (syscall(__NR_io_uring_enter, this->RingFile, 1, 0, 0, nullptr, 0) < 0 && errno == EINTR)
+		{
+		}
+	}
+
+#endif
+
+	while (this->NumInFlight > 0)
+	{
+		uint64 userData = 0;
+		int32 result = 0;
+
+		if (!this->WaitForCompletion(userData, result))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#endif
+
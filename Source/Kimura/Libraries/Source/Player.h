@@ -11,7 +11,17 @@
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <map>
+#include <list>
+#include <deque>
+#include <future>
 
 #include "Kimura.h"
 
@@ -32,6 +42,29 @@
 
 	#define KIMURA_TRACE(x)
 
+	// memory mapped files are available on posix systems
+	#if defined(__unix__) || defined(__APPLE__)
+		#define KIMURA_POSIX 1
+	#endif
+
+	// asynchronous reads through io_uring on linux
+	#if defined(__linux__) && defined(__has_include)
+		#if __has_include(<linux/io_uring.h>)
+			#define KIMURA_IO_URING 1
+		#endif
+	#endif
+
+#endif
+
+// SSE2 is part of every x64 target. KIMURA_NO_SIMD builds the scalar code paths instead, which the tests compare 
+// against.
+#if (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)) && !defined(KIMURA_NO_SIMD)
+	#define KIMURA_SSE2 1
+#endif
+
+#if defined(KIMURA_IO_URING)
+	struct io_uring_sqe;
+	struct io_uring_cqe;
 #endif
 
 namespace Kimura
@@ -40,7 +73,7 @@ namespace Kimura
 	struct Version
 	{
 		uint8 A = 0;
-		uint8 B = 5;
+		uint8 B = 8;
 		uint8 C = 0;
 		uint8 NotUsed = 0;
 
@@ -66,6 +99,68 @@ namespace Kimura
 	static const uint32					MaxColorChannels = 2;
 	static const uint32					MaxMipmaps = 8;
 
+	// data streams making up a frame mesh. Each one is either stored in a frame or reused from the previous frame.
+	static const uint32					StreamIndices = 0;
+	static const uint32					StreamPositions = 1;
+	static const uint32					StreamNormals = 2;
+	static const uint32					StreamTangents = 3;
+	static const uint32					StreamVelocities = 4;
+	static const uint32					StreamTexCoords = 5;									// + texcoord channel
+	static const uint32					StreamColors = StreamTexCoords + MaxTextureCoords;	// + color channel
+	static const uint32					NumStreams = StreamColors + MaxColorChannels;
+
+	// a stream reused before any frame stored it
+	static const uint32					NoStreamSource = 0xffffffff;
+
+	// How a stream's values are obtained from what the frame stores (format 0.7 and up). Predicted streams store the 
+	// difference between each of their components and its prediction, wrapping around: the same component in the 
+	// previous frame (Delta), or extrapolated from the two previous frames (Linear). Linear falls back to Delta when 
+	// the previous frame didn't predict the stream itself. Components of full precision formats are taken as 32 bits 
+	// integers, which keeps the reconstruction exact.
+	// 
+	// Sparse streams store the elements (vertices) that changed since the previous frame, applied on top of its 
+	// stream: a number of runs, each run's first element and number of elements (uint32s), then the elements of every 
+	// run one after the other. The size in the frame's table of content is that of the changes, the stream has the 
+	// size of the previous frame's.
+	// 
+	// Basis streams (positions, format 0.8 and up) store a float coefficient for each vector of the mesh's basis (see 
+	// TOCMesh::NumBasisVectors). Positions are the mean shape plus the sum of the vectors, weighted by their 
+	// coefficient. They don't depend on any other frame.
+	// 
+	// Triangles streams (indices) store one code per triangle followed by variable length integers (see 
+	// DecodeTriangles). Triangles sharing an edge with one of the last triangles, or vertices with one of them, only 
+	// take a byte. Triangles may come out rotated, their winding is kept.
+	// 
+	// BytePlanes streams (vertex attributes) store each byte of the vertices as a plane of its own: the difference with 
+	// the same byte of the previous vertex, bit packed in groups of 16 (see DecodeBytePlanes).
+	// 
+	// Both are stored as is (StreamCodec::None) and decoded into the stream's layout.
+	enum class StreamEncoding : uint8
+	{
+		Raw,
+		Delta,
+		Linear,
+		Sparse,
+		Basis,
+		Triangles,
+		BytePlanes
+	};
+
+	inline bool IsPredicted(StreamEncoding InEncoding)
+	{
+		return InEncoding == StreamEncoding::Delta || InEncoding == StreamEncoding::Linear;
+	}
+
+	// decoded from what the frame stores alone, without the previous frame's stream
+	inline bool IsSelfContained(StreamEncoding InEncoding)
+	{
+		return InEncoding == StreamEncoding::Raw || InEncoding == StreamEncoding::Basis || InEncoding == StreamEncoding::Triangles || InEncoding == StreamEncoding::BytePlanes;
+	}
+
+	// byte planes streams are decoded in blocks of vertices, of up to this many bytes each
+	static const uint32					BytePlanesBlockSize = 256;
+	static const uint32					MaxBytePlanes = 64;
+
 
 	class TOCMesh
 	{
@@ -84,6 +179,32 @@ namespace Kimura
 			TexCoordFormat		TexCoordFormat_ = TexCoordFormat::Full;
 			ColorFormat			ColorFormat_ = ColorFormat::Byte;
 
+			// Basis that positions are reconstructed from (see StreamEncoding), stored once at BasisPosition in the 
+			// frame data: the mean shape then each vector, MaxVertices float positions each. Vectors come in order of 
+			// importance, BasisErrors holds the largest distance to the encoded positions when only the first 1, 2, 
+			// ... NumBasisVectors vectors are used (format 0.8 and up).
+			uint32				NumBasisVectors = 0;
+			uint64				BasisPosition = 0;
+			std::vector<float>	BasisErrors;
+
+			// size of the components making up the vertex attribute streams (positions, normals, tangents and 
+			// velocities), 0 for the others
+			inline uint32 GetComponentSize(uint32 InStream) const
+			{
+				// formats of these streams all go from full precision to bytes
+				static const uint32 sizes[] = { 4, 2, 1, 0 };
+
+				switch (InStream)
+				{
+					case StreamPositions:	return sizes[(int)this->PositionFormat_];
+					case StreamNormals:		return sizes[(int)this->NormalFormat_];
+					case StreamTangents:	return sizes[(int)this->TangentFormat_];
+					case StreamVelocities:	return sizes[(int)this->VelocityFormat_];
+				}
+
+				return 0;
+			}
+
 	};
 
 	enum class ImageFormat
@@ -163,8 +284,70 @@ namespace Kimura
 			bool DependsOnPreviousFrame = false;
 			uint32 FrameIndexDependency = 0;
 
+			// frame storing each stream, either this frame or the most recent one before it (NoStreamSource if none)
+			uint32 StreamSources[NumStreams] = {};
+
+			// how each stream is stored (format 0.6 and up) and its size in the frame. The sizes above are those of 
+			// the decoded streams. Compressed streams used by this frame alone are decompressed in its buffer, at 
+			// TOCFrame::DecodedOffset plus their own offset.
+			StreamCodec StreamCodecs[NumStreams] = {};
+			uint32 StoredStreamSizes[NumStreams] = {};
+			uint64 DecodedStreamOffsets[NumStreams] = {};
+
+			// see StreamEncoding (format 0.7 and up). The changes making up sparse streams are decoded at 
+			// DecodedStreamOffsets, the stream itself always gets a block of its own.
+			StreamEncoding StreamEncodings[NumStreams] = {};
+			uint32 SparseStreamSizes[NumStreams] = {};
+
+			// streams that frames after this one still need once it's released, copied out of its buffer (see 
+			// Player::DetachStream). Either reused by the next frame or the base of its linear prediction.
+			bool DetachedStreams[NumStreams] = {};
+
 			std::vector<TOCFrameMeshSection>	Sections;
 
+			// offset of a stream in the frame's buffer, or -1 when it's reused from the previous frame
+			inline int32 GetStreamSeek(uint32 InStream) const
+			{
+				switch (InStream)
+				{
+					case StreamIndices:		return this->SeekIndices;
+					case StreamPositions:	return this->SeekPositions;
+					case StreamNormals:		return this->SeekNormals;
+					case StreamTangents:	return this->SeekTangents;
+					case StreamVelocities:	return this->SeekVelocities;
+				}
+
+				return InStream < StreamColors ? this->SeekTexCoords[InStream - StreamTexCoords] : this->SeekColors[InStream - StreamColors];
+			}
+
+			inline uint32 GetStreamSize(uint32 InStream) const
+			{
+				switch (InStream)
+				{
+					case StreamIndices:		return this->SizeIndices;
+					case StreamPositions:	return this->SizePositions;
+					case StreamNormals:		return this->SizeNormals;
+					case StreamTangents:	return this->SizeTangents;
+					case StreamVelocities:	return this->SizeVelocities;
+				}
+
+				return InStream < StreamColors ? this->SizeTexCoords[InStream - StreamTexCoords] : this->SizeColors[InStream - StreamColors];
+			}
+
+			inline void SetStreamSize(uint32 InStream, uint32 InSize)
+			{
+				switch (InStream)
+				{
+					case StreamIndices:		this->SizeIndices = InSize; return;
+					case StreamPositions:	this->SizePositions = InSize; return;
+					case StreamNormals:		this->SizeNormals = InSize; return;
+					case StreamTangents:	this->SizeTangents = InSize; return;
+					case StreamVelocities:	this->SizeVelocities = InSize; return;
+				}
+
+				(InStream < StreamColors ? this->SizeTexCoords[InStream - StreamTexCoords] : this->SizeColors[InStream - StreamColors]) = InSize;
+			}
+
 
 	};
 
@@ -178,6 +361,14 @@ namespace Kimura
 
 			int32		SeekPosition = 0;
 			uint32		Size = 0;
+
+			// frame storing the mipmap, same as TOCFrameMesh::StreamSources
+			uint32		SourceFrame = NoStreamSource;
+
+			// same as TOCFrameMesh::StreamCodecs
+			StreamCodec	Codec = StreamCodec::None;
+			uint32		StoredSize = 0;
+			uint64		DecodedOffset = 0;
 	};
 
 	class TOCFrameImage
@@ -190,6 +381,13 @@ namespace Kimura
 
 	};
 
+	struct TOCFrameReadRange
+	{
+		uint64	Offset = 0;			// in the frame
+		uint64	Size = 0;
+		uint64	BufferOffset = 0;	// in the frame's buffer
+	};
+
 	class TOCFrame
 	{
 		public:
@@ -199,15 +397,49 @@ namespace Kimura
 				return this->DependsOnPreviousFrame;
 			}
 
+			// position of data in the frame's buffer, given its position in the frame
+			inline uint64 GetBufferOffset(int32 InSeek) const
+			{
+				for (const TOCFrameReadRange& r : this->ReadRanges)
+				{
+					if ((uint64)InSeek >= r.Offset && (uint64)InSeek < r.Offset + r.Size)
+					{
+						return r.BufferOffset + (uint64)InSeek - r.Offset;
+					}
+				}
+
+				return (uint64)InSeek;
+			}
+
 			uint64	FilePosition = 0;
 			uint64	BufferSize = 0;
 
 			bool DependsOnPreviousFrame = false;
 			uint32 FrameIndexDependency = 0;
 
+			// closest keyframe (a frame that doesn't depend on any other) at or before this frame
+			uint32 Keyframe = 0;
+
+			// predicted streams, stored by the frame or reused from the frame storing them, are only known once the 
+			// frames before are decoded
+			bool PredictedFromPreviousFrames = false;
+
 			std::vector<TOCFrameMesh>		Meshes;
 			std::vector<TOCFrameImage>		Images;
 
+			// portions of the frame that are actually read, packed one after the other in the frame's buffer. Data of 
+			// constant meshes is left out, it's loaded only once.
+			std::vector<TOCFrameReadRange>	ReadRanges;
+			uint64							ReadSize = 0;
+
+			// compressed streams are decompressed after the read ranges, or at the start of the buffer for frames 
+			// pointing into the source
+			uint64							DecodedOffset = 0;
+			uint64							DecodedSize = 0;
+
+			// memory the frame retains once loaded: its buffer and the streams it detaches for the next frame
+			uint64							RetainedSize = 0;
+
 	};
 
 	class TableOfContent
@@ -235,10 +467,15 @@ namespace Kimura
 
 	};
 
+	class PooledBuffer;
+
 	class FrameMesh
 	{
 		public:
 
+			// point the format specific members (PositionsF32, NormalsI16, etc) to the streams
+			void AssignStreams(const TOCMesh& InMesh, bool In16BitIndices);
+
 			// 
 			uint32					Vertices = 0;
 			uint32					Surfaces = 0;
@@ -289,6 +526,17 @@ namespace Kimura
 			const uint8*			ColorsU8[MaxColorChannels] = { nullptr, nullptr };
 			Vector4					ColorQuantizationExtents[MaxColorChannels];
 
+			// address of each stream, whatever its format
+			const byte*				Streams[NumStreams] = {};
+
+			// streams that are reused by the next frame live in a block of their own rather than in the frame's 
+			// buffer. Frames reusing a stream only keep that block alive, not the entire buffer it was read into.
+			std::shared_ptr<PooledBuffer>	StreamBlocks[NumStreams];
+
+			// streams of the previous frame, kept for the next frame's linear prediction (see StreamEncoding)
+			const byte*						PreviousStreams[NumStreams] = {};
+			std::shared_ptr<PooledBuffer>	PreviousStreamBlocks[NumStreams];
+
 
 	};
 
@@ -296,6 +544,9 @@ namespace Kimura
 	{
 		const void* Data = nullptr;
 		uint32 Size;
+
+		// set when the mipmap is reused by the next frame, same as FrameMesh::StreamBlocks
+		std::shared_ptr<PooledBuffer>	Block;
 	};
 
 	class FrameImage
@@ -307,6 +558,330 @@ namespace Kimura
 	};
 
 
+	// size in the file of the fixed parts of the table of content's frame entries (see Player::ReadTOC). A frame mesh
+	// entry holds its vertex, surface and section counts, then its sections, the seek and size of each stream, the
+	// quantization of positions, velocities and colors, and its bounds. Codecs and encodings follow from 0.6 and 0.7.
+	static const uint64					TOCFrameEntrySize = 2 * sizeof(uint64);
+	static const uint64					TOCFrameMeshSectionEntrySize = 5 * sizeof(uint32);
+	static const uint64					TOCFrameMeshEntrySize = 3 * sizeof(uint32) + NumStreams * (sizeof(int32) + sizeof(uint32)) + 6 * sizeof(Vector3) + MaxColorChannels * sizeof(Vector4);
+	static const uint64					TOCFrameMeshCodecsEntrySize = NumStreams * (sizeof(StreamCodec) + sizeof(uint32));
+	static const uint64					TOCFrameMeshEncodingsEntrySize = NumStreams * sizeof(StreamEncoding);
+	static const uint64					TOCMipmapEntrySize = 6 * sizeof(uint32);
+	static const uint64					TOCMipmapCodecEntrySize = sizeof(StreamCodec) + sizeof(uint32);
+
+	static_assert(TOCFrameMeshEntrySize == 204 && TOCMipmapEntrySize == 24, "Layout of the table of content changed, update Player::ReadTOC");
+
+	// Bounds checked cursor used to parse the table of content from memory. The cursor either walks a block that is
+	// entirely available (ex: a file mapping) or a buffer that's filled through a read function, in large reads, as 
+	// parsing progresses. Any attempt to read past the end of the file flags the reader as failed.
+	class TOCReader
+	{
+		public:
+
+			typedef std::function<bool(uint64 InOffset, void* OutData, uint64 InSize)> ReadFunction;
+
+			TOCReader(const byte* InData, uint64 InSize);
+			TOCReader(ReadFunction InReadFunction, uint64 InFileSize);
+
+			template<typename T>
+			bool Read(T& Out, uint32 InCount = 1)
+			{
+				const uint64 size = sizeof(T) * InCount;
+				if (!this->Require(size))
+				{
+					return false;
+				}
+
+				memcpy((void*)&Out, &this->Data[this->Position], size);
+				this->Position += size;
+				return true;
+			}
+
+			bool Read(std::string& Out);
+			bool Read(bool& Out);
+
+			// make sure the next InSize bytes are buffered, using a single read when possible
+			bool Reserve(uint64 InSize);
+
+			uint64 Tell() const { return this->Position; }
+			uint64 GetRemainingSize() const { return this->FileSize - this->Position; }
+			bool HasFailed() const { return this->Failed; }
+
+		protected:
+
+			bool Require(uint64 InSize);
+
+			ReadFunction			ReadFile;
+			std::vector<byte>		Buffer;
+
+			// bytes [0, DataSize) of the file are available at Data
+			const byte*				Data = nullptr;
+			uint64					DataSize = 0;
+
+			uint64					Position = 0;
+			uint64					FileSize = 0;
+
+			bool					Failed = false;
+	};
+
+	// decoders of the codecs implemented by the library (see StreamCodec). They only succeed when the data decodes to 
+	// exactly OutSize bytes.
+	bool DecodeLZ4(const byte* InData, uint64 InSize, byte* OutData, uint64 OutSize);
+
+	// adds the residuals of a predicted stream to its prediction (see StreamEncoding). InBeforePrevious is only used 
+	// for linear prediction. OutData may be InResiduals.
+	void ReconstructStream(StreamEncoding InEncoding, uint32 InComponentSize, const byte* InResiduals, const byte* InPrevious, const byte* InBeforePrevious, byte* OutData, uint64 InSize);
+
+	// mean shape and vectors of a mesh's basis, as many as PlayerOptions::MaxBasisError calls for
+	class MeshBasis
+	{
+		public:
+			uint32				NumVectors = 0;
+			uint64				NumFloats = 0;		// of the mean shape and of each vector
+			std::vector<float>	Data;				// the mean shape, then each vector
+	};
+
+	// positions InFirstVertex to InFirstVertex + InNumVertices of a basis stream, from a coefficient for each vector 
+	// of the basis. Quantized positions (PositionFormat::Half) use the frame's quantization center and extents.
+	void ReconstructFromBasis(const MeshBasis& InBasis, const byte* InCoefficients, uint64 InFirstVertex, uint64 InNumVertices, PositionFormat InFormat, const Vector3& InCenter, const Vector3& InExtents, byte* OutData);
+
+	// decodes a triangles stream (see StreamEncoding) into OutSize bytes of InIndexSize bytes indices. Each triangle 
+	// has a code: the edge it shares with one of the last 15 triangles (high 4 bits, 15 when none) and its third vertex 
+	// (low 4 bits): 0 for the next vertex never referenced so far, 1 to 14 for one of the last vertices and 15 for an 
+	// explicit vertex. Triangles without a shared edge have 3 vertices: 0 for the next one, 1 to 15 for the last ones, 
+	// explicit otherwise (+ 16). Explicit vertices are the zigzagged difference with the last explicit vertex. Codes 
+	// come first, then the vertices as 7 bits variable length integers.
+	bool DecodeTriangles(const byte* InData, uint64 InSize, byte* OutData, uint64 OutSize, uint32 InIndexSize);
+
+	// decodes a byte planes stream (see StreamEncoding) into OutSize bytes of InVertexSize bytes vertices. For each 
+	// block of BytePlanesBlockSize vertices, then each byte of the vertices: a header of 2 bits per group of 16 
+	// vertices (lowest bits first) selects 0, 2, 4 or 8 bits per value, then the groups' values, highest bits first. 
+	// Values are the zigzagged difference with the previous vertex.
+	bool DecodeBytePlanes(const byte* InData, uint64 InSize, byte* OutData, uint64 OutSize, uint32 InVertexSize);
+
+	// applies the changes of a sparse stream (see StreamEncoding) to the previous frame's stream, InSize bytes made of 
+	// InElementSize bytes elements. Changes out of bounds fail.
+	bool ApplySparseStream(const byte* InChanges, uint64 InChangesSize, const byte* InPrevious, byte* OutData, uint64 InSize, uint64 InElementSize);
+
+	// Byte source reading from a file on disk, through the platform's file API.
+	class FileByteSource : public IByteSource
+	{
+		public:
+
+			virtual ~FileByteSource();
+
+			bool Open(const std::string& InPath);
+
+			virtual uint64 GetSize() override;
+			virtual bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize) override;
+			virtual int GetFileDescriptor() override;
+
+		protected:
+
+			uint64						Size = 0;
+
+#if defined(KIMURA_UNREAL)
+			class IFileHandle*			UEFileHandle = nullptr;
+			std::mutex					ReadMutex;
+#elif defined(KIMURA_WINDOWS)
+			int							FileHandle = -1;
+			std::mutex					ReadMutex;
+#elif defined(KIMURA_POSIX)
+			// pread doesn't move a shared file position, concurrent reads need no lock
+			int							FileDescriptor = -1;
+#else
+			std::ifstream				InputFile;
+			std::mutex					ReadMutex;
+#endif
+	};
+
+#if defined(KIMURA_POSIX)
+
+	// Read-only mapping of an entire file. Frames created from a mapping point straight into it and keep it 
+	// alive through a shared reference to the source.
+	class MappedFileByteSource : public IByteSource
+	{
+		public:
+
+			virtual ~MappedFileByteSource();
+
+			bool Open(const std::string& InPath);
+
+			virtual uint64 GetSize() override;
+			virtual bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize) override;
+			virtual const byte* Map() override;
+
+			// hint the system that a range of the mapping is about to be accessed
+			virtual void Prefetch(uint64 InOffset, uint64 InSize) override;
+
+			virtual uint64 GetResidentBytes() override;
+
+		protected:
+
+			const byte*		Data = nullptr;
+			uint64			Size = 0;
+	};
+
+#endif
+
+	// Byte source over a block of memory, either owned by the source or provided by the caller.
+	class MemoryByteSource : public IByteSource
+	{
+		public:
+
+			MemoryByteSource(std::vector<byte>&& InData);
+			MemoryByteSource(const void* InData, uint64 InSize);
+
+			virtual uint64 GetSize() override;
+			virtual bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize) override;
+			virtual const byte* Map() override;
+			virtual uint64 GetResidentBytes() override;
+
+		protected:
+
+			std::vector<byte>	OwnedData;
+			const byte*			Data = nullptr;
+			uint64				Size = 0;
+	};
+
+#if defined(KIMURA_IO_URING)
+
+	// Minimal io_uring submission/completion queue, used to keep several frame reads in flight at once. 
+	class IOUring
+	{
+		public:
+
+			~IOUring();
+
+			bool Initialize(uint32 InQueueDepth);
+
+			// queue a positional read. Queued reads are handed to the kernel all at once by Submit()
+			bool QueueRead(int InFile, uint64 InOffset, void* OutData, uint32 InSize, uint64 InUserData);
+			bool Submit();
+
+			// forgets the reads queued since the last Submit(), the kernel never saw them
+			void DiscardQueued() { this->NumQueued = 0; }
+
+			// blocks until one of the submitted reads completes. OutResult is the number of bytes read or a negative 
+			// error code.
+			bool WaitForCompletion(uint64& OutUserData, int32& OutResult);
+
+			// cancels the submitted reads and waits until the kernel is done with every one of them. False when the 
+			// ring fails first, the buffers of the reads in flight may then be written to at any time.
+			bool Drain();
+
+			uint32 GetQueueDepth() const { return this->QueueDepth; }
+
+		protected:
+
+			// completion of the cancellation requested by Drain(), not a read
+			static const uint64		CancelUserData = ~0ull;
+
+			int						RingFile = -1;
+			uint32					QueueDepth = 0;
+			uint32					NumQueued = 0;
+			uint32					NumInFlight = 0;		// submitted, not completed yet
+			uint32					NumUnsubmitted = 0;		// left in the ring by a failed Submit()
+
+			// submission queue
+			void*					SQRing = nullptr;
+			uint64					SQRingSize = 0;
+			uint32*					SQTail = nullptr;
+			uint32*					SQMask = nullptr;
+			uint32*					SQArray = nullptr;
+			::io_uring_sqe*			SQEntries = nullptr;
+			uint64					SQEntriesSize = 0;
+
+			// completion queue (may share the submission queue's mapping)
+			void*					CQRing = nullptr;
+			uint64					CQRingSize = 0;
+			uint32*					CQHead = nullptr;
+			uint32*					CQTail = nullptr;
+			uint32*					CQMask = nullptr;
+			::io_uring_cqe*			CQEntries = nullptr;
+	};
+
+#endif
+
+	class BufferPool;
+
+	// Block of uninitialized memory obtained from a BufferPool. Handed back to the pool when released or destroyed.
+	class PooledBuffer
+	{
+		public:
+
+			PooledBuffer() {}
+			PooledBuffer(PooledBuffer&& InOther);
+			PooledBuffer& operator=(PooledBuffer&& InOther);
+			~PooledBuffer();
+
+			PooledBuffer(const PooledBuffer&) = delete;
+			PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+			void Release();
+
+			// forgets the memory without handing it back to the pool, for buffers the system may still write to
+			void Leak();
+
+			byte*	GetData() const { return this->Data; }
+			uint64	GetSize() const { return this->Size; }
+
+		protected:
+
+			friend class BufferPool;
+
+			byte*						Data = nullptr;
+			uint64						Size = 0;
+			uint64						Capacity = 0;
+
+			// buffers may outlive the player, through frames held by the application
+			std::shared_ptr<BufferPool>	Pool;
+	};
+
+	// Recycles the memory of retired frames. Buffers are grouped by size class so that frames of similar sizes share 
+	// them, and are never zero-filled since they're about to be overwritten with file data.
+	class BufferPool : public std::enable_shared_from_this<BufferPool>
+	{
+		public:
+
+			BufferPool(uint64 InMaxBytesHeld, bool InUseHugePages);
+			~BufferPool();
+
+			PooledBuffer Acquire(uint64 InSize);
+
+			// frees idle buffers, largest first, until InBytes have been freed. Returns the amount actually freed.
+			uint64 Purge(uint64 InBytes);
+
+			uint64 GetBytesHeld();
+
+			// OutBytesInUse is the memory of every buffer currently handed out, wherever they're held
+			void CollectStats(uint64& OutNumHits, uint64& OutNumRequests, uint64& OutBytesHeld, uint64& OutBytesInUse);
+
+		protected:
+
+			friend class PooledBuffer;
+
+			void Return(byte* InData, uint64 InCapacity);
+
+			static uint64 GetSizeClass(uint64 InSize);
+
+			byte* AllocateMemory(uint64 InCapacity);
+			void FreeMemory(byte* InData);
+
+			std::mutex								Mutex;
+
+			// idle buffers, by capacity
+			std::multimap<uint64, byte*>			FreeBuffers;
+
+			uint64									BytesHeld = 0;
+			uint64									BytesInUse = 0;
+			uint64									MaxBytesHeld = 0;
+			bool									UseHugePages = false;
+
+			uint64									NumHits = 0;
+			uint64									NumRequests = 0;
+	};
+
 	class Frame : public IFrame
 	{
 		public:
@@ -354,14 +929,130 @@ namespace Kimura
 			virtual bool			GetImageData(uint32 InImageIndex, uint32 InMipmap, const void** OutData, uint32& OutSize) override;
 
 
-			std::vector<byte>		Buffer;
+			PooledBuffer			Buffer;
 
 			std::vector<FrameMesh>	Meshes;
 			std::vector<FrameImage>	Images;
 
-			// whenever a frame is dependent on a previous frame, we keep a reference to it 
-			// to keep it alive
-			std::vector<std::shared_ptr<Frame>>	FrameDependencies;
+			// when set, the frame's data lives in the source's memory rather than in Buffer
+			std::shared_ptr<IByteSource>		MappedSource;
+	};
+
+
+
+	// Each thread runs the tasks of its own queue in order, then steals the most recent tasks of the others once it 
+	// runs out. Players resubmit themselves to the queue of the thread they ran on, behind the tasks already there.
+	class ThreadPool : public ITaskScheduler
+	{
+		public:
+
+			ThreadPool(uint32 InNumThreads);
+			virtual ~ThreadPool();
+
+			virtual void	Submit(std::function<void()> InTask) override;
+
+		protected:
+
+			struct Worker
+			{
+				std::mutex								Mutex;
+				std::deque<std::function<void()>>		Tasks;
+				std::thread								Thread;
+			};
+
+			void	WorkerExecute(uint32 InWorkerIndex);
+			void	TakeTask(uint32 InWorkerIndex, std::function<void()>& OutTask);
+
+			std::vector<std::unique_ptr<Worker>>	Workers;
+
+			std::mutex								Mutex;
+			std::condition_variable					TaskSubmittedEvent;
+			uint64									NumTasksQueued = 0;		// not yet claimed by a worker
+			uint32									NextWorker = 0;
+			bool									Stopping = false;
+	};
+
+
+
+	class Player;
+
+	// Orders the loads of all the players by deadline, earliest first, whatever the task scheduler running them. Each 
+	// task submitted runs the most urgent load queued for its scheduler.
+	class DeadlineScheduler
+	{
+		public:
+
+			static DeadlineScheduler& Get();
+
+			void	Schedule(Player* InPlayer, std::shared_ptr<ITaskScheduler> InScheduler, std::chrono::steady_clock::time_point InDeadline);
+
+			// moves up the deadline of the player's queued load. False when it has none queued.
+			bool	Reschedule(Player* InPlayer, std::chrono::steady_clock::time_point InDeadline);
+
+			// when cleared, loads run in the order they were queued. Only meant to measure what ordering them by 
+			// deadline brings (see Tests/Benchmarks/SchedulingBenchmark.cpp).
+			void	SetEarliestDeadlineFirst(bool InEarliestDeadlineFirst);
+
+		protected:
+
+			void	RunNext(ITaskScheduler* InScheduler);
+
+			struct Entry
+			{
+				Player*									Player_ = nullptr;
+				ITaskScheduler*							Scheduler = nullptr;
+				std::chrono::steady_clock::time_point	Deadline;
+			};
+
+			std::mutex			Mutex;
+			std::vector<Entry>	Entries;
+			bool				EarliestDeadlineFirst = true;
+	};
+
+
+
+	// Arbitrates a memory budget between the players registered with it
+	class MemoryBudget : public IMemoryBudget
+	{
+		public:
+
+			// a registered player. May outlive it, the player is detached when it unregisters.
+			class Client
+			{
+				public:
+
+					std::mutex	Mutex;						// held while releasing the player's frames
+					Player*		Player_ = nullptr;
+					int32		Priority = 0;
+					uint64		BytesUsed = 0;				// guarded by the budget's mutex, as is Registered
+					bool		Registered = true;
+			};
+
+			MemoryBudget(uint64 InBytes);
+
+			virtual void	SetBudget(uint64 InBytes) override;
+			virtual uint64	GetBudget() override;
+			virtual uint64	GetBytesUsed() override;
+			virtual uint64	Trim(uint64 InBytes) override;
+
+			std::shared_ptr<Client>	Register(Player* InPlayer, int32 InPriority);
+			void					Unregister(std::shared_ptr<Client> InClient);
+
+			void					SetBytesUsed(Client& InClient, uint64 InBytes);
+
+			// whether the client may buffer InBytes more. To make room, back buffers of players that don't rank above 
+			// it are released, then frames buffered ahead by players ranking below it.
+			bool					Admit(Client& InClient, uint64 InBytes);
+
+		protected:
+
+			// lowest priority first. Without requester, every player is eligible.
+			uint64					Release(uint64 InBytes, bool InLookAhead, const Client* InRequester);
+
+			std::mutex								Mutex;
+			uint64									Budget = 0;
+			uint64									BytesUsed = 0;
+			std::vector<std::shared_ptr<Client>>	Clients;
 	};
 
 
@@ -371,6 +1062,7 @@ namespace Kimura
 		public:
 
 			Player(const std::string& InPath, const PlayerOptions& InOptions);
+			Player(std::shared_ptr<IByteSource> InSource, const PlayerOptions& InOptions);
 			virtual ~Player();
 
 			virtual PlayerStatus GetStatus() override;
@@ -384,6 +1076,8 @@ namespace Kimura
 			virtual uint32 GetNumFrames() override;
 			virtual int GetBufferedFrameCount() override;
 			virtual std::shared_ptr<IFrame>	GetFrameAt(uint32 iFrame, bool InForceWait) override;
+			virtual std::shared_ptr<IFrame>	GetFrameAt(uint32 iFrame, std::chrono::steady_clock::time_point InDeadline) override;
+			virtual std::shared_future<std::shared_ptr<IFrame>>	RequestFrame(uint32 iFrame, FrameRequestCallback InCallback) override;
 			virtual std::shared_ptr<IFrame>	GetConstantFrame() override;
 
 			virtual bool	IsForcing16BitIndices() override;
@@ -394,64 +1088,285 @@ namespace Kimura
 
 		protected:
 
+			friend class MemoryBudget;
+			friend class DeadlineScheduler;
+
+			struct FrameRequest
+			{
+				uint32									FrameIndex = 0;
+				std::promise<std::shared_ptr<IFrame>>	Promise;
+				FrameRequestCallback					Callback;
+				std::chrono::steady_clock::time_point	RequestTime;
+			};
+
+			// frame read by the player's task, set up by a decode task
+			struct DecodeJob
+			{
+				std::shared_ptr<Frame>	Frame_;
+				byte*					BufferAddress = nullptr;
+				std::shared_ptr<Frame>	PreviousFrame;				// set up and published ahead of this one
+				uint32					Step = 0;
+				bool					bDecodeStarted = false;
+				bool					bDecoded = false;
+				bool					bSetUp = false;				// taken from the buffered frames, only published
+			};
+
 			void Failure(std::string InErrorMessage);
 
-			void ThreadExecute();
+			// the player's work, run by the task scheduler. The first task opens the document.
+			void ExecuteTask(std::chrono::steady_clock::time_point InDeadline);
+			std::chrono::steady_clock::time_point GetLoadDeadline();
+			bool Open();
 
 			void Stop(bool InWaitToComplete);
 
-			bool ReadTOC();
+			void WakeUpBufferThread();
+
+			// waits until InDeadline when InForceWait is set, forever if it's the latest time point
+			std::shared_ptr<IFrame> GetFrameUntil(uint32 iFrame, bool InForceWait, std::chrono::steady_clock::time_point InDeadline);
+
+			// TakeFrameRequests expects FrameAccessMutex to be held
+			bool LoadRequestedFrame();
+			void TakeFrameRequests(uint32 iFrame, std::vector<FrameRequest>& OutRequests);
+			static void CompleteFrameRequest(FrameRequest& InRequest, std::shared_ptr<IFrame> InFrame);
+
+			bool ReadTOC(TOCReader& InReader);
+			bool ComputeFrameDependencies();
+			void PrepareReadRanges();
+			bool LoadConstantMeshes();
+			bool LoadMeshBases();
+
+			// 16 bits indices unless the mesh has too many vertices for them
+			uint32 GetIndexSize(const TOCFrameMesh& InFrameMesh) const { return InFrameMesh.Vertices <= 0xfffe || this->TOC.Force16BitIndices ? 2 : 4; }
+
+			// mapped sources are only pointed into when every stream handed out as is lies at an address aligned to 
+			// its elements
+			bool IsSourceDataAligned() const;
+			uint32 GetStreamAlignment(const TOCMesh& InMesh, const TOCFrameMesh& InFrameMesh, uint32 InStream) const;
 
 			bool BufferNextFrame();
-			void LoadFrameAt(uint32 iFrame);
+			bool BufferNextFramesAsync();
+			void PublishFrame(std::shared_ptr<Frame> InFrame, uint32 InStep);
+
+			// decode pipeline, see PlayerOptions::NumDecodeTasks. GetFramesInFlight expects FrameAccessMutex to be held.
+			uint32 GetFramesInFlight(uint64& OutBytes, std::shared_ptr<Frame>& OutLastFrame) const;
+			void QueueFrameForDecode(std::shared_ptr<Frame> InFrame, byte* InBufferAddress, std::shared_ptr<Frame> InPreviousFrame, uint32 InStep, bool InSetUp);
+			void ExecuteDecodeTask();
+			void PublishDecodedFrames(DecodeJob* InDecodedJob);
+
+			// bulk load of the entire playback, see PlayerOptions::NumBulkLoadTasks
+			void StartBulkLoad();
+			void ExecuteBulkLoadTask();
+			void StoreBulkLoadedFrame(std::shared_ptr<Frame> InFrame);
+
+			void TrimBackBuffer(uint32 InNumFramesReserved);
+			void UpdatePreBufferingSize(bool InStarved);
+			uint64 GetFrameMemoryUsage(const Frame& InFrame) const;
+			bool FitsBufferedBytesBudget(uint32 InStep, uint64 InBytesPending) const;
+			bool IsStepAwaited(uint32 InStep) const;
+
+			// shared memory budget. ReportMemoryUsage and GetMemoryUsage expect FrameAccessMutex to be held, the others 
+			// take it.
+			bool AdmitMemory(uint64 InBytes);
+			void ReportMemoryUsage();
+			uint64 GetMemoryUsage();
+			uint64 ReleaseFrames(uint64 InBytes, bool InLookAhead);
+
+			std::shared_ptr<Frame> LoadFrameAt(uint32 iFrame, std::shared_ptr<Frame> InPreviousFrame);
+			std::shared_ptr<Frame> ReadFrame(uint32 iFrame, byte*& OutBufferAddress);
+			std::shared_ptr<Frame> AllocateFrame(uint32 iFrame, byte*& OutBufferAddress);
+
+			// decoding sets up what the frame stores itself and can run in any order, linking takes the rest from the 
+			// previous frame and must follow it
+			void SetupFrame(std::shared_ptr<Frame> InFrame, byte* InBufferAddress, std::shared_ptr<Frame> InPreviousFrame);
+			void DecodeFrame(Frame& InFrame, byte* InBufferAddress);
+			void LinkFrame(Frame& InFrame, const Frame* InPreviousFrame);
+
+			// compressed streams, see PlayerOptions::NumDecompressionTasks
+			struct StreamDecodeJob
+			{
+				StreamCodec		Codec = StreamCodec::None;
+				const byte*		Data = nullptr;
+				uint64			StoredSize = 0;
+				byte*			Decoded = nullptr;
+				uint64			Size = 0;
 
-			template<typename T>
-			uint32 Read(T& Out, uint32 InCount = 1);
-			uint32 Read(std::string& s);
+				// basis streams are reconstructed by several jobs, a range of vertices each
+				const MeshBasis*	Basis = nullptr;
+				uint64				FirstVertex = 0;
+				PositionFormat		Format = PositionFormat::Full;
+				Vector3				QuantizationCenter;
+				Vector3				QuantizationExtents;
+
+				// triangles and byte planes streams are decoded into elements of this size, indices or vertices
+				StreamEncoding		Encoding = StreamEncoding::Raw;
+				uint32				ElementSize = 0;
+			};
+
+			bool DecodeStreams(std::vector<StreamDecodeJob>& InJobs);
+			static bool DecodeStream(const StreamDecodeJob& InJob, IStreamDecoder* InDecoder);
+
+			// frames are buffered in playback order, one step after the other. Steps only match frame indices when 
+			// playing forward. In ping pong, every frame but the first and last one is played at two different steps.
+			uint32 GetNumPlaybackSteps() const;
+			uint32 GetFrameAtStep(uint32 InStep) const;
+			uint32 GetStepOfFrame(uint32 iFrame) const;
+			std::shared_ptr<Frame> FindBufferedFrame(uint32 iFrame) const;
+
+			std::shared_ptr<Frame> GetBufferedPredecessor(uint32 iFrame);
+
+			// builds a stand-in for the frame preceding iFrame, made of the streams iFrame reuses. Each one is shared 
+			// with the following frame when it's buffered and reuses it too (reverse playback), taken from the closest 
+			// keyframe or read from the most recent frame storing it.
+			std::shared_ptr<Frame> ResolvePredecessor(uint32 iFrame);
+
+			// decodes the frames from the closest buffered frame or keyframe up to iFrame, for predicted streams
+			std::shared_ptr<Frame> DecodeFramesUpTo(uint32 iFrame);
+
+			std::shared_ptr<Frame> GetKeyframe(uint32 iFrame);
+			const byte* ReadStream(uint32 iFrame, int32 InSeek, uint32 InStoredSize, StreamCodec InCodec, uint32 InSize, std::shared_ptr<PooledBuffer>& OutBlock);
+			const byte* DetachStream(const Frame& InFrame, const byte* InData, uint64 InSize, bool InReusedByNextFrame, std::shared_ptr<PooledBuffer>& OutBlock);
 
 
 			std::string		InputFilePath;
 			PlayerOptions	Options;
 
-			PlayerStatus	Status = PlayerStatus::Initializing;
+			// read from any thread, along with the TOC once Ready
+			std::atomic<PlayerStatus>	Status{PlayerStatus::Initializing};
 
 			std::string		ErrorMessage;
 
 			TableOfContent	TOC;
 
-			std::thread*				Thread;
+			// at most one task is submitted at a time. Requests coming in while it runs have it submitted again.
+			std::shared_ptr<ITaskScheduler>	TaskScheduler;
 			std::mutex					ThreadEventMutex;
-			std::condition_variable		WakeUpBufferThreadEvent;
+			std::condition_variable		TaskCompletedEvent;
+			std::atomic<bool>			TaskSubmitted{false};
+			bool						WakeUpRequested = false;
 
 			std::mutex					WaitForFrameBufferedMutex;
 			std::condition_variable		WaitForFrameBufferedEvent;
-			bool						StopThreadExecution = false;
+			uint64						NumFrameBufferedEvents = 0;
+			std::atomic<bool>			StopThreadExecution{false};
 
-#if defined(KIMURA_UNREAL)
-			class IFileHandle*			UEFileHandle = nullptr;
-#elif defined(KIMURA_WINDOWS)
-			int							FileHandle = -1;
-#else
-			std::ifstream				InputFile;
+			// where the document is read from. Created from InputFilePath by the loader thread, unless provided at 
+			// construction.
+			std::shared_ptr<IByteSource>	Source;
+
+			// set when the source is directly addressable
+			const byte*						SourceData = nullptr;
+
+#if defined(KIMURA_IO_URING)
+			// when IOQueueDepth > 1 and the source exposes a file descriptor, frames are read through io_uring
+			std::unique_ptr<IOUring>	Ring;
 #endif
 
+			std::shared_ptr<BufferPool>				FrameBufferPool;
+
+			// set when sharing a memory budget with other players
+			std::shared_ptr<MemoryBudget>			SharedMemoryBudget;
+			std::shared_ptr<MemoryBudget::Client>	MemoryBudgetClient;
+
 			std::mutex								FrameAccessMutex;
 
 			uint64									FrameDataFilePosition = 0;
 
-			/* Frames located between FullyBufferedFramesStart and (FullyBufferedFramesStart + FullyBufferedFramesCount ) are fully loaded */
+			/* Frames located between FullyBufferedFramesStart and (FullyBufferedFramesStart + FullyBufferedFramesCount ) are fully loaded. 
+			   These are playback steps, Frames is indexed by step as well. Changed under FrameAccessMutex, the count and 
+			   PreBufferingSize can be read without it. */
 			uint32									FullyBufferedFramesStart = 0;
-			uint32									FullyBufferedFramesCount = 0;
+			std::atomic<uint32>						FullyBufferedFramesCount{0};
+			uint64									FullyBufferedBytes = 0;
 			std::vector<std::shared_ptr<Frame>>		Frames;
 
+			// number of frames to buffer ahead. Follows the requests when adaptive prebuffering is enabled.
+			std::atomic<uint32>						PreBufferingSize{0};
+			uint64									AverageFrameReadSize = 0;
+			double									FrameLoadTime = 0.0;			// running average, in seconds
+			double									FrameRequestRate = 0.0;			// frames per second
+			double									StallBoost = 1.0;
+			uint32									NumStepsRequested = 0;
+			uint32									NumFramesLoaded = 0;				// only touched by the player's task
+			uint32									LastStarvedStep = 0xffffffff;
+			std::chrono::steady_clock::time_point	RequestRateMeasureStart;
+			std::chrono::steady_clock::time_point	LastRequestTime;
+
+			/* Frames located between (FullyBufferedFramesStart - BackBufferedFramesCount) and FullyBufferedFramesStart were 
+			   already played and are kept for backward steps */
+			uint32									BackBufferedFramesCount = 0;
+			uint64									BackBufferedBytes = 0;
+
 			std::shared_ptr<Frame>					FirstFrame = nullptr;
 
+			// frames between reading and publishing, in the order they were read. Only decoded jobs are removed, from 
+			// the front, so that decode tasks can hold on to the others. One task at a time publishes.
+			std::deque<DecodeJob>					DecodeQueue;
+			std::atomic<uint32>						NumDecodeTasksRunning{0};
+			bool									bPublishingDecodedFrames = false;
+
+			// first frame of each range loaded by the bulk load tasks, which take them in order. Set once opened.
+			std::vector<uint32>						BulkLoadRanges;
+			std::atomic<uint32>						NextBulkLoadRange{0};
+			std::atomic<uint32>						NumBulkLoadTasksRunning{0};
+
+			// frames asked for through RequestFrame, oldest first. Those outside of the buffered window are loaded on 
+			// their own, the last one is kept by the loader as the predecessor of the next.
+			std::deque<FrameRequest>				PendingFrameRequests;
+			std::shared_ptr<Frame>					LastRequestedFrame = nullptr;
+
+			// Frame last returned by GetFrameAt from the buffered window, which stays at its start until the next 
+			// request moves it. Only the thread requesting frames touches these, asking for the same frame again 
+			// doesn't take any lock.
+			std::shared_ptr<Frame>					LastServedFrame = nullptr;
+			uint32									LastServedFrameIndex = 0;
+
+			// written by the loader without any lock held, read and reset by CollectStats once a second
+			struct LoaderCounters
+			{
+				std::atomic<uint64>		BytesRead{0};
+				std::atomic<uint64>		ReadTime{0};				// nanoseconds
+				std::atomic<uint64>		ProcessingTime{0};			// nanoseconds
+				std::atomic<uint32>		NumFramesProcessed{0};
+				std::atomic<uint64>		DecodeQueueDepthSum{0};
+				std::atomic<uint32>		NumFramesQueued{0};
+				std::atomic<uint64>		DecompressionTime{0};		// nanoseconds
+				std::atomic<uint64>		BytesCompressed{0};
+				std::atomic<uint64>		BytesDecompressed{0};
+
+				// of the whole mapping, as of the last time the loader queried it
+				std::atomic<uint64>		MappedResidentBytes{0};
+			};
+
+			LoaderCounters							Counters;
+			std::chrono::steady_clock::time_point	NextResidencyQuery;
+
+			// keyframes recently decoded to resolve seeks, most recent first. Bulk load tasks resolve seeks as well.
+			std::mutex								KeyframeCacheMutex;
+			std::list<std::shared_ptr<Frame>>		KeyframeCache;
+			uint64									KeyframeCacheBytes = 0;
+
+			// seek latency measurement
+			bool									SeekPending = false;
+			uint32									SeekStep = 0;
+			std::chrono::steady_clock::time_point	SeekStartTime;
+			double									TotalSeekLatency = 0.0;
+
+			// streams of constant meshes, loaded once when the player opens and shared by every frame. Indexed by mesh.
+			std::vector<FrameMesh>					ConstantMeshes;
+
+			// bases that positions are reconstructed from, loaded when the player opens. Indexed by mesh.
+			std::vector<MeshBasis>					MeshBases;
+
 
 			std::mutex								ProfilingMutex;
 
 			PlayerStats		Profiling;
 			PlayerStats		StoredProfiling;
 			std::chrono::time_point<std::chrono::high_resolution_clock>	NextStatsCollection;
+			std::chrono::time_point<std::chrono::high_resolution_clock>	LastStatsCollection;
+
+			std::chrono::steady_clock::time_point	CreationTime;
 
 
 
@@ -466,6 +1381,11 @@ namespace Kimura
 			{
 			}
 
+			inline uint64 Nanoseconds()
+			{
+				return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			}
+
 			inline double Duration()
 			{
 				std::chrono::duration<double> time_span = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - start);
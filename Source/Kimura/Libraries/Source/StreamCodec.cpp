@@ -0,0 +1,380 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "Player.h"
+
+#include <cmath>
+
+#if defined(KIMURA_SSE2)
+	#include <emmintrin.h>
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Kimura::DecodeLZ4
+//-----------------------------------------------------------------------------
+bool Kimura::DecodeLZ4(const byte* InData, uint64 InSize, byte* OutData, uint64 OutSize)
+{
+	// LZ4 block format: sequences of literals followed by a match, copied from the output decoded so far. The last
+	// sequence is made of literals only. Every length and offset is checked, corrupted data fails rather than
+	// overruns.
+	const byte* in = InData;
+	const byte* inEnd = InData + InSize;
+
+	byte* out = OutData;
+	byte* outEnd = OutData + OutSize;
+
+	// lengths of 15 and more continue in the following bytes
+	auto readLength = [&in, inEnd](uint64& InOutLength)
+	{
+		if (InOutLength != 15)
+		{
+			return true;
+		}
+
+		byte b = 255;
+		while (b == 255)
+		{
+			if (in >= inEnd)
+			{
+				return false;
+			}
+
+			b = *in++;
+			InOutLength += b;
+		}
+
+		return true;
+	};
+
+	while (in < inEnd)
+	{
+		const byte token = *in++;
+
+		// short sequences far enough from the ends are copied 16 bytes at a time. Bytes copied past the sequence are 
+		// overwritten by the following ones.
+		if (token < 0xf0 && (token & 15) < 15 && inEnd - in >= 18 && outEnd - out >= 34)
+		{
+			const uint64 numLiterals = token >> 4;
+			memcpy(out, in, 16);
+			in += numLiterals;
+			out += numLiterals;
+
+			const uint64 offset = (uint64)in[0] | ((uint64)in[1] << 8);
+			const uint64 matchLength = (token & 15) + 4;
+
+			if (offset >= 16 && offset <= (uint64)(out - OutData))
+			{
+				in += 2;
+
+				const byte* match = out - offset;
+				memcpy(out, match, 16);
+				memcpy(out + 16, match + 16, 2);
+				out += matchLength;
+
+				continue;
+			}
+
+			// short repeating patterns (ex: the zeroes of small residuals) overlap, a byte at a time
+			if (offset > 0 && offset <= (uint64)(out - OutData))
+			{
+				in += 2;
+
+				const byte* match = out - offset;
+				for (uint64 i = 0; i < matchLength; i++)
+				{
+					out[i] = match[i];
+				}
+				out += matchLength;
+
+				continue;
+			}
+
+			// invalid, handled below
+			in -= numLiterals;
+			out -= numLiterals;
+		}
+
+		uint64 numLiterals = token >> 4;
+		if (!readLength(numLiterals) || numLiterals > (uint64)(inEnd - in) || numLiterals > (uint64)(outEnd - out))
+		{
+			return false;
+		}
+
+		memcpy(out, in, (size_t)numLiterals);
+		in += numLiterals;
+		out += numLiterals;
+
+		if (in == inEnd)
+		{
+			break;
+		}
+
+		if (inEnd - in < 2)
+		{
+			return false;
+		}
+
+		const uint64 offset = (uint64)in[0] | ((uint64)in[1] << 8);
+		in += 2;
+
+		uint64 matchLength = token & 15;
+		if (!readLength(matchLength))
+		{
+			return false;
+		}
+		matchLength += 4;
+
+		if (offset == 0 || offset > (uint64)(out - OutData) || matchLength > (uint64)(outEnd - out))
+		{
+			return false;
+		}
+
+		// the match may overlap the bytes it produces (ex: runs), the distance covered by each copy doubles
+		const byte* match = out - offset;
+		while (matchLength > 0)
+		{
+			const uint64 size = std::min<uint64>(matchLength, (uint64)(out - match));
+			memcpy(out, match, (size_t)size);
+			out += size;
+			matchLength -= size;
+		}
+	}
+
+	return out == outEnd;
+}
+
+//-----------------------------------------------------------------------------
+// Kimura::ReconstructStream
+//-----------------------------------------------------------------------------
+template<typename T>
+static void ReconstructComponents(Kimura::StreamEncoding InEncoding, const Kimura::byte* InResiduals, const Kimura::byte* InPrevious, const Kimura::byte* InBeforePrevious, Kimura::byte* OutData, Kimura::uint64 InBegin, Kimura::uint64 InEnd)
+{
+	// unsigned arithmetic wraps around like the encoder's
+	for (Kimura::uint64 i = InBegin; i < InEnd; i += sizeof(T))
+	{
+		T residual, previous, prediction;
+		memcpy(&residual, &InResiduals[i], sizeof(T));
+		memcpy(&previous, &InPrevious[i], sizeof(T));
+
+		prediction = previous;
+		if (InEncoding == Kimura::StreamEncoding::Linear)
+		{
+			T beforePrevious;
+			memcpy(&beforePrevious, &InBeforePrevious[i], sizeof(T));
+			prediction = (T)(previous + previous - beforePrevious);
+		}
+
+		const T value = (T)(residual + prediction);
+		memcpy(&OutData[i], &value, sizeof(T));
+	}
+}
+
+void Kimura::ReconstructStream(StreamEncoding InEncoding, uint32 InComponentSize, const byte* InResiduals, const byte* InPrevious, const byte* InBeforePrevious, byte* OutData, uint64 InSize)
+{
+	uint64 i = 0;
+
+#if defined(KIMURA_SSE2)
+
+	// 16 bytes at a time, the tail is handled below
+	const uint64 numVectorBytes = InSize & ~(uint64)15;
+
+	auto add = [InComponentSize](__m128i InA, __m128i InB)
+	{
+		return InComponentSize == 4 ? _mm_add_epi32(InA, InB) : InComponentSize == 2 ? _mm_add_epi16(InA, InB) : _mm_add_epi8(InA, InB);
+	};
+
+	auto sub = [InComponentSize](__m128i InA, __m128i InB)
+	{
+		return InComponentSize == 4 ? _mm_sub_epi32(InA, InB) : InComponentSize == 2 ? _mm_sub_epi16(InA, InB) : _mm_sub_epi8(InA, InB);
+	};
+
+	if (InEncoding == StreamEncoding::Linear)
+	{
+		for (; i < numVectorBytes; i += 16)
+		{
+			const __m128i residual = _mm_loadu_si128((const __m128i*)&InResiduals[i]);
+			const __m128i previous = _mm_loadu_si128((const __m128i*)&InPrevious[i]);
+			const __m128i beforePrevious = _mm_loadu_si128((const __m128i*)&InBeforePrevious[i]);
+
+			const __m128i prediction = sub(add(previous, previous), beforePrevious);
+			_mm_storeu_si128((__m128i*)&OutData[i], add(residual, prediction));
+		}
+	}
+	else
+	{
+		for (; i < numVectorBytes; i += 16)
+		{
+			const __m128i residual = _mm_loadu_si128((const __m128i*)&InResiduals[i]);
+			const __m128i previous = _mm_loadu_si128((const __m128i*)&InPrevious[i]);
+
+			_mm_storeu_si128((__m128i*)&OutData[i], add(residual, previous));
+		}
+	}
+
+#endif
+
+	switch (InComponentSize)
+	{
+		case 4:		ReconstructComponents<uint32>(InEncoding, InResiduals, InPrevious, InBeforePrevious, OutData, i, InSize); break;
+		case 2:		ReconstructComponents<uint16>(InEncoding, InResiduals, InPrevious, InBeforePrevious, OutData, i, InSize); break;
+		default:	ReconstructComponents<uint8>(InEncoding, InResiduals, InPrevious, InBeforePrevious, OutData, i, InSize); break;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::ApplySparseStream
+//-----------------------------------------------------------------------------
+bool Kimura::ApplySparseStream(const byte* InChanges, uint64 InChangesSize, const byte* InPrevious, byte* OutData, uint64 InSize, uint64 InElementSize)
+{
+	if (InChangesSize < 4 || InElementSize == 0)
+	{
+		return false;
+	}
+
+	uint32 numRuns = 0;
+	memcpy(&numRuns, InChanges, 4);
+
+	if ((uint64)numRuns * 8 > InChangesSize - 4)
+	{
+		return false;
+	}
+
+	const byte* runs = InChanges + 4;
+	const byte* values = runs + (uint64)numRuns * 8;
+	const byte* valuesEnd = InChanges + InChangesSize;
+
+	// runs are in order, what lies between them is copied from the previous frame in one go
+	uint64 position = 0;
+	for (uint32 iRun = 0; iRun < numRuns; iRun++)
+	{
+		uint32 run[2];
+		memcpy(run, &runs[iRun * 8], 8);
+
+		const uint64 start = (uint64)run[0] * InElementSize;
+		const uint64 size = (uint64)run[1] * InElementSize;
+
+		if (start < position || start + size > InSize || size > (uint64)(valuesEnd - values))
+		{
+			return false;
+		}
+
+		memcpy(&OutData[position], &InPrevious[position], (size_t)(start - position));
+		memcpy(&OutData[start], values, (size_t)size);
+
+		values += size;
+		position = start + size;
+	}
+
+	memcpy(&OutData[position], &InPrevious[position], (size_t)(InSize - position));
+
+	return values == valuesEnd;
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::ReconstructFromBasis
+//-----------------------------------------------------------------------------
+void Kimura::ReconstructFromBasis(const MeshBasis& InBasis, const byte* InCoefficients, uint64 InFirstVertex, uint64 InNumVertices, PositionFormat InFormat, const Vector3& InCenter, const Vector3& InExtents, byte* OutData)
+{
+	// coefficients are stored unaligned in the frame's buffer
+	std::vector<float> coefficients(InBasis.NumVectors);
+	if (InBasis.NumVectors > 0)
+	{
+		memcpy(coefficients.data(), InCoefficients, InBasis.NumVectors * sizeof(float));
+	}
+
+	// positions are accumulated a block at a time, which stays in cache while each vector is added to it. Blocks hold 
+	// whole positions, their components always start with X.
+	const uint64 blockSize = 3 * 512;
+	float block[blockSize];
+
+	// components of quantized positions (PositionFormat::Half) are mapped from the frame's extents to [-32767, 32767]
+	const float center[3] = { InCenter.X, InCenter.Y, InCenter.Z };
+	const float scale[3] =
+	{
+		InExtents.X != 0.0f ? 32767.0f / InExtents.X : 0.0f,
+		InExtents.Y != 0.0f ? 32767.0f / InExtents.Y : 0.0f,
+		InExtents.Z != 0.0f ? 32767.0f / InExtents.Z : 0.0f
+	};
+
+	const uint64 begin = InFirstVertex * 3;
+	const uint64 end = begin + InNumVertices * 3;
+
+	for (uint64 blockBegin = begin; blockBegin < end; blockBegin += blockSize)
+	{
+		const uint64 size = std::min(blockSize, end - blockBegin);
+
+		memcpy(block, &InBasis.Data[blockBegin], (size_t)size * sizeof(float));
+
+		for (uint32 iVector = 0; iVector < InBasis.NumVectors; iVector++)
+		{
+			const float* vector = &InBasis.Data[(iVector + 1) * InBasis.NumFloats + blockBegin];
+			const float coefficient = coefficients[iVector];
+
+			uint64 i = 0;
+
+#if defined(KIMURA_SSE2)
+
+			const __m128 c = _mm_set1_ps(coefficient);
+			for (; i + 4 <= size; i += 4)
+			{
+				_mm_storeu_ps(&block[i], _mm_add_ps(_mm_loadu_ps(&block[i]), _mm_mul_ps(c, _mm_loadu_ps(&vector[i]))));
+			}
+
+#endif
+
+			for (; i < size; i++)
+			{
+				block[i] += coefficient * vector[i];
+			}
+		}
+
+		if (InFormat == PositionFormat::Full)
+		{
+			memcpy(&OutData[(blockBegin - begin) * sizeof(float)], block, (size_t)size * sizeof(float));
+			continue;
+		}
+
+		int16* quantized = (int16*)&OutData[(blockBegin - begin) * sizeof(int16)];
+		uint64 i = 0;
+
+#if defined(KIMURA_SSE2)
+
+		// 4 positions at a time, their 12 components span 3 registers, each starting with another component
+		const __m128 centers[3] = { _mm_setr_ps(center[0], center[1], center[2], center[0]), _mm_setr_ps(center[1], center[2], center[0], center[1]), _mm_setr_ps(center[2], center[0], center[1], center[2]) };
+		const __m128 scales[3] = { _mm_setr_ps(scale[0], scale[1], scale[2], scale[0]), _mm_setr_ps(scale[1], scale[2], scale[0], scale[1]), _mm_setr_ps(scale[2], scale[0], scale[1], scale[2]) };
+		const __m128 minimum = _mm_set1_ps(-32767.0f);
+		const __m128 maximum = _mm_set1_ps(32767.0f);
+
+		auto quantize = [&](uint64 InIndex, uint32 InRegister)
+		{
+			const __m128 value = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&block[InIndex]), centers[InRegister]), scales[InRegister]);
+			return _mm_cvtps_epi32(_mm_max_ps(minimum, _mm_min_ps(maximum, value)));
+		};
+
+		for (; i + 12 <= size; i += 12)
+		{
+			const __m128i a = quantize(i, 0);
+			const __m128i b = quantize(i + 4, 1);
+			const __m128i c = quantize(i + 8, 2);
+
+			_mm_storeu_si128((__m128i*)&quantized[i], _mm_packs_epi32(a, b));
+			_mm_storel_epi64((__m128i*)&quantized[i + 8], _mm_packs_epi32(c, c));
+		}
+
+#endif
+
+		// rounded to nearest like the conversion above
+		for (; i < size; i++)
+		{
+			const float value = std::nearbyint((block[i] - center[i % 3]) * scale[i % 3]);
+			quantized[i] = (int16)std::max(-32767.0f, std::min(32767.0f, value));
+		}
+	}
+}
@@ -0,0 +1,200 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "Player.h"
+
+
+namespace
+{
+	// the pool and index of the worker running on the current thread, if any
+	thread_local const Kimura::ThreadPool*	CurrentThreadPool = nullptr;
+	thread_local Kimura::uint32				CurrentWorkerIndex = 0;
+
+	std::mutex								DefaultTaskSchedulerMutex;
+	std::shared_ptr<Kimura::ITaskScheduler>	DefaultTaskScheduler;
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::CreateThreadPool
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::ITaskScheduler> Kimura::CreateThreadPool(uint32 InNumThreads)
+{
+	return std::make_shared<ThreadPool>(InNumThreads);
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::SetDefaultTaskScheduler
+//-----------------------------------------------------------------------------
+void Kimura::SetDefaultTaskScheduler(std::shared_ptr<ITaskScheduler> InScheduler)
+{
+	std::unique_lock<std::mutex> lock(DefaultTaskSchedulerMutex);
+	DefaultTaskScheduler = InScheduler;
+}
+
+
+//-----------------------------------------------------------------------------
+// Kimura::GetDefaultTaskScheduler
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::ITaskScheduler> Kimura::GetDefaultTaskScheduler()
+{
+	std::unique_lock<std::mutex> lock(DefaultTaskSchedulerMutex);
+
+	// created on first use
+	if (DefaultTaskScheduler == nullptr)
+	{
+		DefaultTaskScheduler = std::make_shared<ThreadPool>(0);
+	}
+
+	return DefaultTaskScheduler;
+}
+
+
+//-----------------------------------------------------------------------------
+// ThreadPool::ThreadPool
+//-----------------------------------------------------------------------------
+Kimura::ThreadPool::ThreadPool(uint32 InNumThreads)
+{
+	uint32 numThreads = InNumThreads;
+	if (numThreads == 0)
+	{
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// all the workers exist before any of them starts looking for tasks
+	for (uint32 i = 0; i < numThreads; i++)
+	{
+		this->Workers.emplace_back(new Worker());
+	}
+
+	for (uint32 i = 0; i < numThreads; i++)
+	{
+		this->Workers[i]->Thread = std::thread([this, i]() { this->WorkerExecute(i); });
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// ThreadPool::~ThreadPool
+//-----------------------------------------------------------------------------
+Kimura::ThreadPool::~ThreadPool()
+{
+	// tasks already submitted still run
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+		this->Stopping = true;
+	}
+	this->TaskSubmittedEvent.notify_all();
+
+	for (std::unique_ptr<Worker>& worker : this->Workers)
+	{
+		worker->Thread.join();
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// ThreadPool::Submit
+//-----------------------------------------------------------------------------
+void Kimura::ThreadPool::Submit(std::function<void()> InTask)
+{
+	// tasks submitted by a worker stay with it, others are spread around
+	uint32 iWorker = 0;
+	if (CurrentThreadPool == this)
+	{
+		iWorker = CurrentWorkerIndex;
+	}
+	else
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+		iWorker = this->NextWorker;
+		this->NextWorker = (this->NextWorker + 1) % (uint32)this->Workers.size();
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(this->Workers[iWorker]->Mutex);
+		this->Workers[iWorker]->Tasks.push_back(std::move(InTask));
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(this->Mutex);
+		this->NumTasksQueued++;
+	}
+	this->TaskSubmittedEvent.notify_one();
+}
+
+
+//-----------------------------------------------------------------------------
+// ThreadPool::WorkerExecute
+//-----------------------------------------------------------------------------
+void Kimura::ThreadPool::WorkerExecute(uint32 InWorkerIndex)
+{
+	CurrentThreadPool = this;
+	CurrentWorkerIndex = InWorkerIndex;
+
+	while (true)
+	{
+		// claim one of the queued tasks, wherever it is
+		{
+			std::unique_lock<std::mutex> lock(this->Mutex);
+			this->TaskSubmittedEvent.wait(lock, [this]() { return this->NumTasksQueued > 0 || this->Stopping; });
+
+			if (this->NumTasksQueued == 0)
+			{
+				break;
+			}
+
+			this->NumTasksQueued--;
+		}
+
+		std::function<void()> task;
+		this->TakeTask(InWorkerIndex, task);
+
+		task();
+	}
+
+	CurrentThreadPool = nullptr;
+}
+
+
+//-----------------------------------------------------------------------------
+// ThreadPool::TakeTask
+//-----------------------------------------------------------------------------
+void Kimura::ThreadPool::TakeTask(uint32 InWorkerIndex, std::function<void()>& OutTask)
+{
+	// a task is queued before it's counted, so the one claimed is bound to be found
+	const uint32 numWorkers = (uint32)this->Workers.size();
+
+	while (true)
+	{
+		{
+			Worker& worker = *this->Workers[InWorkerIndex];
+			std::unique_lock<std::mutex> lock(worker.Mutex);
+			if (!worker.Tasks.empty())
+			{
+				OutTask = std::move(worker.Tasks.front());
+				worker.Tasks.pop_front();
+				return;
+			}
+		}
+
+		for (uint32 i = 1; i < numWorkers; i++)
+		{
+			Worker& victim = *this->Workers[(InWorkerIndex + i) % numWorkers];
+			std::unique_lock<std::mutex> lock(victim.Mutex);
+			if (!victim.Tasks.empty())
+			{
+				OutTask = std::move(victim.Tasks.back());
+				victim.Tasks.pop_back();
+				return;
+			}
+		}
+
+		std::this_thread::yield();
+	}
+}
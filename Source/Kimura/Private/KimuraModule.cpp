@@ -8,11 +8,58 @@
 #include "KimuraModule.h"
 #include "Interfaces/IPluginManager.h"
 #include "ShaderCore.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Async/Async.h"
+#include "Kimura.h"
 
 #define LOCTEXT_NAMESPACE "FKimuraModule"
 
 DEFINE_LOG_CATEGORY(KimuraLog)
 
+static TAutoConsoleVariable<int32> CVarKimuraMemoryBudgetMB(
+	TEXT("Kimura.MemoryBudgetMB"),
+	0,
+	TEXT("Memory shared by the frames buffered by all of the Kimura players, in megabytes. 0 means no limit."),
+	FConsoleVariableDelegate::CreateLambda([](IConsoleVariable* InVariable)
+	{
+		Kimura::GetProcessMemoryBudget()->SetBudget((Kimura::uint64)FMath::Max(InVariable->GetInt(), 0) * 1024ull * 1024ull);
+	}));
+
+// runs the work of the players on the engine's thread pool, rather than on threads of their own. Reading frames 
+// blocks on I/O, which would hold on to GThreadPool's workers, so those tasks get a pool of their own.
+class FKimuraTaskScheduler : public Kimura::ITaskScheduler
+{
+public:
+
+	FKimuraTaskScheduler()
+	{
+		IOThreadPool = FQueuedThreadPool::Allocate();
+		verify(IOThreadPool->Create(FMath::Max(FPlatformMisc::NumberOfIOWorkerThreadsToSpawn(), 2), 128 * 1024, TPri_Normal, TEXT("KimuraIOThreadPool")));
+	}
+
+	virtual ~FKimuraTaskScheduler()
+	{
+		IOThreadPool->Destroy();
+		delete IOThreadPool;
+	}
+
+	virtual void Submit(std::function<void()> InTask) override
+	{
+		AsyncPool(*IOThreadPool, [Task = MoveTemp(InTask)]() { Task(); });
+	}
+
+	virtual void SubmitCompute(std::function<void()> InTask) override
+	{
+		Async(EAsyncExecution::ThreadPool, [Task = MoveTemp(InTask)]() { Task(); });
+	}
+
+private:
+
+	FQueuedThreadPool* IOThreadPool = nullptr;
+};
+
 void FKimuraModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
@@ -20,12 +67,27 @@ void FKimuraModule::StartupModule()
 	FString PluginShaderDir = FPaths::Combine(IPluginManager::Get().FindPlugin(TEXT("Kimura"))->GetBaseDir(), TEXT("Shaders"));
 	AddShaderSourceDirectoryMapping(TEXT("/Plugin/Kimura"), PluginShaderDir);
 
+	if (GThreadPool != nullptr)
+	{
+		Kimura::SetDefaultTaskScheduler(std::make_shared<FKimuraTaskScheduler>());
+	}
+
+	// give back every frame that isn't needed right away when the platform runs low on memory
+	MemoryTrimHandle = FCoreDelegates::GetMemoryTrimDelegate().AddLambda([]()
+	{
+		Kimura::GetProcessMemoryBudget()->Trim(~0ull);
+	});
+
 }
 
 void FKimuraModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+	FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimHandle);
+
+	Kimura::SetDefaultTaskScheduler(nullptr);
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -154,13 +154,21 @@ void AKimuraPlayer::Tick(float DeltaTime)
 		desiredFrameIndex = 0;
 	}
 
+	// with PlaybackTime, the position counts frames played in the playback direction. Ping pong plays every frame but 
+	// the first and last one twice.
+	uint32 numPlaybackSteps = this->FrameCount;
+	if (this->FrameControl == EKimuraPlayerFrameControl::PlaybackTime && this->PlaybackDirection == EKimuraPlaybackDirection::PingPong && this->FrameCount > 1)
+	{
+		numPlaybackSteps = this->Loop ? this->FrameCount * 2 - 2 : this->FrameCount * 2 - 1;
+	}
+
 	if (this->Loop)
 	{
-		desiredFrameIndex %= this->FrameCount;
+		desiredFrameIndex %= numPlaybackSteps;
 	}
 	else
 	{
-		if (this->DestroyOnCompletion && (uint32) desiredFrameIndex >= this->FrameCount)
+		if (this->DestroyOnCompletion && (uint32) desiredFrameIndex >= numPlaybackSteps)
 		{
 			UE_LOG(KimuraLog, Log, TEXT("%s: Kimura player auto-destroyed on completion"), *this->GetName());
 
@@ -169,6 +177,17 @@ void AKimuraPlayer::Tick(float DeltaTime)
 		}
 	}
 
+	if (this->FrameControl == EKimuraPlayerFrameControl::PlaybackTime && (uint32)desiredFrameIndex < numPlaybackSteps)
+	{
+		switch (this->PlaybackDirection)
+		{
+			case EKimuraPlaybackDirection::Reverse:		desiredFrameIndex = this->FrameCount - 1 - desiredFrameIndex; break;
+			case EKimuraPlaybackDirection::PingPong:	desiredFrameIndex = (uint32)desiredFrameIndex < this->FrameCount ? desiredFrameIndex : this->FrameCount * 2 - 2 - desiredFrameIndex; break;
+			case EKimuraPlaybackDirection::Forward:
+			default:									break;
+		}
+	}
+
 	this->NumFramesBuffered = this->KimuraPlayer->GetBufferedFrameCount();
 
 	bool bForceFrame = false;
@@ -429,8 +448,20 @@ bool AKimuraPlayer::TickKimuraPlayerSetup()
 
 			Kimura::PlayerOptions options;
 			options.PreBufferingSize = this->FramesToBuffer;
+			options.AdaptivePreBuffering = this->AdaptiveBuffering;
 			options.BufferEntirePlayback = this->BufferEntirePlayback;
 			options.Loop = this->Loop;
+			options.MemoryBudget = Kimura::GetProcessMemoryBudget();
+			options.MemoryBudgetPriority = this->MemoryBudgetPriority;
+			options.PlaybackSpeed = FMath::Abs(this->PlaybackTimeSpeed);
+
+			switch (this->PlaybackDirection)
+			{
+				case EKimuraPlaybackDirection::Reverse:		options.Direction = Kimura::PlaybackDirection::Reverse; break;
+				case EKimuraPlaybackDirection::PingPong:	options.Direction = Kimura::PlaybackDirection::PingPong; break;
+				case EKimuraPlaybackDirection::Forward:
+				default:									options.Direction = Kimura::PlaybackDirection::Forward; break;
+			}
 			this->KimuraPlayer = Kimura::CreatePlayer(s, options);
 
 			UE_LOG(KimuraLog, Log, TEXT("%s: Kimura player created"), *this->GetName());
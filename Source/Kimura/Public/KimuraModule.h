@@ -35,5 +35,9 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+
+	FDelegateHandle MemoryTrimHandle;
 };
 
@@ -158,6 +158,15 @@ struct FKimuraImageSequenceInstance
 };
 
 
+UENUM(BlueprintType)
+enum class EKimuraPlaybackDirection : uint8
+{
+	Forward,
+	Reverse,
+	PingPong
+};
+
+
 UENUM(BlueprintType)
 enum class EKimuraPlayerFrameControl : uint8
 {
@@ -232,6 +241,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Kimura")
 	bool						Loop = true;
 
+	/* Order in which frames are played when FrameControl is set to PlaybackTime. Frames are buffered ahead in that order, whatever the FrameControl. */
+	UPROPERTY(EditAnywhere, Category = "Kimura")
+	EKimuraPlaybackDirection	PlaybackDirection = EKimuraPlaybackDirection::Forward;
+
 	/* Destroy the actor when the player is done playing. Looping must be disabled before this can be set. */
 	UPROPERTY(EditAnywhere, Category = "Kimura", meta = (EditCondition = "!Loop"))
 	bool						DestroyOnCompletion = false;
@@ -244,6 +257,14 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Kimura", meta = (EditCondition = "!BufferEntirePlayback", ClampMin = "1", UIMin = "1"))
 	int32						FramesToBuffer = 30;
 
+	/* When TRUE, the number of frames loaded ahead starts at FramesToBuffer and then follows the playback rate and the time it takes to load frames. */
+	UPROPERTY(EditAnywhere, Category = "Kimura", meta = (EditCondition = "!BufferEntirePlayback"))
+	bool						AdaptiveBuffering = false;
+
+	/* Players share the memory budget set by Kimura.MemoryBudgetMB. When it runs short, players of lower priority give up their frames first. */
+	UPROPERTY(EditAnywhere, Category = "Kimura", meta = (EditCondition = "!BufferEntirePlayback"))
+	int32						MemoryBudgetPriority = 0;
+
 	/* The player will always try to keep this number of frames loaded ahead of the current playback position. */
 	UPROPERTY(EditAnywhere, Category = "Kimura")
 	EKimuraPlayerFrameControl	FrameControl = EKimuraPlayerFrameControl::PlaybackTime;
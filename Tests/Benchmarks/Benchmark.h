@@ -0,0 +1,90 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace Kimura
+{
+	namespace Tests
+	{
+		// shortest time, in seconds, of InNumRuns runs of InFunction
+		template<typename F>
+		double MeasureBest(int InNumRuns, F InFunction)
+		{
+			double best = 1e30;
+
+			for (int iRun = 0; iRun < InNumRuns; iRun++)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				InFunction();
+				best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+			}
+
+			return best;
+		}
+
+		// true when the benchmark was asked for on the command line, or when none was
+		inline bool IsSelected(int InArgc, char** InArgv, const char* InName)
+		{
+			bool bAnySelected = false;
+
+			for (int i = 1; i < InArgc; i++)
+			{
+				if (atof(InArgv[i]) > 0.0)
+				{
+					continue;
+				}
+
+				bAnySelected = true;
+				if (strcmp(InArgv[i], InName) == 0)
+				{
+					return true;
+				}
+			}
+
+			return !bAnySelected;
+		}
+
+		// Triangles of a grid of InWidth by InHeight vertices, renumbered in order of first use like an exporter
+		// optimizing for the vertex cache would. OutOrder is the grid vertex of each vertex.
+		inline std::vector<uint32_t> GetGridIndices(uint32_t InWidth, uint32_t InHeight, std::vector<uint32_t>& OutOrder)
+		{
+			std::vector<uint32_t> indices;
+			for (uint32_t y = 0; y + 1 < InHeight; y++)
+			{
+				for (uint32_t x = 0; x + 1 < InWidth; x++)
+				{
+					const uint32_t a = y * InWidth + x;
+					indices.insert(indices.end(), { a, a + InWidth, a + 1, a + 1, a + InWidth, a + InWidth + 1 });
+				}
+			}
+
+			std::vector<uint32_t> remap(InWidth * InHeight, ~0u);
+			OutOrder.clear();
+
+			for (uint32_t& index : indices)
+			{
+				if (remap[index] == ~0u)
+				{
+					remap[index] = (uint32_t)OutOrder.size();
+					OutOrder.push_back(index);
+				}
+
+				index = remap[index];
+			}
+
+			return indices;
+		}
+	}
+}
@@ -0,0 +1,328 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+// Time taken to play documents through, from a source whose reads are throttled to a given rate (GB/s, 0.3 by
+// default). Each document has 120 frames of 3 meshes of 60000 vertices.
+//
+//	PlaybackBenchmark [GB/s] [compressed] [predicted] [sparse] [basis] [meshcodec] [repeated]
+//
+
+#include "Benchmark.h"
+#include "TestDocument.h"
+
+#include <cmath>
+#include <thread>
+
+using namespace Kimura;
+using namespace Kimura::Tests;
+
+namespace
+{
+	std::shared_ptr<ITaskScheduler> TaskScheduler;
+	double BytesPerSecond = 0.3e9;
+
+	// best time of 3 to play every frame in order
+	double Play(const DocumentDesc& InDesc, const std::vector<byte>& InDocument, PlayerOptions InOptions)
+	{
+		InOptions.TaskScheduler = TaskScheduler;
+		InOptions.PreBufferingSize = 20;
+
+		bool bFailed = false;
+		const double duration = MeasureBest(3, [&]()
+		{
+			std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<ThrottledByteSource>(InDocument, BytesPerSecond), InOptions);
+
+			for (uint32 iFrame = 0; iFrame < InDesc.NumFrames; iFrame++)
+			{
+				// a single frame is checked, the benchmark is about the time taken to get them
+				std::shared_ptr<IFrame> frame = player->GetFrameAt(iFrame, true);
+				if (frame == nullptr || (iFrame == InDesc.NumFrames / 2 && !CheckFrame(InDesc, frame, iFrame)))
+				{
+					bFailed = true;
+					return;
+				}
+			}
+		});
+
+		return bFailed ? -1.0 : duration;
+	}
+
+	void Report(const char* InName, const DocumentDesc& InDesc, const std::vector<byte>& InDocument, double InDuration)
+	{
+		if (InDuration < 0.0)
+		{
+			printf("%-36s FAILED\n", InName);
+			return;
+		}
+
+		printf("%-36s %7.1f MB  %.3fs (%.1f fps)\n", InName, InDocument.size() / 1e6, InDuration, InDesc.NumFrames / InDuration);
+	}
+
+	DocumentDesc GetDesc()
+	{
+		DocumentDesc desc;
+		desc.NumFrames = 120;
+		desc.NumVertices = 60000;
+		desc.NumMeshes = 3;
+		return desc;
+	}
+
+	// raw and LZ4 streams, decompressed by one or several tasks
+	void BenchmarkCompressed()
+	{
+		for (StreamCodec codec : { StreamCodec::None, StreamCodec::LZ4 })
+		{
+			DocumentDesc desc = GetDesc();
+			desc.IndicesInterval = 10;
+			desc.VariedPositions = true;
+			desc.Codec = codec;
+
+			const std::vector<byte> document = WriteDocument(desc);
+
+			for (uint32 numTasks : { 1u, 4u })
+			{
+				if (codec == StreamCodec::None && numTasks > 1)
+				{
+					continue;
+				}
+
+				PlayerOptions options;
+				options.NumDecompressionTasks = numTasks;
+
+				const std::string name = std::string(codec == StreamCodec::LZ4 ? "lz4" : "raw") + ", " + std::to_string(numTasks) + " decompression tasks";
+				Report(name.c_str(), desc, document, Play(desc, document, options));
+			}
+		}
+	}
+
+	// smoothly animated surface: each vertex oscillates around its rest position, quantized like a typical exporter
+	float GetSmoothPosition(uint32 InFrame, uint32 InMesh, uint32 InComponent)
+	{
+		const float rest = (float)((InComponent * 2654435761u) >> 20) * 0.001f;
+		const float value = rest + 0.5f * sinf(InFrame * 0.05f + (InComponent / 3) * 0.01f);
+		return roundf(value * 4096.0f) / 4096.0f + InMesh;
+	}
+
+	// positions stored as they are or predicted from the previous frames, keyframes every 30 frames
+	void BenchmarkPredicted()
+	{
+		struct Case
+		{
+			const char*			Name;
+			StreamCodec			Codec;
+			StreamEncoding		Encoding;
+		};
+
+		const Case cases[] =
+		{
+			{ "raw", StreamCodec::None, StreamEncoding::Raw },
+			{ "lz4", StreamCodec::LZ4, StreamEncoding::Raw },
+			{ "delta+lz4", StreamCodec::LZ4, StreamEncoding::Delta },
+			{ "linear+lz4", StreamCodec::LZ4, StreamEncoding::Linear }
+		};
+
+		for (const Case& benchmarkCase : cases)
+		{
+			DocumentDesc desc = GetDesc();
+			desc.IndicesInterval = 1000;
+			desc.Codec = benchmarkCase.Codec;
+			desc.PositionEncoding = benchmarkCase.Encoding;
+			desc.KeyframeInterval = 30;
+			desc.PositionValue = GetSmoothPosition;
+
+			const std::vector<byte> document = WriteDocument(desc);
+
+			PlayerOptions options;
+			options.NumDecodeTasks = 2;
+
+			Report(benchmarkCase.Name, desc, document, Play(desc, document, options));
+		}
+	}
+
+	// a static body with an animated region, like cloth: 10% of the vertices move every frame
+	float GetPartiallyAnimatedPosition(uint32 InFrame, uint32, uint32 InComponent)
+	{
+		return InComponent / 3 < 6000 ? InFrame * 0.01f + InComponent : (float)InComponent;
+	}
+
+	// positions stored whole or as sparse changes, keyframes every 30 frames
+	void BenchmarkSparse()
+	{
+		struct Case
+		{
+			const char*			Name;
+			StreamCodec			Codec;
+			StreamEncoding		Encoding;
+		};
+
+		const Case cases[] =
+		{
+			{ "raw", StreamCodec::None, StreamEncoding::Raw },
+			{ "lz4", StreamCodec::LZ4, StreamEncoding::Raw },
+			{ "sparse", StreamCodec::None, StreamEncoding::Sparse },
+			{ "sparse+lz4", StreamCodec::LZ4, StreamEncoding::Sparse }
+		};
+
+		for (const Case& benchmarkCase : cases)
+		{
+			DocumentDesc desc = GetDesc();
+			desc.IndicesInterval = 1000;
+			desc.Codec = benchmarkCase.Codec;
+			desc.PositionEncoding = benchmarkCase.Encoding;
+			desc.KeyframeInterval = 30;
+			desc.PositionValue = GetPartiallyAnimatedPosition;
+
+			const std::vector<byte> document = WriteDocument(desc);
+			Report(benchmarkCase.Name, desc, document, Play(desc, document, PlayerOptions()));
+		}
+	}
+
+	// positions stored raw, or reconstructed from a basis of 16 vectors by one or several tasks
+	void BenchmarkBasis()
+	{
+		for (StreamEncoding encoding : { StreamEncoding::Raw, StreamEncoding::Basis })
+		{
+			for (PositionFormat format : { PositionFormat::Full, PositionFormat::Half })
+			{
+				if (encoding == StreamEncoding::Raw && format == PositionFormat::Half)
+				{
+					continue;
+				}
+
+				DocumentDesc desc = GetDesc();
+				desc.IndicesInterval = 1000;
+				desc.PositionEncoding = encoding;
+				desc.NumBasisVectors = 16;
+				desc.BasisPositionFormat = format;
+
+				const std::vector<byte> document = WriteDocument(desc);
+
+				for (uint32 numTasks : { 1u, 4u })
+				{
+					PlayerOptions options;
+					options.NumDecompressionTasks = numTasks;
+
+					const std::string name = std::string(encoding == StreamEncoding::Raw ? "raw" : format == PositionFormat::Full ? "basis, full" : "basis, half") + ", " + std::to_string(numTasks) + " decompression tasks";
+					Report(name.c_str(), desc, document, Play(desc, document, options));
+				}
+			}
+		}
+	}
+
+	// a wave over a 250 by 240 grid, its indices and positions stored in every frame, raw or with the mesh codecs
+	void BenchmarkMeshCodec()
+	{
+		std::vector<uint32> order;
+		const std::vector<uint32> indices = GetGridIndices(250, 240, order);
+
+		for (bool bEncoded : { false, true })
+		{
+			DocumentDesc desc = GetDesc();
+			desc.IndicesInterval = 1;
+			desc.Indices = indices;
+			desc.IndexEncoding = bEncoded ? StreamEncoding::Triangles : StreamEncoding::Raw;
+			desc.PositionEncoding = bEncoded ? StreamEncoding::BytePlanes : StreamEncoding::Raw;
+			desc.PositionValue = [order](uint32 InFrame, uint32, uint32 InComponent)
+			{
+				const float x = (order[InComponent / 3] % 250) * 0.1f;
+				const float y = (order[InComponent / 3] / 250) * 0.1f;
+				const float position[3] = { x, y, 0.5f * sinf(x * 1.5f + InFrame * 0.2f) * cosf(y + InFrame * 0.1f) };
+				return position[InComponent % 3];
+			};
+
+			const std::vector<byte> document = WriteDocument(desc);
+			Report(bEncoded ? "triangles+byte planes" : "raw", desc, document, Play(desc, document, PlayerOptions()));
+		}
+	}
+
+	// time taken by GetFrameAt to return a frame that's already buffered, as games ask for the same frame on every tick
+	// until the next one is due
+	void BenchmarkRepeatedRequests()
+	{
+		DocumentDesc desc;
+		desc.NumFrames = 200;
+		desc.NumVertices = 2000;
+		desc.IndicesInterval = 30;
+
+		PlayerOptions options;
+		options.TaskScheduler = TaskScheduler;
+		options.PreBufferingSize = 20;
+
+		std::shared_ptr<IPlayer> player = OpenDocument(CreateMemoryByteSource(WriteDocument(desc)), options);
+		if (player->GetFrameAt(0, true) == nullptr)
+		{
+			printf("repeated requests: FAILED\n");
+			return;
+		}
+
+		// lets the player buffer ahead, so that the requests don't race with loads
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+		const uint32 numRequests = 2000000;
+		uint32 numFrames = 0;
+
+		const double duration = MeasureBest(3, [&]()
+		{
+			for (uint32 i = 0; i < numRequests; i++)
+			{
+				numFrames += player->GetFrameAt(0, true) != nullptr ? 1 : 0;
+			}
+		});
+
+		printf("repeated requests: %.1f ns per GetFrameAt%s\n", duration * 1e9 / numRequests, numFrames == 3 * numRequests ? "" : ", FAILED");
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// main
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (atof(argv[i]) > 0.0)
+		{
+			BytesPerSecond = atof(argv[i]) * 1e9;
+		}
+	}
+
+	TaskScheduler = CreateThreadPool(4);
+
+	printf("reads at %.2f GB/s, %u hardware threads\n", BytesPerSecond / 1e9, std::thread::hardware_concurrency());
+
+	if (IsSelected(argc, argv, "compressed"))
+	{
+		BenchmarkCompressed();
+	}
+
+	if (IsSelected(argc, argv, "predicted"))
+	{
+		BenchmarkPredicted();
+	}
+
+	if (IsSelected(argc, argv, "sparse"))
+	{
+		BenchmarkSparse();
+	}
+
+	if (IsSelected(argc, argv, "basis"))
+	{
+		BenchmarkBasis();
+	}
+
+	if (IsSelected(argc, argv, "meshcodec"))
+	{
+		BenchmarkMeshCodec();
+	}
+
+	if (IsSelected(argc, argv, "repeated"))
+	{
+		BenchmarkRepeatedRequests();
+	}
+
+	return 0;
+}
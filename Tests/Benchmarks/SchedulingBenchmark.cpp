@@ -0,0 +1,118 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+// Frames a player misses when it shares storage with many others, with loads run earliest deadline first and in the
+// order they were queued. A player at 60 fps with a window of 6 frames shares 2 threads with players at 30 fps with
+// windows of 120 frames, reads taking 1 ms each. Each argument is a number of players at 30 fps, 24 and 48 by default.
+//
+//	SchedulingBenchmark [players...]
+//
+
+#include "Benchmark.h"
+#include "TestDocument.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Kimura;
+using namespace Kimura::Tests;
+
+namespace
+{
+	// frames the player at 60 fps didn't have in time over 480 ticks, and the loads that completed past their deadline
+	void BenchmarkScheduling(uint32 InNumPlayers, bool InEarliestDeadlineFirst)
+	{
+		DocumentDesc desc;
+		desc.NumFrames = 200;
+		desc.NumVertices = 500;
+		desc.IndicesInterval = 1;
+
+		const std::vector<byte> document = WriteDocument(desc);
+		const double bytesPerSecond = (double)document.size() / desc.NumFrames * 1000.0;
+
+		DeadlineScheduler::Get().SetEarliestDeadlineFirst(InEarliestDeadlineFirst);
+
+		std::shared_ptr<ITaskScheduler> pool = CreateThreadPool(2);
+
+		PlayerOptions options;
+		options.TaskScheduler = pool;
+		options.Loop = true;
+		options.PreBufferingSize = 6;
+
+		std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<ThrottledByteSource>(document, bytesPerSecond), options);
+
+		options.PreBufferingSize = 120;
+
+		std::vector<std::shared_ptr<IPlayer>> others;
+		for (uint32 iPlayer = 0; iPlayer < InNumPlayers; iPlayer++)
+		{
+			others.push_back(OpenDocument(std::make_shared<ThrottledByteSource>(document, bytesPerSecond), options));
+		}
+
+		// every player starts at once, the others still filling their windows
+		uint32 numMissedFrames = 0;
+		const uint32 numTicks = 480;
+		const auto start = std::chrono::steady_clock::now();
+
+		for (uint32 iTick = 0; iTick < numTicks; iTick++)
+		{
+			std::this_thread::sleep_until(start + std::chrono::microseconds(16667 * iTick));
+
+			if (player->GetFrameAt(iTick % desc.NumFrames, false) == nullptr)
+			{
+				numMissedFrames++;
+			}
+
+			if (iTick % 2 == 0)
+			{
+				for (std::shared_ptr<IPlayer>& other : others)
+				{
+					other->GetFrameAt((iTick / 2) % desc.NumFrames, false);
+				}
+			}
+		}
+
+		PlayerStats stats;
+		player->CollectStats(stats);
+
+		printf("%u players at 30 fps, %-24s %3u frames missed, %3u late loads\n", InNumPlayers, InEarliestDeadlineFirst ? "earliest deadline first:" : "in order queued:", numMissedFrames, stats.NumDeadlineMisses);
+
+		others.clear();
+		player = nullptr;
+
+		DeadlineScheduler::Get().SetEarliestDeadlineFirst(true);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// main
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	std::vector<uint32> numPlayers;
+	for (int i = 1; i < argc; i++)
+	{
+		if (atoi(argv[i]) > 0)
+		{
+			numPlayers.push_back((uint32)atoi(argv[i]));
+		}
+	}
+
+	if (numPlayers.empty())
+	{
+		numPlayers = { 24, 48 };
+	}
+
+	for (uint32 players : numPlayers)
+	{
+		BenchmarkScheduling(players, false);
+		BenchmarkScheduling(players, true);
+	}
+
+	return 0;
+}
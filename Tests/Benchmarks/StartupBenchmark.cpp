@@ -0,0 +1,90 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+// Time taken to open documents of many frames, until the player is ready. Documents have 8 meshes of 4 vertices,
+// positions stored every 5000 frames and indices only in the first one, so most of the time goes to the table of
+// content. Each argument is a number of frames, 20000 and 100000 by default.
+//
+//	StartupBenchmark [frames...]
+//
+
+#include "Benchmark.h"
+#include "TestDocument.h"
+
+#include <chrono>
+#include <vector>
+
+using namespace Kimura;
+using namespace Kimura::Tests;
+
+namespace
+{
+	void BenchmarkStartup(uint32 InNumFrames)
+	{
+		DocumentDesc desc;
+		desc.NumFrames = InNumFrames;
+		desc.NumVertices = 4;
+		desc.NumMeshes = 8;
+		desc.PositionsInterval = 5000;
+		desc.IndicesInterval = InNumFrames;
+
+		const std::vector<byte> document = WriteDocument(desc);
+
+		PlayerOptions options;
+		options.PreBufferingSize = 1;
+
+		// best of 3, the document is copied to its source outside of the measure
+		bool bFailed = false;
+		double duration = 1e30;
+
+		for (uint32 iRun = 0; iRun < 3; iRun++)
+		{
+			std::shared_ptr<IByteSource> source = CreateMemoryByteSource(std::vector<byte>(document));
+
+			const auto start = std::chrono::steady_clock::now();
+			std::shared_ptr<IPlayer> player = OpenDocument(source, options);
+			duration = std::min(duration, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+			bFailed |= player->GetStatus() != PlayerStatus::Ready || !CheckFrame(desc, player->GetFrameAt(InNumFrames - 1, true), InNumFrames - 1);
+		}
+
+		if (bFailed)
+		{
+			printf("%u frames: FAILED\n", InNumFrames);
+			return;
+		}
+
+		printf("%u frames of %u meshes, %.1f MB: opened in %.3fs\n", InNumFrames, desc.NumMeshes, document.size() / 1e6, duration);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// main
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	std::vector<uint32> numFrames;
+	for (int i = 1; i < argc; i++)
+	{
+		if (atoi(argv[i]) > 0)
+		{
+			numFrames.push_back((uint32)atoi(argv[i]));
+		}
+	}
+
+	if (numFrames.empty())
+	{
+		numFrames = { 20000, 100000 };
+	}
+
+	for (uint32 frames : numFrames)
+	{
+		BenchmarkStartup(frames);
+	}
+
+	return 0;
+}
@@ -0,0 +1,205 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+// Throughput of the stream decoders, on data shaped like the streams of a 60000 vertices mesh.
+//
+//	StreamCodecBenchmark [lz4] [reconstruct] [basis] [meshcodec]
+//
+
+#include "Benchmark.h"
+#include "TestEncoders.h"
+#include "Player.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace Kimura;
+using namespace Kimura::Tests;
+
+namespace
+{
+	const uint32 NumVertices = 60000;
+	const int NumRuns = 200;
+
+	// positions of a mesh, varying like the ones of real data
+	std::vector<byte> GetPositions()
+	{
+		std::vector<byte> positions(NumVertices * 12);
+		for (uint32 i = 0; i < NumVertices * 3; i++)
+		{
+			const float value = (float)(((i * 2654435761u) >> 24) & 63) * 0.25f;
+			memcpy(&positions[i * 4], &value, 4);
+		}
+
+		return positions;
+	}
+
+	void BenchmarkLZ4()
+	{
+		const std::vector<byte> positions = GetPositions();
+		const std::vector<byte> encoded = EncodeLZ4(positions.data(), positions.size());
+
+		std::vector<byte> decoded(positions.size());
+		const double duration = MeasureBest(NumRuns, [&]()
+		{
+			DecodeLZ4(encoded.data(), encoded.size(), decoded.data(), decoded.size());
+		});
+
+		printf("lz4: %.2f GB/s, ratio %.2f%s\n", positions.size() / duration / 1e9, (double)positions.size() / encoded.size(), decoded == positions ? "" : ", MISMATCH");
+	}
+
+	void BenchmarkReconstruct()
+	{
+		std::vector<byte> residuals(NumVertices * 12), previous(residuals.size()), beforePrevious(residuals.size());
+		for (size_t i = 0; i < residuals.size(); i++)
+		{
+			residuals[i] = (byte)i;
+			previous[i] = (byte)(i * 7);
+			beforePrevious[i] = (byte)(i * 13);
+		}
+
+		std::vector<byte> reconstructed(residuals.size());
+
+		for (StreamEncoding encoding : { StreamEncoding::Delta, StreamEncoding::Linear })
+		{
+			const double duration = MeasureBest(NumRuns, [&]()
+			{
+				ReconstructStream(encoding, 4, residuals.data(), previous.data(), beforePrevious.data(), reconstructed.data(), reconstructed.size());
+			});
+
+			printf("reconstruct %s: %.2f GB/s\n", encoding == StreamEncoding::Delta ? "delta" : "linear", reconstructed.size() / duration / 1e9);
+		}
+	}
+
+	// positions from a basis of 16 vectors, as floats and quantized
+	void BenchmarkBasis()
+	{
+		MeshBasis basis;
+		basis.NumVectors = 16;
+		basis.NumFloats = NumVertices * 3;
+		basis.Data.resize(basis.NumFloats * (basis.NumVectors + 1));
+		for (size_t i = 0; i < basis.Data.size(); i++)
+		{
+			basis.Data[i] = (float)(i % 97) * 0.01f;
+		}
+
+		const std::vector<float> coefficients(basis.NumVectors, 0.5f);
+		std::vector<byte> positions(NumVertices * 12);
+
+		for (PositionFormat format : { PositionFormat::Full, PositionFormat::Half })
+		{
+			const double duration = MeasureBest(NumRuns, [&]()
+			{
+				ReconstructFromBasis(basis, (const byte*)coefficients.data(), 0, NumVertices, format, Vector3(), Vector3(16.0f, 16.0f, 16.0f), positions.data());
+			});
+
+			printf("basis %s: %.2f ms, %.2f GB/s of basis read\n", format == PositionFormat::Full ? "full" : "half", duration * 1e3, basis.Data.size() * sizeof(float) / duration / 1e9);
+		}
+	}
+
+	// decoded size per second of the triangles of a 250 by 240 grid, and of its positions as byte planes, next to memcpy
+	void BenchmarkMeshCodec()
+	{
+		const uint32 width = 250;
+		const uint32 height = 240;
+
+		std::vector<uint32> order;
+		const std::vector<uint32> indices = GetGridIndices(width, height, order);
+
+		auto reportDecode = [](const char* InName, const std::vector<byte>& InRaw, const std::vector<byte>& InEncoded, double InDuration, double InCopyDuration, bool InMatches)
+		{
+			const std::vector<byte> compressed = EncodeLZ4(InRaw.data(), InRaw.size());
+			printf("%s: %zu B, lz4 %zu B, encoded %zu B; decode %.2f GB/s, memcpy %.2f GB/s%s\n", InName, InRaw.size(), compressed.size(), InEncoded.size(), InRaw.size() / InDuration / 1e9, InRaw.size() / InCopyDuration / 1e9, InMatches ? "" : ", MISMATCH");
+		};
+
+		{
+			std::vector<byte> raw(indices.size() * 2);
+			for (size_t i = 0; i < indices.size(); i++)
+			{
+				const uint16 index = (uint16)indices[i];
+				memcpy(&raw[i * 2], &index, 2);
+			}
+
+			const std::vector<byte> encoded = EncodeTriangles(indices, true);
+			std::vector<byte> decoded(raw.size());
+
+			const double duration = MeasureBest(NumRuns, [&]() { DecodeTriangles(encoded.data(), encoded.size(), decoded.data(), decoded.size(), 2); });
+			const double copyDuration = MeasureBest(NumRuns, [&]() { memcpy(decoded.data(), raw.data(), raw.size()); });
+
+			reportDecode("triangles", raw, encoded, duration, copyDuration, DecodeTriangles(encoded.data(), encoded.size(), decoded.data(), decoded.size(), 2));
+		}
+
+		// a wave over the grid, quantized or not
+		for (PositionFormat format : { PositionFormat::Half, PositionFormat::Full })
+		{
+			const uint32 vertexSize = format == PositionFormat::Half ? 6 : 12;
+
+			std::vector<byte> raw(order.size() * vertexSize);
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				const float x = (order[i] % width) * 0.1f;
+				const float y = (order[i] / width) * 0.1f;
+				const float position[3] = { x, y, 0.5f * sinf(x * 1.5f + 0.6f) * cosf(y + 0.3f) };
+
+				for (uint32 c = 0; c < 3; c++)
+				{
+					if (format == PositionFormat::Half)
+					{
+						const int16 quantized = (int16)lrintf(position[c] / 32.0f * 32767.0f);
+						memcpy(&raw[i * 6 + c * 2], &quantized, 2);
+					}
+					else
+					{
+						memcpy(&raw[i * 12 + c * 4], &position[c], 4);
+					}
+				}
+			}
+
+			const std::vector<byte> encoded = EncodeBytePlanes(raw.data(), order.size(), vertexSize);
+			std::vector<byte> decoded(raw.size());
+
+			const double duration = MeasureBest(NumRuns, [&]() { DecodeBytePlanes(encoded.data(), encoded.size(), decoded.data(), decoded.size(), vertexSize); });
+			const double copyDuration = MeasureBest(NumRuns, [&]() { memcpy(decoded.data(), raw.data(), raw.size()); });
+
+			reportDecode(format == PositionFormat::Half ? "byte planes, half positions" : "byte planes, full positions", raw, encoded, duration, copyDuration, decoded == raw);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// main
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+#if defined(KIMURA_SSE2)
+	printf("SSE2 code paths\n");
+#else
+	printf("scalar code paths\n");
+#endif
+
+	if (IsSelected(argc, argv, "lz4"))
+	{
+		BenchmarkLZ4();
+	}
+
+	if (IsSelected(argc, argv, "reconstruct"))
+	{
+		BenchmarkReconstruct();
+	}
+
+	if (IsSelected(argc, argv, "basis"))
+	{
+		BenchmarkBasis();
+	}
+
+	if (IsSelected(argc, argv, "meshcodec"))
+	{
+		BenchmarkMeshCodec();
+	}
+
+	return 0;
+}
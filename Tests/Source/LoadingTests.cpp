@@ -0,0 +1,605 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+// How players buffer frames: what they retain, how they share a memory budget, and when they load the frames they're
+// asked for. Players are left to settle before their stats are checked, nothing else moves the playback meanwhile.
+//
+
+#include "Tests.h"
+#include "TestDocument.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+using namespace Kimura;
+using namespace Kimura::Tests;
+
+namespace
+{
+	// every stream is stored by every frame, which makes them all the same size
+	DocumentDesc GetUniformDocument()
+	{
+		DocumentDesc desc;
+		desc.NumFrames = 60;
+		desc.NumVertices = 2000;
+		desc.IndicesInterval = 1;
+
+		return desc;
+	}
+
+	// whether the player settles with these many frames buffered ahead and behind
+	bool IsBuffered(IPlayer& InPlayer, uint32 InNumFramesAhead, uint32 InNumFramesBehind)
+	{
+		auto isBuffered = [=](const PlayerStats& InStats)
+		{
+			return InStats.BufferedFramesCount == InNumFramesAhead && InStats.BackBufferedFramesCount == InNumFramesBehind;
+		};
+
+		return isBuffered(WaitForStats(InPlayer, isBuffered));
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Buffering limits
+//-----------------------------------------------------------------------------
+KIMURA_TEST(CapBufferedBytes)
+{
+	const DocumentDesc desc = GetUniformDocument();
+
+	PlayerOptions options;
+	options.PreBufferingSize = 12;
+	options.KeyframeCacheSize = 0;
+
+	std::shared_ptr<IPlayer> uncapped = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+	KIMURA_CHECK(IsBuffered(*uncapped, 12, 0));
+
+	PlayerStats stats;
+	uncapped->CollectStats(stats);
+	const uint64 frameSize = stats.BufferedBytes / 12;
+
+	// room for 5 frames and a half, whatever the window
+	options.MaxBufferedBytes = 5 * frameSize + frameSize / 2;
+
+	std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+
+	for (uint32 iFrame = 0; iFrame < 20; iFrame++)
+	{
+		KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(iFrame, true), iFrame));
+
+		stats = WaitForStats(*player, [](const PlayerStats& InStats) { return InStats.BufferedFramesCount == 5; });
+		KIMURA_CHECK(stats.BufferedFramesCount == 5 && stats.BufferedBytes == 5 * frameSize);
+		KIMURA_CHECK(stats.BufferedBytes <= options.MaxBufferedBytes);
+	}
+
+	// a frame the application waits for is loaded even when it doesn't fit
+	options.MaxBufferedBytes = frameSize / 2;
+
+	player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+	KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(30, true), 30));
+	KIMURA_CHECK(IsBuffered(*player, 1, 0));
+}
+
+KIMURA_TEST(KeepBackBufferSizeFrames)
+{
+	const DocumentDesc desc = GetUniformDocument();
+
+	PlayerOptions options;
+	options.PreBufferingSize = 8;
+	options.BackBufferSize = 4;
+
+	std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+
+	for (uint32 iFrame = 0; iFrame <= 10; iFrame++)
+	{
+		KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(iFrame, true), iFrame));
+		KIMURA_CHECK(IsBuffered(*player, 8, std::min(iFrame, 4u)));
+	}
+
+	// the 4 frames before the last one requested are served without a load, the window stays where it is
+	for (uint32 iFrame = 6; iFrame < 10; iFrame++)
+	{
+		KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(iFrame, false), iFrame));
+	}
+
+	PlayerStats stats;
+	player->CollectStats(stats);
+	KIMURA_CHECK(stats.BackBufferHits == 4 && stats.BackBufferMisses == 0);
+	KIMURA_CHECK(stats.BufferedFramesStart == 10 && stats.BackBufferedFramesCount == 4);
+
+	// further back, the frame is reloaded and the window starts over from it
+	KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(5, true), 5));
+	KIMURA_CHECK(IsBuffered(*player, 8, 0));
+
+	player->CollectStats(stats);
+	KIMURA_CHECK(stats.BackBufferHits == 4 && stats.BackBufferMisses == 1);
+
+	// skipping ahead, closer than looping back, is neither
+	KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(20, true), 20));
+
+	player->CollectStats(stats);
+	KIMURA_CHECK(stats.BackBufferHits == 4 && stats.BackBufferMisses == 1);
+}
+
+KIMURA_TEST(AdaptWindowWithinBounds)
+{
+	const DocumentDesc desc = GetUniformDocument();
+
+	// frames are requested at 100 per second. Half a second ahead is more than MaxPreBufferingSize, a hundredth less 
+	// than MinPreBufferingSize.
+	for (double preBufferingTime : { 0.5, 0.01 })
+	{
+		PlayerOptions options;
+		options.AdaptivePreBuffering = true;
+		options.PreBufferingTime = preBufferingTime;
+		options.PreBufferingSize = 5;
+		options.MinPreBufferingSize = 3;
+		options.MaxPreBufferingSize = 8;
+
+		std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		PlayerStats stats;
+
+		for (uint32 iTick = 0; iTick < 80; iTick++)
+		{
+			std::this_thread::sleep_until(start + std::chrono::milliseconds(10 * iTick));
+			KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(iTick % desc.NumFrames, true), iTick % desc.NumFrames));
+
+			player->CollectStats(stats);
+			KIMURA_CHECK(stats.PreBufferingSize >= 3 && stats.PreBufferingSize <= 8);
+			KIMURA_CHECK(stats.BufferedFramesCount <= 8);
+		}
+
+		// the rate was measured and the window moved to the bound
+		const uint32 expectedSize = preBufferingTime > 0.1 ? 8 : 3;
+
+		KIMURA_CHECK(stats.FrameRequestRate > 50.0 && stats.FrameRequestRate < 150.0);
+		KIMURA_CHECK(stats.PreBufferingSize == expectedSize);
+		KIMURA_CHECK(IsBuffered(*player, expectedSize, stats.BackBufferedFramesCount));
+	}
+}
+
+KIMURA_TEST(RecycleFrameBuffers)
+{
+	const DocumentDesc desc = GetUniformDocument();
+
+	// frames are retired as soon as they're played and their buffers go to the pool, which the next loads take them 
+	// back from. The application holds on to the first 10 frames, and releases them once it's done playing.
+	auto playFrames = [&](uint64 InMaxPooledFrameBufferBytes)
+	{
+		PlayerOptions options;
+		options.PreBufferingSize = 4;
+		options.BackBufferSize = 0;
+		options.KeyframeCacheSize = 0;
+		options.MaxPooledFrameBufferBytes = InMaxPooledFrameBufferBytes;
+
+		std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+		std::vector<std::shared_ptr<IFrame>> heldFrames;
+
+		for (uint32 iFrame = 0; iFrame < 30; iFrame++)
+		{
+			std::shared_ptr<IFrame> frame = player->GetFrameAt(iFrame, true);
+			KIMURA_CHECK(CheckFrame(desc, frame, iFrame));
+
+			if (iFrame < 10)
+			{
+				heldFrames.push_back(frame);
+			}
+		}
+
+		heldFrames.clear();
+
+		// pool stats are refreshed once a second
+		std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+		PlayerStats stats;
+		player->CollectStats(stats);
+
+		return stats;
+	};
+
+	// most frames reuse the buffer of one retired before them, the pool keeps those of the frames released last
+	PlayerStats stats = playFrames(256 * 1024 * 1024);
+	KIMURA_CHECK(stats.FrameBufferPoolHitRate > 0.5 && stats.FrameBufferPoolHitRate < 1.0);
+	KIMURA_CHECK(stats.BufferedFramesCount == 4 && stats.FrameBufferPoolBytesHeld >= 10 * stats.BufferedBytes / 4);
+
+	// it holds on to what fits
+	const uint64 maxPooledBytes = stats.FrameBufferPoolBytesHeld / 2;
+	stats = playFrames(maxPooledBytes);
+	KIMURA_CHECK(stats.FrameBufferPoolHitRate > 0.5);
+	KIMURA_CHECK(stats.FrameBufferPoolBytesHeld > 0 && stats.FrameBufferPoolBytesHeld <= maxPooledBytes);
+
+	// and nothing without room
+	stats = playFrames(0);
+	KIMURA_CHECK(stats.FrameBufferPoolHitRate == 0.0 && stats.FrameBufferPoolBytesHeld == 0);
+}
+
+//-----------------------------------------------------------------------------
+// Memory budget
+//-----------------------------------------------------------------------------
+namespace
+{
+	// a player retaining nothing but its frames, 8 ahead and up to InBackBufferSize behind. It plays past that many 
+	// frames to fill its back buffer.
+	std::shared_ptr<IPlayer> OpenBudgetedPlayer(std::shared_ptr<IMemoryBudget> InBudget, int32 InPriority, uint32 InBackBufferSize)
+	{
+		PlayerOptions options;
+		options.PreBufferingSize = 8;
+		options.BackBufferSize = InBackBufferSize;
+		options.KeyframeCacheSize = 0;
+		options.MaxPooledFrameBufferBytes = 0;
+		options.MemoryBudget = InBudget;
+		options.MemoryBudgetPriority = InPriority;
+
+		std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(GetUniformDocument())), options);
+
+		for (uint32 iFrame = 0; iFrame <= InBackBufferSize; iFrame++)
+		{
+			player->GetFrameAt(iFrame, true);
+		}
+
+		return player;
+	}
+
+	uint64 GetFrameSize(IPlayer& InPlayer)
+	{
+		PlayerStats stats;
+		InPlayer.CollectStats(stats);
+
+		return stats.BufferedFramesCount > 0 ? stats.BufferedBytes / stats.BufferedFramesCount : 0;
+	}
+}
+
+KIMURA_TEST(TrimLowestPrioritiesFirst)
+{
+	std::shared_ptr<IMemoryBudget> budget = CreateMemoryBudget(0);
+
+	std::shared_ptr<IPlayer> low = OpenBudgetedPlayer(budget, 0, 8);
+	std::shared_ptr<IPlayer> high = OpenBudgetedPlayer(budget, 1, 8);
+	KIMURA_CHECK(IsBuffered(*low, 8, 8) && IsBuffered(*high, 8, 8));
+
+	const uint64 frameSize = GetFrameSize(*low);
+	KIMURA_CHECK(frameSize > 0 && budget->GetBytesUsed() == 32 * frameSize);
+
+	// back buffers first, those of the lowest priority before the others
+	KIMURA_CHECK(budget->Trim(4 * frameSize) == 4 * frameSize);
+	KIMURA_CHECK(IsBuffered(*low, 8, 4) && IsBuffered(*high, 8, 8));
+
+	KIMURA_CHECK(budget->Trim(8 * frameSize) == 8 * frameSize);
+	KIMURA_CHECK(IsBuffered(*low, 8, 0) && IsBuffered(*high, 8, 4));
+
+	// then frames buffered ahead, but the ones needed next. What was actually released is returned.
+	KIMURA_CHECK(budget->Trim(100 * frameSize) == 18 * frameSize);
+	KIMURA_CHECK(IsBuffered(*low, 1, 0) && IsBuffered(*high, 1, 0));
+
+	KIMURA_CHECK(budget->Trim(frameSize) == 0);
+	KIMURA_CHECK(budget->GetBytesUsed() == 2 * frameSize);
+}
+
+KIMURA_TEST(AdmitFramesByPriority)
+{
+	std::shared_ptr<IMemoryBudget> budget = CreateMemoryBudget(0);
+
+	std::shared_ptr<IPlayer> low = OpenBudgetedPlayer(budget, 0, 8);
+	KIMURA_CHECK(IsBuffered(*low, 8, 8));
+
+	// room for 4 frames more than it buffers
+	const uint64 frameSize = GetFrameSize(*low);
+	budget->SetBudget(20 * frameSize);
+
+	// a player ranking above takes the back buffer it's missing room for
+	std::shared_ptr<IPlayer> high = OpenBudgetedPlayer(budget, 1, 0);
+	KIMURA_CHECK(IsBuffered(*high, 8, 0));
+	KIMURA_CHECK(IsBuffered(*low, 8, 4));
+	KIMURA_CHECK(budget->GetBytesUsed() == 20 * frameSize);
+
+	// one of the same priority takes what's left of the back buffer, but not the frames buffered ahead. It's refused 
+	// the rest.
+	std::shared_ptr<IPlayer> peer = OpenBudgetedPlayer(budget, 0, 0);
+	KIMURA_CHECK(IsBuffered(*peer, 4, 0));
+	KIMURA_CHECK(IsBuffered(*low, 8, 0) && IsBuffered(*high, 8, 0));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	KIMURA_CHECK(IsBuffered(*peer, 4, 0));
+	KIMURA_CHECK(budget->GetBytesUsed() == 20 * frameSize);
+
+	// a lower budget applies right away, to the lowest priorities
+	budget->SetBudget(12 * frameSize);
+	KIMURA_CHECK(budget->GetBytesUsed() == 12 * frameSize);
+	KIMURA_CHECK(IsBuffered(*low, 1, 0) && IsBuffered(*peer, 3, 0) && IsBuffered(*high, 8, 0));
+}
+
+
+//-----------------------------------------------------------------------------
+// Deadline scheduling
+//-----------------------------------------------------------------------------
+namespace
+{
+	// which player read, in order
+	class ReadLog
+	{
+		public:
+
+			void Append(uint32 InPlayer)
+			{
+				std::unique_lock<std::mutex> lock(this->Mutex);
+				this->Reads.push_back(InPlayer);
+			}
+
+			std::vector<uint32> Take()
+			{
+				std::unique_lock<std::mutex> lock(this->Mutex);
+				return std::move(this->Reads);
+			}
+
+		protected:
+
+			std::mutex				Mutex;
+			std::vector<uint32>		Reads;
+	};
+
+	class LoggedByteSource : public PlainByteSource
+	{
+		public:
+
+			LoggedByteSource(std::vector<byte> InData, uint32 InPlayer, std::shared_ptr<ReadLog> InLog)
+				:
+				PlainByteSource(std::move(InData)),
+				Player(InPlayer),
+				Log(InLog)
+			{
+			}
+
+			virtual bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize) override
+			{
+				this->Log->Append(this->Player);
+				return PlainByteSource::ReadAt(InOffset, OutData, InSize);
+			}
+
+		protected:
+
+			uint32						Player = 0;
+			std::shared_ptr<ReadLog>	Log;
+	};
+}
+
+KIMURA_TEST(LoadEarliestDeadlineFirst)
+{
+	// a single thread loads the frames of every player
+	std::shared_ptr<ITaskScheduler> pool = CreateThreadPool(1);
+	std::shared_ptr<ReadLog> log = std::make_shared<ReadLog>();
+
+	auto openPlayer = [&](uint32 InPlayer, uint32 InPreBufferingSize)
+	{
+		PlayerOptions options;
+		options.PreBufferingSize = InPreBufferingSize;
+		options.BackBufferSize = 0;
+		options.TaskScheduler = pool;
+
+		return OpenDocument(std::make_shared<LoggedByteSource>(WriteDocument(GetUniformDocument()), InPlayer, log), options);
+	};
+
+	// a player about to run out of frames, and one far ahead. Neither measured a request rate yet, frames are due 
+	// every 1/30 second.
+	std::shared_ptr<IPlayer> starving = openPlayer(0, 2);
+	std::shared_ptr<IPlayer> ahead = openPlayer(1, 40);
+	KIMURA_CHECK(IsBuffered(*starving, 2, 0) && IsBuffered(*ahead, 40, 0));
+
+	PlayerStats starvingStats;
+	PlayerStats aheadStats;
+	starving->CollectStats(starvingStats);
+	ahead->CollectStats(aheadStats);
+
+	// both queue a load while the thread is busy, the player far ahead first
+	std::promise<void> busy;
+	std::shared_future<void> done = busy.get_future().share();
+	pool->Submit([done]() { done.wait(); });
+
+	log->Take();
+	KIMURA_CHECK(ahead->GetFrameAt(1, false) != nullptr);
+	KIMURA_CHECK(starving->GetFrameAt(1, false) != nullptr);
+
+	// long enough for the next frame of the starving player to be late, not those of the other one
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	busy.set_value();
+
+	KIMURA_CHECK(IsBuffered(*starving, 2, 0) && IsBuffered(*ahead, 40, 0));
+
+	// the most urgent load runs first, whatever the order they were queued in
+	const std::vector<uint32> reads = log->Take();
+	KIMURA_CHECK(reads.size() == 2 && reads[0] == 0 && reads[1] == 1);
+
+	// and only that one completed past its deadline
+	const uint32 numStarvingMisses = starvingStats.NumDeadlineMisses;
+	const uint32 numAheadMisses = aheadStats.NumDeadlineMisses;
+	starving->CollectStats(starvingStats);
+	ahead->CollectStats(aheadStats);
+
+	KIMURA_CHECK(starvingStats.NumDeadlineMisses == numStarvingMisses + 1);
+	KIMURA_CHECK(aheadStats.NumDeadlineMisses == numAheadMisses);
+}
+
+
+//-----------------------------------------------------------------------------
+// Frame requests
+//-----------------------------------------------------------------------------
+namespace
+{
+	// plain source whose reads wait while it's blocked
+	class BlockingByteSource : public PlainByteSource
+	{
+		public:
+
+			BlockingByteSource(std::vector<byte> InData, bool InBlocked)
+				:
+				PlainByteSource(std::move(InData)),
+				bBlocked(InBlocked)
+			{
+			}
+
+			void SetBlocked(bool InBlocked)
+			{
+				{
+					std::unique_lock<std::mutex> lock(this->Mutex);
+					this->bBlocked = InBlocked;
+				}
+
+				this->UnblockedEvent.notify_all();
+			}
+
+			virtual bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize) override
+			{
+				{
+					std::unique_lock<std::mutex> lock(this->Mutex);
+					this->UnblockedEvent.wait(lock, [this]() { return !this->bBlocked; });
+				}
+
+				return PlainByteSource::ReadAt(InOffset, OutData, InSize);
+			}
+
+		protected:
+
+			std::mutex					Mutex;
+			std::condition_variable		UnblockedEvent;
+			bool						bBlocked = false;
+	};
+
+	bool IsReady(const std::shared_future<std::shared_ptr<IFrame>>& InFuture)
+	{
+		return InFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+}
+
+KIMURA_TEST(RunRequestCallbacksFirst)
+{
+	const DocumentDesc desc = GetUniformDocument();
+
+	PlayerOptions options;
+	options.PreBufferingSize = 4;
+
+	std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+	KIMURA_CHECK(player->GetFrameAt(0, true) != nullptr);
+
+	// a frame that's buffered completes right away, one that isn't once it's loaded. Either way, the callback is done 
+	// by the time the future is ready.
+	for (uint32 iFrame : { 1u, 40u })
+	{
+		std::atomic<bool> bCalledBack(false);
+		std::shared_future<std::shared_ptr<IFrame>> future = player->RequestFrame(iFrame, [&](std::shared_ptr<IFrame> InFrame)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			bCalledBack = InFrame != nullptr;
+		});
+
+		KIMURA_CHECK(CheckFrame(desc, future.get(), iFrame));
+		KIMURA_CHECK(bCalledBack);
+	}
+}
+
+KIMURA_TEST(RequestFramesBeforeReady)
+{
+	const DocumentDesc desc = GetUniformDocument();
+
+	// the table of content can't be read yet
+	std::shared_ptr<BlockingByteSource> source = std::make_shared<BlockingByteSource>(WriteDocument(desc), true);
+	std::shared_ptr<IPlayer> player = CreatePlayer(source, PlayerOptions());
+
+	std::shared_future<std::shared_ptr<IFrame>> frame = player->RequestFrame(30);
+	std::shared_future<std::shared_ptr<IFrame>> missing = player->RequestFrame(desc.NumFrames);
+
+	KIMURA_CHECK(player->GetStatus() == PlayerStatus::Initializing);
+	KIMURA_CHECK(!IsReady(frame) && !IsReady(missing));
+
+	// both are kept until the player knows which frames there are
+	source->SetBlocked(false);
+
+	KIMURA_CHECK(CheckFrame(desc, frame.get(), 30));
+	KIMURA_CHECK(missing.get() == nullptr);
+}
+
+KIMURA_TEST(CompleteMissingFramesWithNull)
+{
+	const DocumentDesc desc = GetUniformDocument();
+	std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), PlayerOptions());
+
+	for (uint32 iFrame : { desc.NumFrames, desc.NumFrames + 1, ~0u })
+	{
+		std::atomic<bool> bCalledBack(false);
+		std::shared_future<std::shared_ptr<IFrame>> future = player->RequestFrame(iFrame, [&](std::shared_ptr<IFrame> InFrame) { bCalledBack = InFrame == nullptr; });
+
+		// right away
+		KIMURA_CHECK(IsReady(future) && future.get() == nullptr && bCalledBack);
+	}
+}
+
+KIMURA_TEST(CompleteRequestsOnStop)
+{
+	const DocumentDesc desc = GetUniformDocument();
+
+	std::shared_ptr<BlockingByteSource> source = std::make_shared<BlockingByteSource>(WriteDocument(desc), true);
+	std::shared_ptr<IPlayer> player = CreatePlayer(source, PlayerOptions());
+
+	std::atomic<uint32> numCalledBack(0);
+	std::vector<std::shared_future<std::shared_ptr<IFrame>>> futures;
+
+	for (uint32 iFrame : { 0u, 30u, desc.NumFrames })
+	{
+		futures.push_back(player->RequestFrame(iFrame, [&](std::shared_ptr<IFrame> InFrame) { numCalledBack += InFrame == nullptr ? 1 : 0; }));
+	}
+
+	// the player is destroyed with its task still reading, which waits for it. The requests complete first.
+	uint32 numCalledBackWhileStopping = 0;
+	std::thread unblock([&]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		numCalledBackWhileStopping = numCalledBack;
+		source->SetBlocked(false);
+	});
+
+	player = nullptr;
+	unblock.join();
+
+	KIMURA_CHECK(numCalledBackWhileStopping == (uint32)futures.size());
+
+	for (const std::shared_future<std::shared_ptr<IFrame>>& future : futures)
+	{
+		KIMURA_CHECK(IsReady(future) && future.get() == nullptr);
+	}
+
+	// nothing is added to a stopped player
+	KIMURA_CHECK(numCalledBack == (uint32)futures.size());
+}
+
+KIMURA_TEST(GetFramesUntilDeadline)
+{
+	const DocumentDesc desc = GetUniformDocument();
+
+	PlayerOptions options;
+	options.PreBufferingSize = 4;
+
+	std::shared_ptr<BlockingByteSource> source = std::make_shared<BlockingByteSource>(WriteDocument(desc), false);
+	std::shared_ptr<IPlayer> player = OpenDocument(source, options);
+	KIMURA_CHECK(player->GetFrameAt(0, true) != nullptr);
+
+	// a frame that can't be read in time
+	source->SetBlocked(true);
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	KIMURA_CHECK(player->GetFrameAt(40, start + std::chrono::milliseconds(50)) == nullptr);
+
+	const double waitTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	KIMURA_CHECK(waitTime >= 0.05 && waitTime < 2.0);
+
+	// the player keeps going once it can
+	source->SetBlocked(false);
+	KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(40, std::chrono::steady_clock::now() + std::chrono::seconds(5)), 40));
+	KIMURA_CHECK(player->GetStatus() == PlayerStatus::Ready);
+}
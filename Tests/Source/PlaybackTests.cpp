@@ -0,0 +1,743 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+// Documents played through, with every frame checked. Each feature of the player has tests of its own: constant 
+// meshes, playback directions, pipelined and bulk loading, mapped sources and queued reads. Compressed and encoded 
+// streams are then played through every playback mode.
+//
+
+#include "Tests.h"
+#include "TestDocument.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <utility>
+
+using namespace Kimura;
+using namespace Kimura::Tests;
+
+namespace
+{
+	// how the frames of a document are loaded
+	enum class PlaybackMode
+	{
+		Sequential,
+		Pipelined,
+		BufferEntirePlayback,
+		Reverse,
+		PingPong,
+		QueuedReads
+	};
+
+	const PlaybackMode PlaybackModes[] = { PlaybackMode::Sequential, PlaybackMode::Pipelined, PlaybackMode::BufferEntirePlayback, PlaybackMode::Reverse, PlaybackMode::PingPong, PlaybackMode::QueuedReads };
+
+	PlayerOptions GetOptions(PlaybackMode InMode)
+	{
+		PlayerOptions options;
+		options.PreBufferingSize = 8;
+		options.KeyframeCacheSize = 1;
+
+		switch (InMode)
+		{
+			case PlaybackMode::Pipelined:
+				options.NumDecodeTasks = 2;
+				options.DecodeQueueDepth = 3;
+				break;
+
+			case PlaybackMode::BufferEntirePlayback:
+				options.BufferEntirePlayback = true;
+				break;
+
+			case PlaybackMode::Reverse:
+				options.Direction = PlaybackDirection::Reverse;
+				options.NumDecompressionTasks = 1;
+				break;
+
+			case PlaybackMode::PingPong:
+				options.Direction = PlaybackDirection::PingPong;
+				options.KeyframeCacheSize = 0;
+				break;
+
+			case PlaybackMode::QueuedReads:
+				options.IOQueueDepth = 8;
+				break;
+
+			default:
+				break;
+		}
+
+		return options;
+	}
+
+	// decodes Zstd streams stored uncompressed, for documents that need a decoder
+	class StoredStreamDecoder : public IStreamDecoder
+	{
+		public:
+
+			virtual bool Decode(StreamCodec InCodec, const byte* InData, uint64 InSize, byte* OutData, uint64 OutSize) override
+			{
+				if (InCodec != StreamCodec::Zstd || InSize != OutSize)
+				{
+					return false;
+				}
+
+				memcpy(OutData, InData, (size_t)InSize);
+				return true;
+			}
+	};
+
+	// documents read through queued reads are written to a file, those need a file descriptor. Each build has its 
+	// own, they may run at once.
+	const char* GetDocumentPath()
+	{
+		return IsUsingSIMD() ? "KimuraPlaybackTests.kimura" : "KimuraPlaybackTestsScalar.kimura";
+	}
+
+	// Plays a document through: every frame in order, then random seeks and requests. Frames are read from a plain
+	// source, or mapped from memory. With queued reads, they're read from a file instead of a plain source.
+	bool PlayThrough(const DocumentDesc& InDesc, const PlayerOptions& InOptions, bool InMapped)
+	{
+		uint64 frameDataPosition = 0;
+		std::vector<byte> document = WriteDocument(InDesc, &frameDataPosition);
+
+		std::shared_ptr<IByteSource> source;
+		if (InMapped)
+		{
+			source = std::make_shared<MappedByteSource>(document, frameDataPosition);
+		}
+		else if (InOptions.IOQueueDepth > 1)
+		{
+			FILE* file = fopen(GetDocumentPath(), "wb");
+			const bool bWritten = file != nullptr && fwrite(document.data(), 1, document.size(), file) == document.size();
+			if (file == nullptr || fclose(file) != 0 || !bWritten)
+			{
+				printf("failed to write %s\n", GetDocumentPath());
+				return false;
+			}
+
+			source = CreateFileByteSource(GetDocumentPath());
+		}
+		else
+		{
+			source = std::make_shared<PlainByteSource>(std::move(document));
+		}
+
+		std::shared_ptr<IPlayer> player = OpenDocument(source, InOptions);
+		if (player->GetStatus() != PlayerStatus::Ready)
+		{
+			std::string message;
+			player->GetFailStatusMessage(message);
+			printf("failed to open: %s\n", message.c_str());
+			return false;
+		}
+
+		for (uint32 iFrame = 0; iFrame < InDesc.NumFrames; iFrame++)
+		{
+			if (!CheckFrame(InDesc, player->GetFrameAt(iFrame, true), iFrame, InOptions.MaxBasisError))
+			{
+				return false;
+			}
+		}
+
+		std::mt19937 random(7);
+
+		for (uint32 i = 0; i < 40; i++)
+		{
+			const uint32 iFrame = random() % InDesc.NumFrames;
+			if (!CheckFrame(InDesc, player->GetFrameAt(iFrame, true), iFrame, InOptions.MaxBasisError))
+			{
+				return false;
+			}
+		}
+
+		for (uint32 i = 0; i < 10; i++)
+		{
+			const uint32 iFrame = random() % InDesc.NumFrames;
+			if (!CheckFrame(InDesc, player->RequestFrame(iFrame).get(), iFrame, InOptions.MaxBasisError))
+			{
+				return false;
+			}
+		}
+
+		return player->GetStatus() == PlayerStatus::Ready;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Constant meshes
+//-----------------------------------------------------------------------------
+KIMURA_TEST(LoadConstantMeshesOnce)
+{
+	DocumentDesc desc;
+	desc.NumFrames = 30;
+	desc.NumVertices = 1000;
+	desc.NumMeshes = 2;
+	desc.ConstantMesh = 1;
+
+	for (uint32 iMode = 0; iMode < sizeof(PlaybackModes) / sizeof(PlaybackModes[0]); iMode++)
+	{
+		std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), GetOptions(PlaybackModes[iMode]));
+		KIMURA_CHECK(player->GetStatus() == PlayerStatus::Ready);
+
+		std::shared_ptr<IFrame> first = player->GetFrameAt(0, true);
+		KIMURA_CHECK(CheckFrame(desc, first, 0));
+
+		// every frame points to the same streams of the constant mesh, whether it's played in order or sought, while the 
+		// other mesh has streams of its own
+		for (uint32 iFrame : { 1u, 2u, 17u, 29u, 5u })
+		{
+			std::shared_ptr<IFrame> frame = player->GetFrameAt(iFrame, true);
+			KIMURA_CHECK(CheckFrame(desc, frame, iFrame));
+
+			KIMURA_CHECK(frame->GetPositionsF32(1) == first->GetPositionsF32(1) && frame->GetIndicesU16(1) == first->GetIndicesU16(1));
+			KIMURA_CHECK(frame->GetPositionsF32(0) != first->GetPositionsF32(0));
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Playback directions
+//-----------------------------------------------------------------------------
+namespace
+{
+	// waits for the window of the player to fill, then requests the frames it should hold without waiting for them
+	bool IsBufferedAhead(const DocumentDesc& InDesc, IPlayer& InPlayer, const std::vector<uint32>& InFrames)
+	{
+		const uint32 numFrames = (uint32)InFrames.size();
+		const PlayerStats stats = WaitForStats(InPlayer, [=](const PlayerStats& InStats) { return InStats.BufferedFramesCount == numFrames; });
+
+		if (stats.BufferedFramesCount != numFrames || stats.BufferedFramesStart != InFrames[0])
+		{
+			return false;
+		}
+
+		for (uint32 iFrame : InFrames)
+		{
+			if (!CheckFrame(InDesc, InPlayer.GetFrameAt(iFrame, false), iFrame))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+KIMURA_TEST(BufferFramesBackwards)
+{
+	DocumentDesc desc;
+	desc.NumFrames = 30;
+	desc.NumVertices = 1000;
+
+	PlayerOptions options;
+	options.PreBufferingSize = 6;
+	options.Direction = PlaybackDirection::Reverse;
+
+	std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+
+	// the window is ahead in the direction of playback, and wraps around from the first frame to the last one
+	KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(20, true), 20));
+	KIMURA_CHECK(IsBufferedAhead(desc, *player, { 20, 19, 18, 17, 16, 15 }));
+
+	KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(2, true), 2));
+	KIMURA_CHECK(IsBufferedAhead(desc, *player, { 2, 1, 0, 29, 28, 27 }));
+}
+
+KIMURA_TEST(BufferFramesBackAndForth)
+{
+	DocumentDesc desc;
+	desc.NumFrames = 30;
+	desc.NumVertices = 1000;
+
+	PlayerOptions options;
+	options.PreBufferingSize = 6;
+	options.Direction = PlaybackDirection::PingPong;
+
+	std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+
+	// the window turns around on the last frame, then on the first one
+	KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(27, true), 27));
+	KIMURA_CHECK(IsBufferedAhead(desc, *player, { 27, 28, 29, 28, 27, 26 }));
+
+	for (uint32 iFrame = 25; iFrame >= 2; iFrame--)
+	{
+		KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(iFrame, true), iFrame));
+	}
+
+	KIMURA_CHECK(IsBufferedAhead(desc, *player, { 2, 1, 0, 1, 2, 3 }));
+}
+
+//-----------------------------------------------------------------------------
+// Pipelined loading
+//-----------------------------------------------------------------------------
+namespace
+{
+	// takes its time to decode streams stored uncompressed, frames pile up between reading and decoding
+	class SlowStreamDecoder : public StoredStreamDecoder
+	{
+		public:
+
+			virtual bool Decode(StreamCodec InCodec, const byte* InData, uint64 InSize, byte* OutData, uint64 OutSize) override
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				return StoredStreamDecoder::Decode(InCodec, InData, InSize, OutData, OutSize);
+			}
+	};
+}
+
+KIMURA_TEST(BoundDecodeQueue)
+{
+	DocumentDesc desc;
+	desc.NumFrames = 40;
+	desc.NumVertices = 1000;
+	desc.IndicesInterval = 1;
+	desc.Codec = StreamCodec::Zstd;
+
+	PlayerOptions options;
+	options.PreBufferingSize = 30;
+	options.NumDecodeTasks = 2;
+	options.DecodeQueueDepth = 3;
+	options.NumDecompressionTasks = 1;
+	options.StreamDecoder = std::make_shared<SlowStreamDecoder>();
+
+	// room for the reads and both decode tasks, whatever the number of cores
+	options.TaskScheduler = CreateThreadPool(3);
+
+	std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+	KIMURA_CHECK(player->GetStatus() == PlayerStatus::Ready);
+
+	// reads run ahead of the decoding until the queue is full, and no further
+	uint32 maxQueueDepth = 0;
+	const PlayerStats stats = WaitForStats(*player, [&](const PlayerStats& InStats)
+	{
+		maxQueueDepth = std::max(maxQueueDepth, InStats.DecodeQueueDepth);
+		return InStats.BufferedFramesCount == 30;
+	});
+
+	KIMURA_CHECK(stats.BufferedFramesCount == 30);
+	KIMURA_CHECK(maxQueueDepth == 3);
+
+	// frames are published in order, whichever task decoded them
+	for (uint32 iFrame = 0; iFrame < desc.NumFrames; iFrame++)
+	{
+		KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(iFrame, true), iFrame));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Bulk loading
+//-----------------------------------------------------------------------------
+KIMURA_TEST(BulkLoadEveryFrame)
+{
+	// predicted positions, with keyframes for the tasks to start from
+	DocumentDesc desc;
+	desc.NumFrames = 50;
+	desc.NumVertices = 1000;
+	desc.PositionEncoding = StreamEncoding::Linear;
+	desc.KeyframeInterval = 8;
+
+	// a single task, several, and more than there are frames
+	for (uint32 numTasks : { 1u, 4u, 64u })
+	{
+		PlayerOptions options;
+		options.BufferEntirePlayback = true;
+		options.NumBulkLoadTasks = numTasks;
+		options.TaskScheduler = CreateThreadPool(4);
+
+		std::shared_ptr<IPlayer> player = OpenDocument(std::make_shared<PlainByteSource>(WriteDocument(desc)), options);
+		KIMURA_CHECK(player->GetStatus() == PlayerStatus::Ready);
+
+		const PlayerStats stats = WaitForStats(*player, [](const PlayerStats& InStats) { return InStats.PercentLoaded == 100.0; });
+		KIMURA_CHECK(stats.PercentLoaded == 100.0 && stats.BufferedFramesCount == desc.NumFrames && stats.TimeToFullyResident > 0.0);
+
+		// once loaded, every frame is there whatever the order they're asked for in
+		for (uint32 iFrame = desc.NumFrames; iFrame-- > 0;)
+		{
+			KIMURA_CHECK(CheckFrame(desc, player->GetFrameAt(iFrame, false), iFrame));
+		}
+
+		KIMURA_CHECK(player->GetStatus() == PlayerStatus::Ready);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Mapped sources
+//-----------------------------------------------------------------------------
+KIMURA_TEST(PointIntoAlignedSources)
+{
+	DocumentDesc desc;
+	desc.NumFrames = 10;
+	desc.NumVertices = 300;
+
+	uint64 frameDataPosition = 0;
+	const std::vector<byte> document = WriteDocument(desc, &frameDataPosition);
+
+	// frame data on 16 bytes, then one byte past it, which leaves every stream misaligned
+	for (uint32 misalignment : { 0u, 1u })
+	{
+		std::shared_ptr<IByteSource> source = std::make_shared<MappedByteSource>(document, frameDataPosition, misalignment);
+		const byte* data = source->Map();
+
+		std::shared_ptr<IPlayer> player = OpenDocument(source, PlayerOptions());
+		KIMURA_CHECK(player->GetStatus() == PlayerStatus::Ready);
+
+		for (uint32 iFrame = 0; iFrame < desc.NumFrames; iFrame++)
+		{
+			std::shared_ptr<IFrame> frame = player->GetFrameAt(iFrame, true);
+			if (!CheckFrame(desc, frame, iFrame))
+			{
+				KIMURA_CHECK(false);
+				break;
+			}
+
+			// frames point into the source when they can, and are read into aligned buffers otherwise
+			const byte* positions = (const byte*)frame->GetPositionsF32(0);
+			const bool bInSource = positions >= data && positions < data + document.size();
+
+			KIMURA_CHECK(bInSource == (misalignment == 0));
+			KIMURA_CHECK((uintptr_t)positions % 4 == 0 && (uintptr_t)frame->GetIndicesU16(0) % 2 == 0);
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Queued reads
+//-----------------------------------------------------------------------------
+KIMURA_TEST(ReadWithoutIOUring)
+{
+	DocumentDesc desc;
+	desc.NumFrames = 30;
+	desc.NumVertices = 2000;
+	desc.IndicesInterval = 4;
+
+	// io_uring refuses rings of more than 32768 entries. The player reads frames one at a time instead, like it does 
+	// when the kernel doesn't support it or a sandbox denies it.
+	PlayerOptions options = GetOptions(PlaybackMode::QueuedReads);
+	options.IOQueueDepth = 65536;
+
+	KIMURA_CHECK(PlayThrough(desc, options, false));
+
+	remove(GetDocumentPath());
+}
+
+//-----------------------------------------------------------------------------
+// Compressed and encoded streams (formats 0.6 to 0.8)
+//-----------------------------------------------------------------------------
+namespace
+{
+	// how the streams of a document are compressed and encoded
+	struct EncodingCase
+	{
+		StreamCodec			Codec;
+		uint8				MinorVersion;
+		StreamEncoding		IndexEncoding;
+		StreamEncoding		PositionEncoding;
+		uint32				SparseInterval;
+		uint32				KeyframeInterval;
+		PositionFormat		BasisPositionFormat;
+		float				MaxBasisError;
+
+		// also played with frames large enough to be decoded by several tasks
+		bool				Large;
+	};
+
+	const EncodingCase EncodingCases[] =
+	{
+		// format 0.5, then 0.6 with each codec
+		{ StreamCodec::None,	5,	StreamEncoding::Raw,		StreamEncoding::Raw,		0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::None,	6,	StreamEncoding::Raw,		StreamEncoding::Raw,		0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::LZ4,		6,	StreamEncoding::Raw,		StreamEncoding::Raw,		0,	0,	PositionFormat::Full,	0.0f,	true },
+		{ StreamCodec::Zstd,	6,	StreamEncoding::Raw,		StreamEncoding::Raw,		0,	0,	PositionFormat::Full,	0.0f,	false },
+
+		// predicted positions, from the first frame only or from keyframes
+		{ StreamCodec::None,	0,	StreamEncoding::Raw,		StreamEncoding::Delta,		0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::None,	0,	StreamEncoding::Raw,		StreamEncoding::Delta,		0,	8,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Raw,		StreamEncoding::Delta,		0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Raw,		StreamEncoding::Delta,		0,	8,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::None,	0,	StreamEncoding::Raw,		StreamEncoding::Linear,		0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::None,	0,	StreamEncoding::Raw,		StreamEncoding::Linear,		0,	8,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Raw,		StreamEncoding::Linear,		0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Raw,		StreamEncoding::Linear,		0,	5,	PositionFormat::Full,	0.0f,	true },
+
+		// sparse changes, alone or every third frame of linear prediction
+		{ StreamCodec::None,	0,	StreamEncoding::Raw,		StreamEncoding::Sparse,		0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::None,	0,	StreamEncoding::Raw,		StreamEncoding::Sparse,		0,	16,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Raw,		StreamEncoding::Sparse,		0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Raw,		StreamEncoding::Sparse,		0,	16,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Raw,		StreamEncoding::Linear,		3,	16,	PositionFormat::Full,	0.0f,	false },
+
+		// basis positions, from every vector or the first 4 within the error bound
+		{ StreamCodec::None,	0,	StreamEncoding::Raw,		StreamEncoding::Basis,		0,	0,	PositionFormat::Full,	0.0f,	true },
+		{ StreamCodec::None,	0,	StreamEncoding::Raw,		StreamEncoding::Basis,		0,	0,	PositionFormat::Full,	0.3f,	false },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Raw,		StreamEncoding::Basis,		0,	0,	PositionFormat::Half,	0.0f,	true },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Raw,		StreamEncoding::Basis,		0,	0,	PositionFormat::Half,	0.3f,	false },
+
+		// triangles and byte planes, next to raw or compressed streams
+		{ StreamCodec::None,	0,	StreamEncoding::Triangles,	StreamEncoding::Raw,		0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::None,	0,	StreamEncoding::Raw,		StreamEncoding::BytePlanes,	0,	0,	PositionFormat::Full,	0.0f,	false },
+		{ StreamCodec::None,	0,	StreamEncoding::Triangles,	StreamEncoding::BytePlanes,	0,	0,	PositionFormat::Full,	0.0f,	true },
+		{ StreamCodec::LZ4,		0,	StreamEncoding::Triangles,	StreamEncoding::BytePlanes,	0,	0,	PositionFormat::Full,	0.0f,	false }
+	};
+
+	const uint32 NumEncodingCases = sizeof(EncodingCases) / sizeof(EncodingCases[0]);
+
+	// blocks of 100 vertices change every 10 frames, staggered, and every 7th frame nothing changes
+	float GetPartiallyAnimatedPosition(uint32 InFrame, uint32 InMesh, uint32 InComponent)
+	{
+		const uint32 step = InFrame - (InFrame + 4) / 7;
+		return (float)((step + (InComponent / 3 / 100) % 10) / 10) + InMesh * 1000 + (InComponent % 3) * 0.5f;
+	}
+
+	void ApplyEncodingCase(const EncodingCase& InCase, DocumentDesc& InOutDesc, PlayerOptions& InOutOptions)
+	{
+		InOutDesc.Codec = InCase.Codec;
+		InOutDesc.MinorVersion = InCase.MinorVersion;
+		InOutDesc.IndexEncoding = InCase.IndexEncoding;
+		InOutDesc.PositionEncoding = InCase.PositionEncoding;
+		InOutDesc.SparseInterval = InCase.SparseInterval;
+		InOutDesc.KeyframeInterval = InCase.KeyframeInterval;
+		InOutDesc.BasisPositionFormat = InCase.BasisPositionFormat;
+
+		// sparse changes are for meshes only partially animated
+		if (InCase.PositionEncoding == StreamEncoding::Sparse || InCase.SparseInterval > 0)
+		{
+			InOutDesc.PositionValue = GetPartiallyAnimatedPosition;
+		}
+		else
+		{
+			InOutDesc.VariedPositions = true;
+		}
+
+		InOutOptions.MaxBasisError = InCase.MaxBasisError;
+
+		if (InCase.Codec == StreamCodec::Zstd)
+		{
+			InOutOptions.StreamDecoder = std::make_shared<StoredStreamDecoder>();
+		}
+	}
+
+	// breaks a frame mesh of an otherwise valid document
+	std::function<void(DocumentDesc&)> BreakFrameMesh(uint32 InFrame, uint32 InMesh, std::function<void(TestFrameMesh&)> InEdit)
+	{
+		return [=](DocumentDesc& InOutDesc)
+		{
+			InOutDesc.EditFrameMesh = [=](uint32 iFrame, uint32 iMesh, TestFrameMesh& InOutFrameMesh)
+			{
+				if (iFrame == InFrame && iMesh == InMesh)
+				{
+					InEdit(InOutFrameMesh);
+				}
+			};
+		};
+	}
+
+	// breaks the first mesh of an otherwise valid document
+	std::function<void(DocumentDesc&)> BreakMesh(std::function<void(TestMesh&)> InEdit)
+	{
+		return [=](DocumentDesc& InOutDesc)
+		{
+			InOutDesc.EditMesh = [=](uint32 iMesh, TestMesh& InOutMesh)
+			{
+				if (iMesh == 0)
+				{
+					InEdit(InOutMesh);
+				}
+			};
+		};
+	}
+
+	// a document that opens, until it's broken
+	struct BrokenDocument
+	{
+		StreamEncoding		IndexEncoding;
+		StreamEncoding		PositionEncoding;
+		std::function<void(DocumentDesc&)> Break;
+
+		// the reason it fails, any when null
+		const char*			Failure;
+	};
+}
+
+KIMURA_TEST(PlayEncodedStreams)
+{
+	for (uint32 iCase = 0; iCase < NumEncodingCases; iCase++)
+	{
+		for (uint32 iMode = 0; iMode < sizeof(PlaybackModes) / sizeof(PlaybackModes[0]); iMode++)
+		{
+			const PlaybackMode mode = PlaybackModes[iMode];
+
+			DocumentDesc desc;
+			desc.NumFrames = 40;
+			desc.NumVertices = 3000;
+			desc.NumMeshes = 2;
+			desc.IndicesInterval = 7;
+
+			// frames reusing the streams of others, and a constant mesh next to encoded ones
+			desc.PositionsInterval = mode == PlaybackMode::PingPong ? 2 : 1;
+			desc.ConstantMesh = mode == PlaybackMode::Reverse ? 1 : -1;
+
+			PlayerOptions options = GetOptions(mode);
+			ApplyEncodingCase(EncodingCases[iCase], desc, options);
+
+			// each case is read from a plain source in some modes and mapped in the others, rather than doubling the runs. 
+			// Queued reads are never mapped.
+			const bool bMapped = mode != PlaybackMode::QueuedReads && (iCase + iMode) % 2 == 1;
+
+			const bool bPlayed = PlayThrough(desc, options, bMapped);
+			if (!bPlayed)
+			{
+				printf("encoding case %u, playback mode %u\n", iCase, iMode);
+			}
+
+			KIMURA_CHECK(bPlayed);
+		}
+	}
+
+	remove(GetDocumentPath());
+}
+
+KIMURA_TEST(PlayLargeEncodedFrames)
+{
+	bool bMapped = false;
+
+	for (uint32 iCase = 0; iCase < NumEncodingCases; iCase++)
+	{
+		if (!EncodingCases[iCase].Large)
+		{
+			continue;
+		}
+
+		DocumentDesc desc;
+		// as many indices as vertices, which make whole triangles
+		desc.NumFrames = 8;
+		desc.NumVertices = 42000;
+		desc.NumMeshes = 2;
+		desc.IndicesInterval = 5;
+
+		PlayerOptions options;
+		options.NumDecompressionTasks = 4;
+		ApplyEncodingCase(EncodingCases[iCase], desc, options);
+
+		// mapped and plain sources alternate from one case to the next
+		const bool bPlayed = PlayThrough(desc, options, bMapped);
+		if (!bPlayed)
+		{
+			printf("encoding case %u\n", iCase);
+		}
+
+		KIMURA_CHECK(bPlayed);
+		bMapped = !bMapped;
+	}
+}
+
+KIMURA_TEST(RefuseBrokenStreams)
+{
+	const BrokenDocument documents[] =
+	{
+		// Zstd is only decoded through PlayerOptions::StreamDecoder, and unknown codecs
+		{ StreamEncoding::Raw, StreamEncoding::Raw, [](DocumentDesc& InOutDesc) { InOutDesc.Codec = StreamCodec::Zstd; }, nullptr },
+		{ StreamEncoding::Raw, StreamEncoding::Raw, BreakFrameMesh(2, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamPositions].Codec = (StreamCodec)7; }),
+			"Streams are compressed with an unsupported codec" },
+
+		// a predicted stream sized differently from the one it's predicted from, nothing to predict the first frame from,
+		// constant meshes that are never predicted, and unknown encodings
+		{ StreamEncoding::Raw, StreamEncoding::Delta, BreakFrameMesh(3, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamPositions].Size -= 12; }),
+			"Predicted streams don't match the size of the previous frame's" },
+		{ StreamEncoding::Raw, StreamEncoding::Delta, BreakFrameMesh(0, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamPositions].Encoding = StreamEncoding::Delta; }), nullptr },
+		{ StreamEncoding::Raw, StreamEncoding::Delta, BreakFrameMesh(0, 1, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamPositions].Encoding = StreamEncoding::Linear; }), nullptr },
+		{ StreamEncoding::Raw, StreamEncoding::Delta, BreakFrameMesh(5, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamPositions].Encoding = (StreamEncoding)42; }),
+			"Streams are encoded with an unsupported prediction" },
+
+		// a sparse stream applied to a frame with another number of vertices, and nothing to apply the first frame's
+		// changes to
+		{ StreamEncoding::Raw, StreamEncoding::Sparse, BreakFrameMesh(4, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.NumVertices--; }),
+			"Sparse streams don't match the vertices of the previous frame" },
+		{ StreamEncoding::Raw, StreamEncoding::Sparse, BreakFrameMesh(0, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamPositions].Encoding = StreamEncoding::Sparse; }), nullptr },
+
+		// a basis past the end of the file, or so far that its position overflows, and frames storing a coefficient for
+		// fewer vectors than the basis has
+		{ StreamEncoding::Raw, StreamEncoding::Basis, BreakMesh([](TestMesh& InOutMesh) { InOutMesh.BasisPosition = 1ull << 40; }), "Mesh basis lies past the end of the file" },
+		{ StreamEncoding::Raw, StreamEncoding::Basis, BreakMesh([](TestMesh& InOutMesh) { InOutMesh.BasisPosition = ~0ull - 16; }), "Mesh basis lies past the end of the file" },
+		{ StreamEncoding::Raw, StreamEncoding::Basis, BreakMesh([](TestMesh& InOutMesh) { InOutMesh.NumBasisVectors++; InOutMesh.BasisErrors.push_back(0.0f); }),
+			"Basis stream doesn't match the mesh's basis" },
+
+		// streams of these encodings aren't compressed, triangles are indices, and streams that don't decode fail the
+		// player
+		{ StreamEncoding::Triangles, StreamEncoding::BytePlanes, BreakFrameMesh(2, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamIndices].Codec = StreamCodec::LZ4; }),
+			"Triangles stream doesn't match the mesh's indices" },
+		{ StreamEncoding::Triangles, StreamEncoding::BytePlanes, BreakFrameMesh(2, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamPositions].Codec = StreamCodec::LZ4; }),
+			"Byte planes stream doesn't match the mesh's vertices" },
+		{ StreamEncoding::Triangles, StreamEncoding::BytePlanes, BreakFrameMesh(2, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamPositions].Encoding = StreamEncoding::Triangles; }),
+			"Triangles stream doesn't match the mesh's indices" },
+		{ StreamEncoding::Triangles, StreamEncoding::BytePlanes, BreakFrameMesh(2, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamIndices].Size -= 2; }),
+			"Triangles stream doesn't match the mesh's indices" },
+		{ StreamEncoding::Triangles, StreamEncoding::BytePlanes, BreakFrameMesh(2, 0, [](TestFrameMesh& InOutFrameMesh) { InOutFrameMesh.Streams[StreamPositions].StoredSize -= 1; }),
+			"Failed to decompress frame data" }
+	};
+
+	for (const BrokenDocument& document : documents)
+	{
+		DocumentDesc desc;
+		desc.NumFrames = 8;
+		desc.NumVertices = 300;
+		desc.NumMeshes = 2;
+		desc.ConstantMesh = 1;
+		desc.IndicesInterval = 1;
+		desc.Codec = StreamCodec::LZ4;
+		desc.IndexEncoding = document.IndexEncoding;
+		desc.PositionEncoding = document.PositionEncoding;
+
+		if (document.PositionEncoding == StreamEncoding::Sparse)
+		{
+			desc.PositionValue = GetPartiallyAnimatedPosition;
+		}
+
+		KIMURA_CHECK(GetOpenFailure(WriteDocument(desc)).empty());
+
+		document.Break(desc);
+
+		const std::string failure = GetOpenFailure(WriteDocument(desc));
+		KIMURA_CHECK(document.Failure != nullptr ? failure == document.Failure : !failure.empty());
+	}
+}
+
+KIMURA_TEST(FailOnCorruptedCompressedStreams)
+{
+	// the stored size of a stream is off, which its decompression catches
+	DocumentDesc desc;
+	desc.NumFrames = 6;
+	desc.NumVertices = 300;
+	desc.VariedPositions = true;
+	desc.Codec = StreamCodec::LZ4;
+	desc.EditFrameMesh = [](uint32 InFrame, uint32, TestFrameMesh& InOutFrameMesh)
+	{
+		if (InFrame == 3)
+		{
+			InOutFrameMesh.Streams[StreamPositions].StoredSize -= 4;
+		}
+	};
+
+	for (bool bMapped : { false, true })
+	{
+		uint64 frameDataPosition = 0;
+		std::vector<byte> document = WriteDocument(desc, &frameDataPosition);
+		std::shared_ptr<IByteSource> source = bMapped ? std::shared_ptr<IByteSource>(std::make_shared<MappedByteSource>(document, frameDataPosition)) : std::make_shared<PlainByteSource>(std::move(document));
+
+		// the frame is never handed out, and fails the player
+		std::shared_ptr<IPlayer> player = OpenDocument(source, PlayerOptions());
+		KIMURA_CHECK(player->GetFrameAt(3, std::chrono::steady_clock::now() + std::chrono::seconds(2)) == nullptr);
+		KIMURA_CHECK(player->GetStatus() == PlayerStatus::Failed);
+
+		std::string message;
+		player->GetFailStatusMessage(message);
+		KIMURA_CHECK(message == "Failed to decompress frame data");
+	}
+}
@@ -0,0 +1,850 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "Tests.h"
+#include "TestEncoders.h"
+#include "Player.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace Kimura;
+using namespace Kimura::Tests;
+
+namespace
+{
+	// bytes written past the end of an output fail the tests
+	const byte		Canary = 0xcd;
+	const uint64	NumCanaryBytes = 64;
+
+	bool IsIntact(const std::vector<byte>& InOutput, uint64 InSize)
+	{
+		for (uint64 i = InSize; i < InOutput.size(); i++)
+		{
+			if (InOutput[i] != Canary)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// data shaped like the streams of a frame: runs, repeated patterns, floats and noise
+	std::vector<std::vector<byte>> GetLZ4Samples()
+	{
+		std::mt19937 random(1);
+		std::vector<std::vector<byte>> samples;
+
+		samples.push_back({});
+		samples.push_back({ 42 });
+		samples.push_back(std::vector<byte>(12, 7));
+		samples.push_back(std::vector<byte>(13, 7));
+		samples.push_back(std::vector<byte>(100000, 0));
+
+		// short repeated patterns, which decode as overlapping matches
+		for (uint32 period : { 2u, 3u, 5u, 7u, 8u, 17u })
+		{
+			std::vector<byte> sample(5000);
+			for (size_t i = 0; i < sample.size(); i++)
+			{
+				sample[i] = (byte)(i % period * 31);
+			}
+
+			samples.push_back(sample);
+		}
+
+		std::vector<byte> floats(60000 * 4);
+		for (size_t i = 0; i < floats.size() / 4; i++)
+		{
+			const float value = (float)(((i * 2654435761u) >> 24) & 63) * 0.25f;
+			memcpy(&floats[i * 4], &value, 4);
+		}
+
+		samples.push_back(floats);
+
+		std::vector<byte> noise(20000);
+		for (byte& value : noise)
+		{
+			value = (byte)random();
+		}
+
+		samples.push_back(noise);
+
+		// long literals and matches, which take several length bytes
+		std::vector<byte> mixed(700 + 3000 + 700 + 300, 9);
+		memcpy(&mixed[0], &noise[0], 700);
+		memcpy(&mixed[3700], &noise[0], 700);
+		memcpy(&mixed[4400], &noise[5000], 300);
+		samples.push_back(mixed);
+
+		return samples;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// DecodeLZ4
+//-----------------------------------------------------------------------------
+KIMURA_TEST(DecodeLZ4RoundTrip)
+{
+	for (const std::vector<byte>& sample : GetLZ4Samples())
+	{
+		const std::vector<byte> encoded = EncodeLZ4(sample.data(), sample.size());
+
+		std::vector<byte> decoded(sample.size() + NumCanaryBytes, Canary);
+		KIMURA_CHECK(DecodeLZ4(encoded.data(), encoded.size(), decoded.data(), sample.size()));
+		KIMURA_CHECK(sample.empty() || memcmp(decoded.data(), sample.data(), sample.size()) == 0);
+		KIMURA_CHECK(IsIntact(decoded, sample.size()));
+	}
+}
+
+KIMURA_TEST(DecodeLZ4WrongSize)
+{
+	for (const std::vector<byte>& sample : GetLZ4Samples())
+	{
+		const std::vector<byte> encoded = EncodeLZ4(sample.data(), sample.size());
+
+		// data decoding to more or less than expected
+		std::vector<byte> decoded(sample.size() + 1 + NumCanaryBytes, Canary);
+		KIMURA_CHECK(!DecodeLZ4(encoded.data(), encoded.size(), decoded.data(), sample.size() + 1));
+		KIMURA_CHECK(IsIntact(decoded, sample.size() + 1));
+
+		if (!sample.empty())
+		{
+			std::fill(decoded.begin(), decoded.end(), Canary);
+			KIMURA_CHECK(!DecodeLZ4(encoded.data(), encoded.size(), decoded.data(), sample.size() - 1));
+			KIMURA_CHECK(IsIntact(decoded, sample.size() - 1));
+		}
+	}
+}
+
+KIMURA_TEST(DecodeLZ4Truncated)
+{
+	for (const std::vector<byte>& sample : GetLZ4Samples())
+	{
+		if (sample.empty())
+		{
+			continue;
+		}
+
+		const std::vector<byte> encoded = EncodeLZ4(sample.data(), sample.size());
+		std::vector<byte> decoded(sample.size() + NumCanaryBytes, Canary);
+
+		// the truncated data is copied so that reading past its end doesn't go unnoticed under ASan
+		for (size_t size = 0; size < encoded.size(); size += 1 + encoded.size() / 200)
+		{
+			const std::vector<byte> truncated(encoded.begin(), encoded.begin() + size);
+
+			KIMURA_CHECK(!DecodeLZ4(truncated.data(), truncated.size(), decoded.data(), sample.size()));
+			KIMURA_CHECK(IsIntact(decoded, sample.size()));
+		}
+	}
+}
+
+KIMURA_TEST(DecodeLZ4Corrupted)
+{
+	std::mt19937 random(2);
+
+	for (const std::vector<byte>& sample : GetLZ4Samples())
+	{
+		const std::vector<byte> encoded = EncodeLZ4(sample.data(), sample.size());
+		std::vector<byte> decoded(sample.size() + NumCanaryBytes, Canary);
+
+		// flipped bits either fail or decode to something else, within bounds
+		for (uint32 i = 0; i < 300; i++)
+		{
+			std::vector<byte> corrupted = encoded;
+			corrupted[random() % corrupted.size()] ^= (byte)(1 << (random() % 8));
+
+			DecodeLZ4(corrupted.data(), corrupted.size(), decoded.data(), sample.size());
+			KIMURA_CHECK(IsIntact(decoded, sample.size()));
+		}
+	}
+
+	// a match reaching before the start of the output
+	const byte matchBeforeStart[] = { 0x10, 'a', 2, 0, 0x10, 'b' };
+	byte decoded[8];
+	KIMURA_CHECK(!DecodeLZ4(matchBeforeStart, sizeof(matchBeforeStart), decoded, 6));
+
+	// a match at offset 0
+	const byte matchAtZero[] = { 0x10, 'a', 0, 0, 0x10, 'b' };
+	KIMURA_CHECK(!DecodeLZ4(matchAtZero, sizeof(matchAtZero), decoded, 6));
+
+	// a literal length running past the end of the data
+	const byte longLiterals[] = { 0xf0, 255, 255 };
+	KIMURA_CHECK(!DecodeLZ4(longLiterals, sizeof(longLiterals), decoded, 8));
+}
+
+
+//-----------------------------------------------------------------------------
+// ReconstructStream
+//-----------------------------------------------------------------------------
+namespace
+{
+	// components added one at a time, wrapping around
+	template<typename T>
+	void ReconstructReference(StreamEncoding InEncoding, const byte* InResiduals, const byte* InPrevious, const byte* InBeforePrevious, byte* OutData, uint64 InSize)
+	{
+		for (uint64 i = 0; i + sizeof(T) <= InSize; i += sizeof(T))
+		{
+			T residual, previous, beforePrevious;
+			memcpy(&residual, &InResiduals[i], sizeof(T));
+			memcpy(&previous, &InPrevious[i], sizeof(T));
+			memcpy(&beforePrevious, &InBeforePrevious[i], sizeof(T));
+
+			const T prediction = InEncoding == StreamEncoding::Linear ? (T)(previous + previous - beforePrevious) : previous;
+			const T value = (T)(residual + prediction);
+			memcpy(&OutData[i], &value, sizeof(T));
+		}
+	}
+
+	void ReconstructReference(StreamEncoding InEncoding, uint32 InComponentSize, const byte* InResiduals, const byte* InPrevious, const byte* InBeforePrevious, byte* OutData, uint64 InSize)
+	{
+		switch (InComponentSize)
+		{
+			case 4:		ReconstructReference<uint32>(InEncoding, InResiduals, InPrevious, InBeforePrevious, OutData, InSize); break;
+			case 2:		ReconstructReference<uint16>(InEncoding, InResiduals, InPrevious, InBeforePrevious, OutData, InSize); break;
+			default:	ReconstructReference<uint8>(InEncoding, InResiduals, InPrevious, InBeforePrevious, OutData, InSize); break;
+		}
+	}
+
+	std::vector<byte> GetRandomBytes(std::mt19937& InOutRandom, uint64 InSize)
+	{
+		std::vector<byte> bytes((size_t)InSize);
+		for (byte& value : bytes)
+		{
+			value = (byte)InOutRandom();
+		}
+
+		return bytes;
+	}
+
+	// numbers of components around the 16 bytes of the SIMD code paths, and large streams
+	const uint64 ReconstructCounts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 65, 1000, 180000 };
+}
+
+KIMURA_TEST(ReconstructStreamMatchesReference)
+{
+	std::mt19937 random(3);
+
+	for (StreamEncoding encoding : { StreamEncoding::Delta, StreamEncoding::Linear })
+	{
+		for (uint32 componentSize : { 1u, 2u, 4u })
+		{
+			for (uint64 count : ReconstructCounts)
+			{
+				const uint64 size = count * componentSize;
+
+				// unaligned streams, as they lie in a frame's buffer
+				for (uint64 offset : { 0ull, 1ull, 2ull })
+				{
+					const std::vector<byte> residuals = GetRandomBytes(random, size + offset);
+					const std::vector<byte> previous = GetRandomBytes(random, size + offset);
+					const std::vector<byte> beforePrevious = GetRandomBytes(random, size + offset);
+
+					std::vector<byte> expected(size);
+					ReconstructReference(encoding, componentSize, residuals.data() + offset, previous.data() + offset, beforePrevious.data() + offset, expected.data(), size);
+
+					std::vector<byte> reconstructed(size + offset + NumCanaryBytes, Canary);
+					ReconstructStream(encoding, componentSize, residuals.data() + offset, previous.data() + offset, beforePrevious.data() + offset, reconstructed.data() + offset, size);
+
+					KIMURA_CHECK(size == 0 || memcmp(reconstructed.data() + offset, expected.data(), (size_t)size) == 0);
+					KIMURA_CHECK(IsIntact(reconstructed, size + offset));
+				}
+			}
+		}
+	}
+}
+
+KIMURA_TEST(ReconstructStreamInPlace)
+{
+	std::mt19937 random(4);
+
+	for (StreamEncoding encoding : { StreamEncoding::Delta, StreamEncoding::Linear })
+	{
+		for (uint32 componentSize : { 1u, 2u, 4u })
+		{
+			for (uint64 count : ReconstructCounts)
+			{
+				const uint64 size = count * componentSize;
+
+				std::vector<byte> residuals = GetRandomBytes(random, size);
+				const std::vector<byte> previous = GetRandomBytes(random, size);
+				const std::vector<byte> beforePrevious = GetRandomBytes(random, size);
+
+				std::vector<byte> expected(size);
+				ReconstructReference(encoding, componentSize, residuals.data(), previous.data(), beforePrevious.data(), expected.data(), size);
+
+				// the decoded residuals are replaced by the stream
+				ReconstructStream(encoding, componentSize, residuals.data(), previous.data(), beforePrevious.data(), residuals.data(), size);
+				KIMURA_CHECK(residuals == expected);
+			}
+		}
+	}
+}
+
+KIMURA_TEST(ReconstructStreamWrapsAround)
+{
+	// full precision floats are predicted as integers, which takes them back exactly whatever their bits
+	const float values[] = { 0.0f, -0.0f, 1.0f, -1.0f, 3.4e38f, -3.4e38f, 1e-45f, 123.456f };
+	const uint32 numValues = sizeof(values) / sizeof(values[0]);
+
+	for (uint32 iPrevious = 0; iPrevious < numValues; iPrevious++)
+	{
+		std::vector<float> previous(numValues * 4), stream(numValues * 4);
+		std::vector<uint32> residuals(numValues * 4);
+
+		for (uint32 i = 0; i < numValues * 4; i++)
+		{
+			previous[i] = values[(iPrevious + i) % numValues];
+			stream[i] = values[i % numValues];
+
+			uint32 a, b;
+			memcpy(&a, &stream[i], 4);
+			memcpy(&b, &previous[i], 4);
+			residuals[i] = a - b;
+		}
+
+		std::vector<float> reconstructed(numValues * 4);
+		ReconstructStream(StreamEncoding::Delta, 4, (const byte*)residuals.data(), (const byte*)previous.data(), nullptr, (byte*)reconstructed.data(), numValues * 16);
+
+		KIMURA_CHECK(memcmp(reconstructed.data(), stream.data(), numValues * 16) == 0);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// ApplySparseStream
+//-----------------------------------------------------------------------------
+namespace
+{
+	// the changes of a stream where every element has InChangeRate chances out of 100 to change, in runs
+	std::vector<byte> GetChangedStream(std::mt19937& InOutRandom, const std::vector<byte>& InPrevious, uint64 InElementSize, uint32 InChangeRate)
+	{
+		std::vector<byte> stream = InPrevious;
+
+		bool bChanging = false;
+		for (uint64 offset = 0; offset < stream.size(); offset += InElementSize)
+		{
+			// changes come in runs, like animated regions of a mesh
+			if (InOutRandom() % 100 < 20)
+			{
+				bChanging = InOutRandom() % 100 < InChangeRate;
+			}
+
+			for (uint64 i = 0; bChanging && i < InElementSize; i++)
+			{
+				stream[offset + i] ^= (byte)(1 + InOutRandom() % 255);
+			}
+		}
+
+		return stream;
+	}
+
+	std::vector<byte> MakeChanges(const std::vector<uint32>& InRuns, uint64 InNumValueBytes)
+	{
+		std::vector<byte> changes(4 + InRuns.size() * 4 + InNumValueBytes, 0x5a);
+
+		const uint32 numRuns = (uint32)(InRuns.size() / 2);
+		memcpy(changes.data(), &numRuns, 4);
+		if (!InRuns.empty())
+		{
+			memcpy(changes.data() + 4, InRuns.data(), InRuns.size() * 4);
+		}
+
+		return changes;
+	}
+}
+
+KIMURA_TEST(ApplySparseStreamRoundTrip)
+{
+	std::mt19937 random(5);
+
+	for (uint64 elementSize : { 1ull, 4ull, 6ull, 12ull })
+	{
+		for (uint64 numElements : { 1ull, 2ull, 17ull, 1000ull })
+		{
+			for (uint32 changeRate : { 0u, 10u, 50u, 100u })
+			{
+				const std::vector<byte> previous = GetRandomBytes(random, numElements * elementSize);
+				const std::vector<byte> stream = GetChangedStream(random, previous, elementSize, changeRate);
+				const std::vector<byte> changes = EncodeSparseStream(previous.data(), stream.data(), stream.size(), elementSize);
+
+				std::vector<byte> applied(stream.size() + NumCanaryBytes, Canary);
+				KIMURA_CHECK(ApplySparseStream(changes.data(), changes.size(), previous.data(), applied.data(), stream.size(), elementSize));
+				KIMURA_CHECK(memcmp(applied.data(), stream.data(), stream.size()) == 0);
+				KIMURA_CHECK(IsIntact(applied, stream.size()));
+			}
+		}
+	}
+}
+
+KIMURA_TEST(ApplySparseStreamOutOfBounds)
+{
+	const std::vector<byte> previous(10 * 12, 1);
+	std::vector<byte> applied(previous.size() + NumCanaryBytes, Canary);
+
+	auto apply = [&](const std::vector<byte>& InChanges)
+	{
+		std::fill(applied.begin(), applied.end(), Canary);
+
+		const bool bApplied = ApplySparseStream(InChanges.data(), InChanges.size(), previous.data(), applied.data(), previous.size(), 12);
+		KIMURA_CHECK(IsIntact(applied, previous.size()));
+
+		return bApplied;
+	};
+
+	// valid: the last element, and every element
+	KIMURA_CHECK(apply(MakeChanges({ 9, 1 }, 12)));
+	KIMURA_CHECK(apply(MakeChanges({ 0, 10 }, 120)));
+	KIMURA_CHECK(apply(MakeChanges({}, 0)));
+
+	// runs past the last element
+	KIMURA_CHECK(!apply(MakeChanges({ 10, 1 }, 12)));
+	KIMURA_CHECK(!apply(MakeChanges({ 9, 2 }, 24)));
+	KIMURA_CHECK(!apply(MakeChanges({ 0xffffffff, 1 }, 12)));
+	KIMURA_CHECK(!apply(MakeChanges({ 1, 0xffffffff }, 12)));
+
+	// overlapping, and out of order runs
+	KIMURA_CHECK(!apply(MakeChanges({ 2, 3, 4, 1 }, 48)));
+	KIMURA_CHECK(!apply(MakeChanges({ 5, 1, 2, 1 }, 24)));
+
+	// fewer or more values than the runs cover
+	KIMURA_CHECK(!apply(MakeChanges({ 2, 3 }, 35)));
+	KIMURA_CHECK(!apply(MakeChanges({ 2, 3 }, 37)));
+
+	// more runs than the changes hold
+	std::vector<byte> tooManyRuns = MakeChanges({ 2, 3 }, 36);
+	const uint32 numRuns = 0x20000000;
+	memcpy(tooManyRuns.data(), &numRuns, 4);
+	KIMURA_CHECK(!apply(tooManyRuns));
+
+	// shorter than the number of runs, and elements without a size
+	KIMURA_CHECK(!apply(std::vector<byte>(3, 0)));
+	const std::vector<byte> empty = MakeChanges({}, 0);
+	KIMURA_CHECK(!ApplySparseStream(empty.data(), empty.size(), previous.data(), applied.data(), previous.size(), 0));
+}
+
+KIMURA_TEST(ApplySparseStreamTruncated)
+{
+	std::mt19937 random(6);
+
+	const std::vector<byte> previous = GetRandomBytes(random, 500 * 12);
+	const std::vector<byte> stream = GetChangedStream(random, previous, 12, 30);
+	const std::vector<byte> changes = EncodeSparseStream(previous.data(), stream.data(), stream.size(), 12);
+
+	std::vector<byte> applied(stream.size() + NumCanaryBytes, Canary);
+
+	for (size_t size = 0; size < changes.size(); size++)
+	{
+		const std::vector<byte> truncated(changes.begin(), changes.begin() + size);
+
+		KIMURA_CHECK(!ApplySparseStream(truncated.data(), truncated.size(), previous.data(), applied.data(), stream.size(), 12));
+		KIMURA_CHECK(IsIntact(applied, stream.size()));
+	}
+
+	// flipped bits either fail or apply other changes, within bounds
+	for (uint32 i = 0; i < 1000; i++)
+	{
+		std::vector<byte> corrupted = changes;
+		corrupted[random() % corrupted.size()] ^= (byte)(1 << (random() % 8));
+
+		ApplySparseStream(corrupted.data(), corrupted.size(), previous.data(), applied.data(), stream.size(), 12);
+		KIMURA_CHECK(IsIntact(applied, stream.size()));
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// ReconstructFromBasis
+//-----------------------------------------------------------------------------
+namespace
+{
+	MeshBasis GetRandomBasis(std::mt19937& InOutRandom, uint32 InNumVectors, uint64 InNumVertices)
+	{
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+		MeshBasis basis;
+		basis.NumVectors = InNumVectors;
+		basis.NumFloats = InNumVertices * 3;
+		basis.Data.resize((size_t)((InNumVectors + 1) * basis.NumFloats));
+
+		for (float& value : basis.Data)
+		{
+			value = distribution(InOutRandom);
+		}
+
+		return basis;
+	}
+
+	// mean plus each vector in turn, in single precision like the decoder, which must match it exactly
+	std::vector<float> ReconstructBasisReference(const MeshBasis& InBasis, const std::vector<float>& InCoefficients, uint64 InFirstVertex, uint64 InNumVertices)
+	{
+		std::vector<float> positions(InBasis.Data.begin() + InFirstVertex * 3, InBasis.Data.begin() + (InFirstVertex + InNumVertices) * 3);
+
+		for (uint32 iVector = 0; iVector < InBasis.NumVectors; iVector++)
+		{
+			for (uint64 i = 0; i < positions.size(); i++)
+			{
+				positions[i] += InCoefficients[iVector] * InBasis.Data[(iVector + 1) * InBasis.NumFloats + InFirstVertex * 3 + i];
+			}
+		}
+
+		return positions;
+	}
+
+	std::vector<int16> QuantizeReference(const std::vector<float>& InPositions, const Vector3& InCenter, const Vector3& InExtents)
+	{
+		const float center[3] = { InCenter.X, InCenter.Y, InCenter.Z };
+		const float extents[3] = { InExtents.X, InExtents.Y, InExtents.Z };
+
+		std::vector<int16> quantized(InPositions.size());
+		for (size_t i = 0; i < InPositions.size(); i++)
+		{
+			const float scale = extents[i % 3] != 0.0f ? 32767.0f / extents[i % 3] : 0.0f;
+			quantized[i] = (int16)std::max(-32767.0f, std::min(32767.0f, std::nearbyint((InPositions[i] - center[i % 3]) * scale)));
+		}
+
+		return quantized;
+	}
+
+	// vertex counts around the SIMD widths (4 floats, 4 positions) and the blocks of 512 positions
+	const uint64 BasisVertexCounts[] = { 1, 2, 3, 4, 5, 7, 8, 511, 512, 513, 1100 };
+}
+
+KIMURA_TEST(ReconstructFromBasisMatchesReference)
+{
+	std::mt19937 random(8);
+
+	for (uint32 numVectors : { 0u, 1u, 3u, 16u })
+	{
+		for (uint64 numVertices : BasisVertexCounts)
+		{
+			const MeshBasis basis = GetRandomBasis(random, numVectors, numVertices + 9);
+
+			std::vector<float> coefficients(numVectors);
+			for (float& coefficient : coefficients)
+			{
+				coefficient = (float)(random() % 2001) / 1000.0f - 1.0f;
+			}
+
+			// coefficients are read unaligned from the frame's data
+			std::vector<byte> storedCoefficients(1 + numVectors * sizeof(float));
+			if (numVectors > 0)
+			{
+				memcpy(&storedCoefficients[1], coefficients.data(), numVectors * sizeof(float));
+			}
+
+			for (uint64 firstVertex : { 0ull, 1ull, 9ull })
+			{
+				const std::vector<float> expected = ReconstructBasisReference(basis, coefficients, firstVertex, numVertices);
+
+				std::vector<byte> positions(numVertices * 12 + NumCanaryBytes, Canary);
+				ReconstructFromBasis(basis, &storedCoefficients[1], firstVertex, numVertices, PositionFormat::Full, Vector3(), Vector3(1.0f, 1.0f, 1.0f), positions.data());
+				KIMURA_CHECK(memcmp(positions.data(), expected.data(), numVertices * 12) == 0);
+				KIMURA_CHECK(IsIntact(positions, numVertices * 12));
+
+				// positions past the extents are clamped
+				const Vector3 center(0.25f, -0.5f, 0.0f);
+				const Vector3 extents(2.0f, 0.5f, 64.0f);
+				const std::vector<int16> expectedQuantized = QuantizeReference(expected, center, extents);
+
+				std::vector<byte> quantized(numVertices * 6 + NumCanaryBytes, Canary);
+				ReconstructFromBasis(basis, &storedCoefficients[1], firstVertex, numVertices, PositionFormat::Half, center, extents, quantized.data());
+				KIMURA_CHECK(memcmp(quantized.data(), expectedQuantized.data(), numVertices * 6) == 0);
+				KIMURA_CHECK(IsIntact(quantized, numVertices * 6));
+			}
+		}
+	}
+}
+
+KIMURA_TEST(ReconstructFromBasisPrecision)
+{
+	std::mt19937 random(9);
+
+	const uint64 numVertices = 2000;
+	const MeshBasis basis = GetRandomBasis(random, 16, numVertices);
+	const std::vector<float> coefficients(16, 0.75f);
+
+	std::vector<float> positions(numVertices * 3);
+	ReconstructFromBasis(basis, (const byte*)coefficients.data(), 0, numVertices, PositionFormat::Full, Vector3(), Vector3(1.0f, 1.0f, 1.0f), (byte*)positions.data());
+
+	for (uint64 i = 0; i < positions.size(); i++)
+	{
+		double expected = basis.Data[i];
+		for (uint32 iVector = 0; iVector < basis.NumVectors; iVector++)
+		{
+			expected += (double)coefficients[iVector] * basis.Data[(iVector + 1) * basis.NumFloats + i];
+		}
+
+		KIMURA_CHECK(std::fabs(positions[i] - expected) < 1e-4);
+	}
+}
+
+KIMURA_TEST(ReconstructFromBasisZeroExtents)
+{
+	std::mt19937 random(10);
+
+	const MeshBasis basis = GetRandomBasis(random, 2, 100);
+	const std::vector<float> coefficients = { 0.5f, -2.0f };
+
+	// flat along Y
+	std::vector<int16> quantized(300);
+	ReconstructFromBasis(basis, (const byte*)coefficients.data(), 0, 100, PositionFormat::Half, Vector3(), Vector3(4.0f, 0.0f, 4.0f), (byte*)quantized.data());
+
+	const std::vector<int16> expected = QuantizeReference(ReconstructBasisReference(basis, coefficients, 0, 100), Vector3(), Vector3(4.0f, 0.0f, 4.0f));
+	KIMURA_CHECK(quantized == expected);
+
+	for (size_t i = 1; i < quantized.size(); i += 3)
+	{
+		KIMURA_CHECK(quantized[i] == 0);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// DecodeTriangles
+//-----------------------------------------------------------------------------
+namespace
+{
+	// triangles of a grid of InWidth by InHeight vertices
+	std::vector<uint32> GetGridIndices(uint32 InWidth, uint32 InHeight)
+	{
+		std::vector<uint32> indices;
+		for (uint32 y = 0; y + 1 < InHeight; y++)
+		{
+			for (uint32 x = 0; x + 1 < InWidth; x++)
+			{
+				const uint32 a = y * InWidth + x;
+				indices.insert(indices.end(), { a, a + InWidth, a + 1, a + 1, a + InWidth, a + InWidth + 1 });
+			}
+		}
+
+		return indices;
+	}
+
+	// grids, random triangles, and a few triangles reusing the same vertices
+	std::vector<std::vector<uint32>> GetTriangleSamples(std::mt19937& InOutRandom, uint32 InIndexSize)
+	{
+		std::vector<std::vector<uint32>> samples;
+		samples.push_back(GetGridIndices(50, 40));
+
+		std::vector<uint32> random(3000);
+		for (uint32& index : random)
+		{
+			index = InOutRandom() % (InIndexSize == 2 ? 65536 : 1000000);
+		}
+		samples.push_back(random);
+
+		std::vector<uint32> small;
+		for (uint32 i = 0; i < 21; i++)
+		{
+			small.push_back(i % 5);
+		}
+		samples.push_back(small);
+
+		samples.push_back(std::vector<uint32>());
+		return samples;
+	}
+
+	uint32 GetIndex(const std::vector<byte>& InIndices, size_t InIndex, uint32 InIndexSize)
+	{
+		if (InIndexSize == 2)
+		{
+			uint16 index;
+			memcpy(&index, &InIndices[InIndex * 2], 2);
+			return index;
+		}
+
+		uint32 index;
+		memcpy(&index, &InIndices[InIndex * 4], 4);
+		return index;
+	}
+
+	// the same triangles, rotated when InRotated is set
+	bool AreSameTriangles(const std::vector<byte>& InDecoded, const std::vector<uint32>& InIndices, uint32 InIndexSize, bool InRotated)
+	{
+		for (size_t iTriangle = 0; iTriangle < InIndices.size() / 3; iTriangle++)
+		{
+			bool bFound = false;
+			for (uint32 rotation = 0; rotation < (InRotated ? 3u : 1u) && !bFound; rotation++)
+			{
+				bFound = true;
+				for (uint32 i = 0; i < 3; i++)
+				{
+					bFound &= GetIndex(InDecoded, iTriangle * 3 + (rotation + i) % 3, InIndexSize) == InIndices[iTriangle * 3 + i];
+				}
+			}
+
+			if (!bFound)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+KIMURA_TEST(DecodeTrianglesRoundTrip)
+{
+	std::mt19937 random(11);
+
+	for (uint32 indexSize : { 2u, 4u })
+	{
+		for (const std::vector<uint32>& indices : GetTriangleSamples(random, indexSize))
+		{
+			for (bool bRotate : { false, true })
+			{
+				const std::vector<byte> encoded = EncodeTriangles(indices, bRotate);
+				const uint64 size = indices.size() * indexSize;
+
+				std::vector<byte> decoded(size + NumCanaryBytes, Canary);
+				KIMURA_CHECK(DecodeTriangles(encoded.data(), encoded.size(), decoded.data(), size, indexSize));
+				KIMURA_CHECK(AreSameTriangles(decoded, indices, indexSize, bRotate));
+				KIMURA_CHECK(IsIntact(decoded, size));
+
+				// sized for fewer triangles, or for partial triangles
+				KIMURA_CHECK(indices.empty() || !DecodeTriangles(encoded.data(), encoded.size(), decoded.data(), size - 3 * indexSize, indexSize));
+				KIMURA_CHECK(!DecodeTriangles(encoded.data(), encoded.size(), decoded.data(), size + indexSize, indexSize));
+				KIMURA_CHECK(IsIntact(decoded, size + indexSize));
+			}
+		}
+	}
+
+	// indices are 16 or 32 bits
+	const std::vector<byte> encoded = EncodeTriangles({ 0, 1, 2 }, false);
+	byte decoded[12];
+	KIMURA_CHECK(!DecodeTriangles(encoded.data(), encoded.size(), decoded, 3, 1));
+	KIMURA_CHECK(!DecodeTriangles(encoded.data(), encoded.size(), decoded, 0, 0));
+}
+
+KIMURA_TEST(DecodeTrianglesTruncated)
+{
+	std::mt19937 random(12);
+
+	for (uint32 indexSize : { 2u, 4u })
+	{
+		for (const std::vector<uint32>& indices : GetTriangleSamples(random, indexSize))
+		{
+			const std::vector<byte> encoded = EncodeTriangles(indices, true);
+			const uint64 size = indices.size() * indexSize;
+
+			std::vector<byte> decoded(size + NumCanaryBytes, Canary);
+
+			for (size_t truncatedSize = 0; truncatedSize < encoded.size(); truncatedSize++)
+			{
+				const std::vector<byte> truncated(encoded.begin(), encoded.begin() + truncatedSize);
+				KIMURA_CHECK(!DecodeTriangles(truncated.data(), truncated.size(), decoded.data(), size, indexSize));
+				KIMURA_CHECK(IsIntact(decoded, size));
+			}
+
+			// flipped bits either fail or decode other triangles, within bounds
+			for (uint32 i = 0; i < 200 && !encoded.empty(); i++)
+			{
+				std::vector<byte> corrupted = encoded;
+				corrupted[random() % corrupted.size()] ^= (byte)(1 << (random() % 8));
+
+				DecodeTriangles(corrupted.data(), corrupted.size(), decoded.data(), size, indexSize);
+				KIMURA_CHECK(IsIntact(decoded, size));
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// DecodeBytePlanes
+//-----------------------------------------------------------------------------
+namespace
+{
+	// vertex sizes of the common attributes and of the SIMD paths' 8 planes, and vertex counts around the groups of
+	// 16 vertices and the blocks
+	const uint32 BytePlanesVertexSizes[] = { 1, 3, 4, 6, 8, 12, 16, 20, 64 };
+	const uint64 BytePlanesVertexCounts[] = { 1, 15, 16, 17, 255, 256, 257, 1000, 5000 };
+
+	// vertices varying smoothly from one to the next like sorted positions, or noise
+	std::vector<byte> GetVertices(std::mt19937& InOutRandom, uint64 InNumVertices, uint32 InVertexSize, bool InSmooth)
+	{
+		std::vector<byte> vertices(InNumVertices * InVertexSize);
+		for (uint64 i = 0; i < InNumVertices; i++)
+		{
+			for (uint32 iPlane = 0; iPlane < InVertexSize; iPlane++)
+			{
+				vertices[i * InVertexSize + iPlane] = InSmooth ? (byte)(i * (iPlane + 1) / 7 + iPlane) : (byte)InOutRandom();
+			}
+		}
+
+		return vertices;
+	}
+}
+
+KIMURA_TEST(DecodeBytePlanesRoundTrip)
+{
+	std::mt19937 random(13);
+
+	for (uint32 vertexSize : BytePlanesVertexSizes)
+	{
+		for (uint64 numVertices : BytePlanesVertexCounts)
+		{
+			for (bool bSmooth : { false, true })
+			{
+				const std::vector<byte> vertices = GetVertices(random, numVertices, vertexSize, bSmooth);
+				const std::vector<byte> encoded = EncodeBytePlanes(vertices.data(), numVertices, vertexSize);
+
+				std::vector<byte> decoded(vertices.size() + NumCanaryBytes, Canary);
+				KIMURA_CHECK(DecodeBytePlanes(encoded.data(), encoded.size(), decoded.data(), vertices.size(), vertexSize));
+				KIMURA_CHECK(memcmp(decoded.data(), vertices.data(), vertices.size()) == 0);
+				KIMURA_CHECK(IsIntact(decoded, vertices.size()));
+
+				// sized for a partial vertex. Groups are padded to 16 vertices, other vertex counts aren't always detected.
+				KIMURA_CHECK(vertexSize == 1 || !DecodeBytePlanes(encoded.data(), encoded.size(), decoded.data(), vertices.size() + 1, vertexSize));
+				KIMURA_CHECK(IsIntact(decoded, vertices.size() + 1));
+			}
+		}
+	}
+
+	// vertices are 1 to MaxBytePlanes bytes
+	KIMURA_CHECK(!DecodeBytePlanes(nullptr, 0, nullptr, (MaxBytePlanes + 1) * 4, MaxBytePlanes + 1));
+	KIMURA_CHECK(!DecodeBytePlanes(nullptr, 0, nullptr, 0, 0));
+}
+
+KIMURA_TEST(DecodeBytePlanesTruncated)
+{
+	std::mt19937 random(14);
+
+	for (uint32 vertexSize : { 1u, 6u, 12u, 20u })
+	{
+		for (uint64 numVertices : { 17ull, 300ull })
+		{
+			const std::vector<byte> vertices = GetVertices(random, numVertices, vertexSize, true);
+			const std::vector<byte> encoded = EncodeBytePlanes(vertices.data(), numVertices, vertexSize);
+
+			std::vector<byte> decoded(vertices.size() + NumCanaryBytes, Canary);
+
+			for (size_t size = 0; size < encoded.size(); size++)
+			{
+				const std::vector<byte> truncated(encoded.begin(), encoded.begin() + size);
+				KIMURA_CHECK(!DecodeBytePlanes(truncated.data(), truncated.size(), decoded.data(), vertices.size(), vertexSize));
+				KIMURA_CHECK(IsIntact(decoded, vertices.size()));
+			}
+
+			// flipped bits either fail or decode other vertices, within bounds
+			for (uint32 i = 0; i < 200; i++)
+			{
+				std::vector<byte> corrupted = encoded;
+				corrupted[random() % corrupted.size()] ^= (byte)(1 << (random() % 8));
+
+				DecodeBytePlanes(corrupted.data(), corrupted.size(), decoded.data(), vertices.size(), vertexSize);
+				KIMURA_CHECK(IsIntact(decoded, vertices.size()));
+			}
+		}
+	}
+}
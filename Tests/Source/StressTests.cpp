@@ -0,0 +1,131 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+// Players used from several threads at once, like a game would. Short enough to run with the other tests, and meant
+// to be run under ThreadSanitizer as well (KIMURA_SANITIZER=thread).
+//
+
+#include "Tests.h"
+#include "TestDocument.h"
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+using namespace Kimura;
+using namespace Kimura::Tests;
+
+KIMURA_TEST(StressSharedBudget)
+{
+	DocumentDesc desc;
+	desc.NumFrames = 200;
+	desc.NumVertices = 2000;
+	desc.IndicesInterval = 30;
+
+	// read from a file, through the synchronous and queued reads. Each build has its own, they may run at once.
+	const char* path = IsUsingSIMD() ? "KimuraStressTests.kimura" : "KimuraStressTestsScalar.kimura";
+	{
+		const std::vector<byte> document = WriteDocument(desc);
+
+		FILE* file = fopen(path, "wb");
+		KIMURA_CHECK(file != nullptr && fwrite(document.data(), 1, document.size(), file) == document.size());
+		if (file == nullptr || fclose(file) != 0)
+		{
+			return;
+		}
+	}
+
+	// a budget short of what the players would buffer, trimmed by another thread
+	std::shared_ptr<IMemoryBudget> budget = CreateMemoryBudget(3000000);
+	std::atomic<bool> bDone(false);
+	std::thread trimmer([&]()
+	{
+		while (!bDone)
+		{
+			budget->Trim(500000);
+			std::this_thread::sleep_for(std::chrono::milliseconds(3));
+		}
+	});
+
+	// game threads each play, seek and step back through players of their own, recreated every round
+	std::atomic<uint32> numBadFrames(0);
+	std::vector<std::thread> games;
+
+	for (uint32 iGame = 0; iGame < 4; iGame++)
+	{
+		games.emplace_back([&, iGame]()
+		{
+			std::mt19937 random(iGame);
+
+			for (uint32 iRound = 0; iRound < 3; iRound++)
+			{
+				PlayerOptions options;
+				options.PreBufferingSize = 16;
+				options.IOQueueDepth = iGame % 2 ? 8 : 1;
+				options.MemoryBudget = budget;
+				options.MemoryBudgetPriority = iGame;
+				options.AdaptivePreBuffering = iGame >= 2;
+				options.Direction = (PlaybackDirection)(iGame % 3);
+
+				std::shared_ptr<IPlayer> player = CreatePlayer(CreateFileByteSource(path), options);
+
+				uint32 iFrame = 0;
+				for (uint32 iTick = 0; iTick < 600; iTick++)
+				{
+					if (player->GetStatus() != PlayerStatus::Ready)
+					{
+						std::this_thread::yield();
+						continue;
+					}
+
+					const uint32 action = random() % 100;
+					if (action < 3)
+					{
+						iFrame = random() % desc.NumFrames;
+					}
+					else if (action < 8)
+					{
+						iFrame = (iFrame + desc.NumFrames - 1) % desc.NumFrames;
+					}
+					else if (action < 40)
+					{
+						iFrame = (iFrame + 1) % desc.NumFrames;
+					}
+
+					// frames that aren't buffered yet are waited for half of the time
+					std::shared_ptr<IFrame> frame = player->GetFrameAt(iFrame, action < 50);
+					if (frame != nullptr && !CheckFrame(desc, frame, iFrame))
+					{
+						numBadFrames++;
+					}
+
+					if (iTick % 50 == 0)
+					{
+						PlayerStats stats;
+						player->CollectStats(stats);
+						player->GetBufferedFrameCount();
+					}
+				}
+			}
+		});
+	}
+
+	for (std::thread& game : games)
+	{
+		game.join();
+	}
+
+	bDone = true;
+	trimmer.join();
+
+	KIMURA_CHECK(numBadFrames == 0);
+
+	// every player gave back what it used
+	KIMURA_CHECK(budget->GetBytesUsed() == 0);
+
+	remove(path);
+}
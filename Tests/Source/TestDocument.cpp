@@ -0,0 +1,750 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "TestDocument.h"
+#include "TestEncoders.h"
+
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+	using namespace Kimura;
+
+	// little endian values, like the documents written by the converter
+	class ByteWriter
+	{
+		public:
+
+			template<typename T>
+			void Write(const T& InValue)
+			{
+				const byte* bytes = (const byte*)&InValue;
+				this->Data.insert(this->Data.end(), bytes, bytes + sizeof(T));
+			}
+
+			void WriteString(const std::string& InString)
+			{
+				this->Write<int32>((int32)InString.size());
+				this->Data.insert(this->Data.end(), InString.begin(), InString.end());
+			}
+
+			void WriteBytes(const std::vector<byte>& InBytes)
+			{
+				this->Data.insert(this->Data.end(), InBytes.begin(), InBytes.end());
+			}
+
+			std::vector<byte>	Data;
+	};
+
+	uint8 GetMinorVersion(const Tests::DocumentDesc& InDesc)
+	{
+		uint8 minorVersion = 5;
+
+		if (InDesc.Codec != StreamCodec::None)
+		{
+			minorVersion = 6;
+		}
+
+		if (InDesc.PositionEncoding != StreamEncoding::Raw)
+		{
+			minorVersion = 7;
+		}
+
+		if (InDesc.PositionEncoding == StreamEncoding::Basis || InDesc.PositionEncoding == StreamEncoding::BytePlanes || InDesc.IndexEncoding == StreamEncoding::Triangles)
+		{
+			minorVersion = 8;
+		}
+
+		return std::max(minorVersion, InDesc.MinorVersion);
+	}
+
+	bool IsBasisMesh(const Tests::DocumentDesc& InDesc, uint32 InMesh)
+	{
+		return InDesc.PositionEncoding == StreamEncoding::Basis && (int32)InMesh != InDesc.ConstantMesh;
+	}
+
+	std::vector<uint32> GetIndices(const Tests::DocumentDesc& InDesc, uint32 InStoringFrame)
+	{
+		if (!InDesc.Indices.empty())
+		{
+			return InDesc.Indices;
+		}
+
+		std::vector<uint32> indices(InDesc.NumVertices);
+		for (uint32 i = 0; i < InDesc.NumVertices; i++)
+		{
+			indices[i] = (InStoringFrame + i) % InDesc.NumVertices;
+		}
+
+		return indices;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::GetBasisMean
+//-----------------------------------------------------------------------------
+float Kimura::Tests::GetBasisMean(uint32 InMesh, uint32 InComponent)
+{
+	return sinf(InComponent * 0.01f) * 4.0f + (float)InMesh;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::GetBasisVector
+//-----------------------------------------------------------------------------
+float Kimura::Tests::GetBasisVector(uint32 InVector, uint32 InComponent)
+{
+	return sinf(InComponent * 0.37f * (InVector + 1) + InVector) / (float)(InVector + 1);
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::GetBasisCoefficient
+//-----------------------------------------------------------------------------
+float Kimura::Tests::GetBasisCoefficient(uint32 InFrame, uint32 InVector)
+{
+	return cosf(InFrame * 0.1f * (InVector + 1) + InVector);
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::GetBasisError
+//-----------------------------------------------------------------------------
+float Kimura::Tests::GetBasisError(uint32 InVector)
+{
+	return 1.0f / (float)(InVector + 1);
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::GetStoringFrame
+//-----------------------------------------------------------------------------
+Kimura::uint32 Kimura::Tests::GetStoringFrame(const DocumentDesc& InDesc, uint32 InMesh, uint32 InFrame, bool InPositions)
+{
+	if ((int32)InMesh == InDesc.ConstantMesh)
+	{
+		return 0;
+	}
+
+	const uint32 interval = InPositions ? InDesc.PositionsInterval : InDesc.IndicesInterval;
+	return (InFrame / interval) * interval;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::GetPositionValue
+//-----------------------------------------------------------------------------
+float Kimura::Tests::GetPositionValue(const DocumentDesc& InDesc, uint32 InFrame, uint32 InMesh, uint32 InComponent)
+{
+	if (InDesc.PositionValue)
+	{
+		return InDesc.PositionValue(InFrame, InMesh, InComponent);
+	}
+
+	float value = (float)(InFrame + InMesh * 100000);
+
+	// the first and last components keep the plain value
+	if (InDesc.VariedPositions && InComponent > 0 && InComponent < InDesc.NumVertices * 3 - 1)
+	{
+		value += (float)(((InComponent * 2654435761u) >> 24) & 63) * 0.25f;
+	}
+
+	return value;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::WriteDocument
+//-----------------------------------------------------------------------------
+std::vector<Kimura::byte> Kimura::Tests::WriteDocument(const DocumentDesc& InDesc, uint64* OutFrameDataPosition)
+{
+	const uint8 minorVersion = GetMinorVersion(InDesc);
+	const uint32 numComponents = InDesc.NumVertices * 3;
+
+	// bases come first in the frame data
+	std::vector<byte> frameData;
+	std::vector<TestMesh> meshes(InDesc.NumMeshes);
+
+	for (uint32 iMesh = 0; iMesh < InDesc.NumMeshes; iMesh++)
+	{
+		TestMesh& mesh = meshes[iMesh];
+		mesh.Name = "Mesh" + std::to_string(iMesh);
+		mesh.Constant = (int32)iMesh == InDesc.ConstantMesh;
+		mesh.MaxVertices = InDesc.NumVertices;
+		mesh.MaxSurfaces = InDesc.NumVertices;
+
+		if (IsBasisMesh(InDesc, iMesh))
+		{
+			mesh.PositionFormat_ = InDesc.BasisPositionFormat;
+			mesh.NumBasisVectors = InDesc.NumBasisVectors;
+			mesh.BasisPosition = frameData.size();
+
+			for (uint32 iVector = 0; iVector <= InDesc.NumBasisVectors; iVector++)
+			{
+				for (uint32 i = 0; i < numComponents; i++)
+				{
+					const float value = iVector == 0 ? GetBasisMean(iMesh, i) : GetBasisVector(iVector - 1, i);
+					frameData.insert(frameData.end(), (const byte*)&value, (const byte*)&value + 4);
+				}
+
+				if (iVector < InDesc.NumBasisVectors)
+				{
+					mesh.BasisErrors.push_back(GetBasisError(iVector));
+				}
+			}
+		}
+
+		if (InDesc.EditMesh)
+		{
+			InDesc.EditMesh(iMesh, mesh);
+		}
+	}
+
+	ByteWriter toc;
+
+	const byte version[4] = { 0, minorVersion, 0, 0 };
+	toc.Write(version);
+	toc.WriteString("Kimura tests");
+	toc.WriteString("today");
+	toc.Write<float>(1.0f / 30.0f);
+	toc.Write<float>(30.0f);
+	toc.Write<uint32>(0);
+
+	toc.Write<uint32>(InDesc.NumMeshes);
+	for (const TestMesh& mesh : meshes)
+	{
+		toc.WriteString(mesh.Name);
+		toc.Write<bool>(mesh.Constant);
+		toc.Write<uint64>(mesh.MaxVertices);
+		toc.Write<uint64>(mesh.MaxSurfaces);
+
+		// positions, then normals, tangents, velocities, texcoords and colors, which aren't stored
+		toc.Write<int32>((int32)mesh.PositionFormat_);
+		toc.Write<int32>((int32)NormalFormat::None);
+		toc.Write<int32>((int32)TangentFormat::None);
+		toc.Write<int32>((int32)VelocityFormat::None);
+		toc.Write<int32>((int32)TexCoordFormat::None);
+		toc.Write<int32>((int32)ColorFormat::None);
+
+		if (minorVersion >= 8)
+		{
+			toc.Write<uint32>(mesh.NumBasisVectors);
+			if (mesh.NumBasisVectors > 0)
+			{
+				toc.Write<uint64>(mesh.BasisPosition);
+				for (float error : mesh.BasisErrors)
+				{
+					toc.Write<float>(error);
+				}
+			}
+		}
+	}
+
+	// image sequences
+	toc.Write<uint32>(0);
+
+	toc.Write<uint32>(InDesc.NumFrames);
+
+	// the last positions stored by each mesh, which the next ones are predicted from
+	std::vector<std::vector<uint32>> previous(InDesc.NumMeshes);
+	std::vector<std::vector<uint32>> beforePrevious(InDesc.NumMeshes);
+	std::vector<bool> previousPredicted(InDesc.NumMeshes, false);
+
+	for (uint32 iFrame = 0; iFrame < InDesc.NumFrames; iFrame++)
+	{
+		std::vector<byte> frame;
+		std::vector<TestFrameMesh> frameMeshes(InDesc.NumMeshes);
+
+		// stored with the document's codec
+		auto writeStream = [&InDesc, &frame](const std::vector<byte>& InData, TestStream& OutStream)
+		{
+			std::vector<byte> stored = InDesc.Codec == StreamCodec::LZ4 ? EncodeLZ4(InData.data(), InData.size()) : InData;
+
+			OutStream.Seek = (int32)frame.size();
+			OutStream.Codec = InDesc.Codec;
+			OutStream.StoredSize = (uint32)stored.size();
+
+			frame.insert(frame.end(), stored.begin(), stored.end());
+		};
+
+		// stored in an encoding of its own
+		auto writeEncodedStream = [&frame](const std::vector<byte>& InData, StreamEncoding InEncoding, TestStream& OutStream)
+		{
+			OutStream.Seek = (int32)frame.size();
+			OutStream.Encoding = InEncoding;
+			OutStream.StoredSize = (uint32)InData.size();
+
+			frame.insert(frame.end(), InData.begin(), InData.end());
+		};
+
+		for (uint32 iMesh = 0; iMesh < InDesc.NumMeshes; iMesh++)
+		{
+			const bool bConstant = (int32)iMesh == InDesc.ConstantMesh;
+
+			TestFrameMesh& frameMesh = frameMeshes[iMesh];
+			frameMesh.NumVertices = InDesc.NumVertices;
+			frameMesh.NumSurfaces = InDesc.NumVertices / 3;
+
+			if (IsBasisMesh(InDesc, iMesh))
+			{
+				frameMesh.QuantizationExtents = Vector3(16.0f, 16.0f, 16.0f);
+			}
+
+			// the first texcoord channel is only ever stored empty, by the first frame
+			frameMesh.Streams[StreamTexCoords].Seek = iFrame > 0 ? -1 : 0;
+
+			TestStream& indices = frameMesh.Streams[StreamIndices];
+			TestStream& positions = frameMesh.Streams[StreamPositions];
+
+			if (GetStoringFrame(InDesc, iMesh, iFrame, false) == iFrame)
+			{
+				const std::vector<uint32> values = GetIndices(InDesc, iFrame);
+
+				std::vector<byte> data(values.size() * 2);
+				for (size_t i = 0; i < values.size(); i++)
+				{
+					const uint16 value = (uint16)values[i];
+					memcpy(&data[i * 2], &value, 2);
+				}
+
+				indices.Size = (uint32)data.size();
+
+				if (InDesc.IndexEncoding == StreamEncoding::Triangles && !bConstant)
+				{
+					writeEncodedStream(EncodeTriangles(values, false), StreamEncoding::Triangles, indices);
+				}
+				else
+				{
+					writeStream(data, indices);
+				}
+			}
+			else
+			{
+				indices.Seek = -1;
+			}
+
+			while (frame.size() % 4 != 0)
+			{
+				frame.push_back(0);
+			}
+
+			if (GetStoringFrame(InDesc, iMesh, iFrame, true) != iFrame)
+			{
+				positions.Seek = -1;
+
+				beforePrevious[iMesh] = previous[iMesh];
+				previousPredicted[iMesh] = false;
+				continue;
+			}
+
+			std::vector<uint32> values(numComponents);
+			for (uint32 i = 0; i < numComponents; i++)
+			{
+				const float value = GetPositionValue(InDesc, iFrame, iMesh, i);
+				memcpy(&values[i], &value, 4);
+			}
+
+			positions.Size = numComponents * 4;
+
+			if (IsBasisMesh(InDesc, iMesh))
+			{
+				std::vector<byte> coefficients(InDesc.NumBasisVectors * 4);
+				for (uint32 iVector = 0; iVector < InDesc.NumBasisVectors; iVector++)
+				{
+					const float coefficient = GetBasisCoefficient(iFrame, iVector);
+					memcpy(&coefficients[iVector * 4], &coefficient, 4);
+				}
+
+				positions.Size = InDesc.NumVertices * (InDesc.BasisPositionFormat == PositionFormat::Half ? 6 : 12);
+				writeEncodedStream(coefficients, StreamEncoding::Basis, positions);
+				continue;
+			}
+
+			if (InDesc.PositionEncoding == StreamEncoding::BytePlanes && !bConstant)
+			{
+				writeEncodedStream(EncodeBytePlanes((const byte*)values.data(), InDesc.NumVertices, 12), StreamEncoding::BytePlanes, positions);
+				continue;
+			}
+
+			const bool bKeyframe = bConstant || iFrame == 0 || (InDesc.KeyframeInterval > 0 && iFrame % InDesc.KeyframeInterval == 0);
+			const bool bPredicted = !bKeyframe && (InDesc.PositionEncoding == StreamEncoding::Delta || InDesc.PositionEncoding == StreamEncoding::Linear);
+			const bool bSparse = !bKeyframe && previous[iMesh].size() == values.size() &&
+				(InDesc.PositionEncoding == StreamEncoding::Sparse || (bPredicted && InDesc.SparseInterval > 0 && iFrame % InDesc.SparseInterval == 0));
+
+			if (bSparse)
+			{
+				const std::vector<byte> changes = EncodeSparseStream((const byte*)previous[iMesh].data(), (const byte*)values.data(), positions.Size, 12);
+
+				positions.Size = (uint32)changes.size();
+				positions.Encoding = StreamEncoding::Sparse;
+				writeStream(changes, positions);
+			}
+			else
+			{
+				// linear prediction falls back to delta when the previous frame didn't predict the stream
+				const bool bLinear = InDesc.PositionEncoding == StreamEncoding::Linear && previousPredicted[iMesh];
+
+				std::vector<byte> data(numComponents * 4);
+				for (uint32 i = 0; i < numComponents; i++)
+				{
+					uint32 value = values[i];
+					if (bPredicted)
+					{
+						value -= bLinear ? previous[iMesh][i] * 2 - beforePrevious[iMesh][i] : previous[iMesh][i];
+					}
+
+					memcpy(&data[i * 4], &value, 4);
+				}
+
+				positions.Encoding = bPredicted ? InDesc.PositionEncoding : StreamEncoding::Raw;
+				writeStream(data, positions);
+			}
+
+			beforePrevious[iMesh] = previous[iMesh];
+			previous[iMesh] = values;
+			previousPredicted[iMesh] = bPredicted && !bSparse;
+		}
+
+		toc.Write<uint64>(frameData.size());
+		toc.Write<uint64>(frame.size());
+
+		for (uint32 iMesh = 0; iMesh < InDesc.NumMeshes; iMesh++)
+		{
+			TestFrameMesh& frameMesh = frameMeshes[iMesh];
+
+			if (InDesc.EditFrameMesh)
+			{
+				InDesc.EditFrameMesh(iFrame, iMesh, frameMesh);
+			}
+
+			const TestStream* streams = frameMesh.Streams;
+
+			toc.Write<uint32>(frameMesh.NumVertices);
+			toc.Write<uint32>(frameMesh.NumSurfaces);
+
+			// a single section: first vertex, first index, triangles, lowest and highest vertex index
+			toc.Write<uint32>(1);
+			const uint32 section[5] = { 0, 0, InDesc.NumVertices / 3, 0, InDesc.NumVertices - 1 };
+			toc.Write(section);
+
+			toc.Write<int32>(streams[StreamIndices].Seek);
+			toc.Write<uint32>(streams[StreamIndices].Size);
+			toc.Write<int32>(streams[StreamPositions].Seek);
+			toc.Write<uint32>(streams[StreamPositions].Size);
+			toc.Write(frameMesh.QuantizationCenter);
+			toc.Write(frameMesh.QuantizationExtents);
+
+			for (uint32 iStream : { StreamNormals, StreamTangents, StreamVelocities })
+			{
+				toc.Write<int32>(streams[iStream].Seek);
+				toc.Write<uint32>(streams[iStream].Size);
+			}
+
+			// velocity quantization
+			toc.Write(Vector3());
+			toc.Write(Vector3(1.0f, 1.0f, 1.0f));
+
+			for (uint32 i = 0; i < MaxTextureCoords; i++)
+			{
+				toc.Write<int32>(streams[StreamTexCoords + i].Seek);
+			}
+
+			for (uint32 i = 0; i < MaxTextureCoords; i++)
+			{
+				toc.Write<uint32>(streams[StreamTexCoords + i].Size);
+			}
+
+			for (uint32 i = 0; i < MaxColorChannels; i++)
+			{
+				toc.Write<int32>(streams[StreamColors + i].Seek);
+			}
+
+			for (uint32 i = 0; i < MaxColorChannels; i++)
+			{
+				toc.Write<uint32>(streams[StreamColors + i].Size);
+			}
+
+			// color quantization
+			toc.Write(Vector4());
+			toc.Write(Vector4());
+
+			// bounds
+			toc.Write(Vector3());
+			toc.Write(Vector3(1.0f, 1.0f, 1.0f));
+
+			if (minorVersion >= 6)
+			{
+				for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+				{
+					toc.Write<uint8>(streams[iStream].Seek >= 0 ? (uint8)streams[iStream].Codec : 0);
+				}
+
+				for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+				{
+					toc.Write<uint32>(streams[iStream].Seek >= 0 ? streams[iStream].StoredSize : 0);
+				}
+			}
+
+			if (minorVersion >= 7)
+			{
+				for (uint32 iStream = 0; iStream < NumStreams; iStream++)
+				{
+					toc.Write<uint8>(streams[iStream].Seek >= 0 ? (uint8)streams[iStream].Encoding : 0);
+				}
+			}
+		}
+
+		frameData.insert(frameData.end(), frame.begin(), frame.end());
+	}
+
+	if (OutFrameDataPosition != nullptr)
+	{
+		*OutFrameDataPosition = toc.Data.size();
+	}
+
+	toc.WriteBytes(frameData);
+
+	return std::move(toc.Data);
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::CheckFrame
+//-----------------------------------------------------------------------------
+bool Kimura::Tests::CheckFrame(const DocumentDesc& InDesc, const std::shared_ptr<IFrame>& InFrame, uint32 InFrameIndex, float InMaxBasisError)
+{
+	if (InFrame == nullptr || InFrame->FrameIndex != InFrameIndex)
+	{
+		printf("frame %u: %s\n", InFrameIndex, InFrame == nullptr ? "missing" : "wrong frame");
+		return false;
+	}
+
+	const uint32 numComponents = InDesc.NumVertices * 3;
+
+	// bases only use their first vectors within the error bound
+	uint32 numBasisVectors = InDesc.NumBasisVectors;
+	for (uint32 i = 0; InMaxBasisError > 0.0f && i < InDesc.NumBasisVectors; i++)
+	{
+		if (GetBasisError(i) <= InMaxBasisError)
+		{
+			numBasisVectors = i + 1;
+			break;
+		}
+	}
+
+	for (uint32 iMesh = 0; iMesh < InDesc.NumMeshes; iMesh++)
+	{
+		const std::vector<uint32> expectedIndices = GetIndices(InDesc, GetStoringFrame(InDesc, iMesh, InFrameIndex, false));
+		const uint16* indices = InFrame->GetIndicesU16(iMesh);
+
+		for (size_t i = 0; indices != nullptr && i < expectedIndices.size(); i++)
+		{
+			if (indices[i] != (uint16)expectedIndices[i])
+			{
+				printf("frame %u, mesh %u: index %zu is %u instead of %u\n", InFrameIndex, iMesh, i, indices[i], expectedIndices[i]);
+				return false;
+			}
+		}
+
+		const uint32 storingFrame = GetStoringFrame(InDesc, iMesh, InFrameIndex, true);
+		const float* positions = (const float*)InFrame->GetPositionsF32(iMesh);
+		const int16* quantizedPositions = InFrame->GetPositionsI16(iMesh);
+
+		if (indices == nullptr || (positions == nullptr && quantizedPositions == nullptr))
+		{
+			printf("frame %u, mesh %u: missing streams\n", InFrameIndex, iMesh);
+			return false;
+		}
+
+		for (uint32 i = 0; i < numComponents; i++)
+		{
+			if (!IsBasisMesh(InDesc, iMesh))
+			{
+				const float expected = GetPositionValue(InDesc, storingFrame, iMesh, i);
+				if (positions[i] != expected)
+				{
+					printf("frame %u, mesh %u: component %u is %f instead of %f\n", InFrameIndex, iMesh, i, positions[i], expected);
+					return false;
+				}
+
+				continue;
+			}
+
+			// single precision reconstruction against a double precision reference
+			double expected = GetBasisMean(iMesh, i);
+			for (uint32 iVector = 0; iVector < numBasisVectors; iVector++)
+			{
+				expected += (double)GetBasisCoefficient(storingFrame, iVector) * GetBasisVector(iVector, i);
+			}
+
+			const double difference = InDesc.BasisPositionFormat == PositionFormat::Full ? positions[i] - expected : quantizedPositions[i] - expected / 16.0 * 32767.0;
+			const double tolerance = InDesc.BasisPositionFormat == PositionFormat::Full ? 1e-4 : 1.01;
+
+			if (std::fabs(difference) > tolerance)
+			{
+				printf("frame %u, mesh %u: component %u is off by %f\n", InFrameIndex, iMesh, i, difference);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::OpenDocument
+//-----------------------------------------------------------------------------
+std::shared_ptr<Kimura::IPlayer> Kimura::Tests::OpenDocument(std::shared_ptr<IByteSource> InSource, const PlayerOptions& InOptions)
+{
+	std::shared_ptr<IPlayer> player = CreatePlayer(InSource, InOptions);
+
+	while (player->GetStatus() == PlayerStatus::Initializing)
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+
+	return player;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::WaitForStats
+//-----------------------------------------------------------------------------
+Kimura::PlayerStats Kimura::Tests::WaitForStats(IPlayer& InPlayer, const std::function<bool(const PlayerStats&)>& InCondition)
+{
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+	PlayerStats stats;
+	InPlayer.CollectStats(stats);
+
+	while (!InCondition(stats) && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		InPlayer.CollectStats(stats);
+	}
+
+	return stats;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::GetOpenFailure
+//-----------------------------------------------------------------------------
+std::string Kimura::Tests::GetOpenFailure(std::vector<byte> InDocument)
+{
+	std::shared_ptr<IPlayer> player = OpenDocument(CreateMemoryByteSource(std::move(InDocument)), PlayerOptions());
+
+	std::string message;
+	if (player->GetStatus() != PlayerStatus::Ready)
+	{
+		player->GetFailStatusMessage(message);
+		if (message.empty())
+		{
+			message = "failed";
+		}
+	}
+
+	return message;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::PlainByteSource
+//-----------------------------------------------------------------------------
+Kimura::Tests::PlainByteSource::PlainByteSource(std::vector<byte> InData)
+	:
+	Data(std::move(InData))
+{
+}
+
+Kimura::uint64 Kimura::Tests::PlainByteSource::GetSize()
+{
+	return this->Data.size();
+}
+
+bool Kimura::Tests::PlainByteSource::ReadAt(uint64 InOffset, void* OutData, uint64 InSize)
+{
+	if (InOffset > this->Data.size() || InSize > this->Data.size() - InOffset)
+	{
+		return false;
+	}
+
+	memcpy(OutData, &this->Data[InOffset], (size_t)InSize);
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::ThrottledByteSource
+//-----------------------------------------------------------------------------
+Kimura::Tests::ThrottledByteSource::ThrottledByteSource(std::vector<byte> InData, double InBytesPerSecond)
+	:
+	PlainByteSource(std::move(InData)),
+	BytesPerSecond(InBytesPerSecond)
+{
+}
+
+bool Kimura::Tests::ThrottledByteSource::ReadAt(uint64 InOffset, void* OutData, uint64 InSize)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	if (!PlainByteSource::ReadAt(InOffset, OutData, InSize))
+	{
+		return false;
+	}
+
+	if (this->BytesPerSecond > 0.0)
+	{
+		const std::chrono::duration<double> duration(InSize / this->BytesPerSecond);
+		std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration));
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::MappedByteSource
+//-----------------------------------------------------------------------------
+Kimura::Tests::MappedByteSource::MappedByteSource(const std::vector<byte>& InDocument, uint64 InFrameDataPosition, uint32 InMisalignment)
+	:
+	Storage(InDocument.size() + 32),
+	Size(InDocument.size())
+{
+	const uintptr_t frameData = ((uintptr_t)this->Storage.data() + InFrameDataPosition + 15) & ~(uintptr_t)15;
+	this->Data = (byte*)(frameData - InFrameDataPosition + InMisalignment);
+
+	if (this->Size > 0)
+	{
+		memcpy(this->Data, InDocument.data(), (size_t)this->Size);
+	}
+}
+
+Kimura::uint64 Kimura::Tests::MappedByteSource::GetSize()
+{
+	return this->Size;
+}
+
+bool Kimura::Tests::MappedByteSource::ReadAt(uint64 InOffset, void* OutData, uint64 InSize)
+{
+	if (InOffset > this->Size || InSize > this->Size - InOffset)
+	{
+		return false;
+	}
+
+	memcpy(OutData, &this->Data[InOffset], (size_t)InSize);
+	return true;
+}
+
+const Kimura::byte* Kimura::Tests::MappedByteSource::Map()
+{
+	return this->Data;
+}
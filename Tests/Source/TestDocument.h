@@ -0,0 +1,184 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#pragma once
+
+#include "Kimura.h"
+#include "Player.h"
+
+namespace Kimura
+{
+	namespace Tests
+	{
+		// a stream of a frame mesh, as written in the table of content
+		class TestStream
+		{
+			public:
+
+				int32				Seek = 0;			// relative to the frame, -1 when reused from the previous frame
+				uint32				Size = 0;			// decoded
+				StreamCodec			Codec = StreamCodec::None;
+				uint32				StoredSize = 0;
+				StreamEncoding		Encoding = StreamEncoding::Raw;
+		};
+
+		// a frame mesh, as written in the table of content
+		class TestFrameMesh
+		{
+			public:
+
+				uint32				NumVertices = 0;
+				uint32				NumSurfaces = 0;
+				TestStream			Streams[NumStreams];
+				Vector3				QuantizationCenter;
+				Vector3				QuantizationExtents = Vector3(1.0f, 1.0f, 1.0f);
+		};
+
+		// a mesh, as written in the table of content
+		class TestMesh
+		{
+			public:
+
+				std::string			Name;
+				bool				Constant = false;
+				uint64				MaxVertices = 0;
+				uint64				MaxSurfaces = 0;
+				PositionFormat		PositionFormat_ = PositionFormat::Full;
+				uint32				NumBasisVectors = 0;
+				uint64				BasisPosition = 0;		// relative to the frame data
+				std::vector<float>	BasisErrors;
+		};
+
+		// How a test document is generated. It stores indices and positions, every other stream is empty. Unless
+		// PositionValue says otherwise, the components of a mesh's positions are the index of the frame that stored
+		// them plus 100000 per mesh, and its indices are rotated by the index of that frame.
+		class DocumentDesc
+		{
+			public:
+
+				uint32				NumFrames = 100;
+				uint32				NumVertices = 1000;
+				uint32				NumMeshes = 1;
+
+				// streams are stored every this many frames, reused from the previous frame otherwise
+				uint32				PositionsInterval = 1;
+				uint32				IndicesInterval = 10;
+
+				// this mesh is constant, its streams are only stored in the first frame
+				int32				ConstantMesh = -1;
+
+				// codec of the stored streams, except those of encodings storing their own format
+				StreamCodec			Codec = StreamCodec::None;
+
+				// minor version of the format, the oldest one supporting the rest of the description when 0
+				uint8				MinorVersion = 0;
+
+				// positions of non constant meshes after the first frame (Delta, Linear, Sparse), of every frame (Basis,
+				// BytePlanes). Indices are Raw or Triangles.
+				StreamEncoding		PositionEncoding = StreamEncoding::Raw;
+				StreamEncoding		IndexEncoding = StreamEncoding::Raw;
+
+				// predicted positions are stored as sparse changes every this many frames
+				uint32				SparseInterval = 0;
+
+				// predicted or sparse positions are stored raw every this many frames, in the first frame only when 0
+				uint32				KeyframeInterval = 0;
+
+				// positions vary within a frame, which lets them compress like real data
+				bool				VariedPositions = false;
+
+				// overrides the components of the positions
+				std::function<float(uint32 InFrame, uint32 InMesh, uint32 InComponent)> PositionValue;
+
+				// basis positions: number of vectors and the format they're reconstructed to
+				uint32				NumBasisVectors = 8;
+				PositionFormat		BasisPositionFormat = PositionFormat::Full;
+
+				// overrides the indices of every frame (16 bits)
+				std::vector<uint32>	Indices;
+
+				// edit the table of content before it's written, to describe broken documents
+				std::function<void(uint32 InMesh, TestMesh& InOutMesh)> EditMesh;
+				std::function<void(uint32 InFrame, uint32 InMesh, TestFrameMesh& InOutFrameMesh)> EditFrameMesh;
+		};
+
+		// OutFrameDataPosition is where the frame data starts, right after the table of content
+		std::vector<byte> WriteDocument(const DocumentDesc& InDesc, uint64* OutFrameDataPosition = nullptr);
+
+		// the frame that stored a stream of a mesh, read by InFrame
+		uint32 GetStoringFrame(const DocumentDesc& InDesc, uint32 InMesh, uint32 InFrame, bool InPositions);
+
+		// component of a position, as stored by InFrame (before any basis)
+		float GetPositionValue(const DocumentDesc& InDesc, uint32 InFrame, uint32 InMesh, uint32 InComponent);
+
+		// the basis of the meshes of documents with basis positions
+		float GetBasisMean(uint32 InMesh, uint32 InComponent);
+		float GetBasisVector(uint32 InVector, uint32 InComponent);
+		float GetBasisCoefficient(uint32 InFrame, uint32 InVector);
+		float GetBasisError(uint32 InVector);
+
+		// checks every index and position of a frame against the description. The player was given InMaxBasisError.
+		bool CheckFrame(const DocumentDesc& InDesc, const std::shared_ptr<IFrame>& InFrame, uint32 InFrameIndex, float InMaxBasisError = 0.0f);
+
+		// creates a player, and waits for it to be done initializing
+		std::shared_ptr<IPlayer> OpenDocument(std::shared_ptr<IByteSource> InSource, const PlayerOptions& InOptions);
+
+		// polls the stats of a player until InCondition holds, a few seconds at most
+		PlayerStats WaitForStats(IPlayer& InPlayer, const std::function<bool(const PlayerStats&)>& InCondition);
+
+		// opens a document, returns the reason it failed to open, or an empty string when it opened
+		std::string GetOpenFailure(std::vector<byte> InDocument);
+
+		// byte source that isn't mapped, frames are read into buffers of their own
+		class PlainByteSource : public IByteSource
+		{
+			public:
+
+				PlainByteSource(std::vector<byte> InData);
+
+				virtual uint64 GetSize() override;
+				virtual bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize) override;
+
+			protected:
+
+				std::vector<byte>	Data;
+		};
+
+		// byte source whose reads take as long as they would at InBytesPerSecond
+		class ThrottledByteSource : public PlainByteSource
+		{
+			public:
+
+				ThrottledByteSource(std::vector<byte> InData, double InBytesPerSecond);
+
+				virtual bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize) override;
+
+			protected:
+
+				double				BytesPerSecond = 0.0;
+		};
+
+		// Byte source addressable in memory like a mapped file, frames point into it. The document is placed so that 
+		// its frame data starts on 16 bytes, plus InMisalignment.
+		class MappedByteSource : public IByteSource
+		{
+			public:
+
+				MappedByteSource(const std::vector<byte>& InDocument, uint64 InFrameDataPosition, uint32 InMisalignment = 0);
+
+				virtual uint64 GetSize() override;
+				virtual bool ReadAt(uint64 InOffset, void* OutData, uint64 InSize) override;
+				virtual const byte* Map() override;
+
+			protected:
+
+				std::vector<byte>	Storage;
+				byte*				Data = nullptr;
+				uint64				Size = 0;
+		};
+	}
+}
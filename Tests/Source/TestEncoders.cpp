@@ -0,0 +1,361 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "TestEncoders.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	using namespace Kimura;
+
+	// 7 bits variable length integer, lowest bits first
+	void WriteVarint(std::vector<byte>& OutData, uint32 InValue)
+	{
+		while (InValue >= 128)
+		{
+			OutData.push_back((byte)(InValue | 128));
+			InValue >>= 7;
+		}
+
+		OutData.push_back((byte)InValue);
+	}
+
+	uint32 ZigZag(uint32 InDifference)
+	{
+		return (InDifference << 1) ^ (uint32)((int32)InDifference >> 31);
+	}
+
+	// LZ4 lengths of 15 and more continue in the following bytes
+	void WriteLZ4Length(std::vector<byte>& OutData, uint64 InLength)
+	{
+		if (InLength < 15)
+		{
+			return;
+		}
+
+		InLength -= 15;
+		while (InLength >= 255)
+		{
+			OutData.push_back(255);
+			InLength -= 255;
+		}
+
+		OutData.push_back((byte)InLength);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::EncodeLZ4
+//-----------------------------------------------------------------------------
+std::vector<Kimura::byte> Kimura::Tests::EncodeLZ4(const byte* InData, uint64 InSize)
+{
+	std::vector<byte> encoded;
+	std::vector<int64> lastPositions(1 << 16, -1);
+
+	uint64 anchor = 0;
+
+	// literals since the anchor, followed by a match unless it's the last sequence
+	auto writeSequence = [&](uint64 InLiteralsEnd, uint64 InMatchLength, uint64 InOffset, bool InLast)
+	{
+		const uint64 numLiterals = InLiteralsEnd - anchor;
+
+		byte token = (byte)(std::min<uint64>(numLiterals, 15) << 4);
+		if (!InLast)
+		{
+			token |= (byte)std::min<uint64>(InMatchLength - 4, 15);
+		}
+
+		encoded.push_back(token);
+		WriteLZ4Length(encoded, numLiterals);
+		encoded.insert(encoded.end(), InData + anchor, InData + InLiteralsEnd);
+
+		if (!InLast)
+		{
+			encoded.push_back((byte)(InOffset & 255));
+			encoded.push_back((byte)(InOffset >> 8));
+			WriteLZ4Length(encoded, InMatchLength - 4);
+		}
+	};
+
+	// the block format wants the last 5 bytes to be literals, and no match starting in the last 12 bytes
+	if (InSize >= 13)
+	{
+		uint64 i = 0;
+		while (i < InSize - 12)
+		{
+			uint32 sequence;
+			memcpy(&sequence, &InData[i], 4);
+
+			const uint32 hash = (sequence * 2654435761u) >> 16;
+			const int64 candidate = lastPositions[hash];
+			lastPositions[hash] = (int64)i;
+
+			if (candidate < 0 || i - (uint64)candidate > 65535 || memcmp(&InData[candidate], &InData[i], 4) != 0)
+			{
+				i++;
+				continue;
+			}
+
+			uint64 length = 4;
+			while (i + length < InSize - 5 && InData[candidate + length] == InData[i + length])
+			{
+				length++;
+			}
+
+			writeSequence(i, length, i - (uint64)candidate, false);
+
+			i += length;
+			anchor = i;
+		}
+	}
+
+	writeSequence(InSize, 0, 0, true);
+
+	return encoded;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::EncodeSparseStream
+//-----------------------------------------------------------------------------
+std::vector<Kimura::byte> Kimura::Tests::EncodeSparseStream(const byte* InPrevious, const byte* InData, uint64 InSize, uint64 InElementSize)
+{
+	std::vector<uint32> runs;
+	std::vector<byte> values;
+
+	for (uint64 iElement = 0; iElement < InSize / InElementSize; iElement++)
+	{
+		const uint64 offset = iElement * InElementSize;
+		if (memcmp(&InPrevious[offset], &InData[offset], (size_t)InElementSize) == 0)
+		{
+			continue;
+		}
+
+		// extends the last run when it ends right before this element
+		if (!runs.empty() && runs[runs.size() - 2] + runs.back() == iElement)
+		{
+			runs.back()++;
+		}
+		else
+		{
+			runs.push_back((uint32)iElement);
+			runs.push_back(1);
+		}
+
+		values.insert(values.end(), &InData[offset], &InData[offset] + InElementSize);
+	}
+
+	const uint32 numRuns = (uint32)(runs.size() / 2);
+
+	std::vector<byte> encoded(4 + runs.size() * 4);
+	memcpy(encoded.data(), &numRuns, 4);
+	if (!runs.empty())
+	{
+		memcpy(&encoded[4], runs.data(), runs.size() * 4);
+	}
+
+	encoded.insert(encoded.end(), values.begin(), values.end());
+
+	return encoded;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::EncodeTriangles
+//-----------------------------------------------------------------------------
+std::vector<Kimura::byte> Kimura::Tests::EncodeTriangles(const std::vector<uint32>& InIndices, bool InRotate)
+{
+	const uint64 numTriangles = InIndices.size() / 3;
+
+	std::vector<byte> codes(numTriangles);
+	std::vector<byte> vertices;
+
+	// the same history the decoder keeps: the edges of the last triangles, the last vertices referenced, the next
+	// vertex never referenced so far and the last explicit one
+	uint32 edges[16][2] = {};
+	uint32 lastVertices[16] = {};
+	uint32 numEdges = 0;
+	uint32 numVertices = 0;
+	uint32 nextVertex = 0;
+	uint32 lastExplicitVertex = 0;
+
+	auto pushEdge = [&](uint32 InA, uint32 InB)
+	{
+		edges[numEdges & 15][0] = InA;
+		edges[numEdges & 15][1] = InB;
+		numEdges++;
+	};
+
+	auto pushVertex = [&](uint32 InVertex)
+	{
+		lastVertices[numVertices & 15] = InVertex;
+		numVertices++;
+	};
+
+	// 1 to 15 for one of the last vertices, 0 when it's not one of them
+	auto findVertex = [&](uint32 InVertex, uint32 InMaxDistance)
+	{
+		for (uint32 j = 1; j <= InMaxDistance && j <= numVertices; j++)
+		{
+			if (lastVertices[(numVertices - j) & 15] == InVertex)
+			{
+				return j;
+			}
+		}
+
+		return 0u;
+	};
+
+	for (uint64 iTriangle = 0; iTriangle < numTriangles; iTriangle++)
+	{
+		const uint32 triangle[3] = { InIndices[iTriangle * 3], InIndices[iTriangle * 3 + 1], InIndices[iTriangle * 3 + 2] };
+
+		// an edge of one of the last 15 triangles, in the opposite direction
+		int32 sharedEdge = -1;
+		uint32 rotation = 0;
+
+		for (uint32 r = 0; r < (InRotate ? 3u : 1u) && sharedEdge < 0; r++)
+		{
+			for (uint32 i = 0; i < 15 && i < numEdges; i++)
+			{
+				const uint32* edge = edges[(numEdges - 1 - i) & 15];
+				if (edge[0] == triangle[r] && edge[1] == triangle[(r + 1) % 3])
+				{
+					sharedEdge = (int32)i;
+					rotation = r;
+					break;
+				}
+			}
+		}
+
+		if (sharedEdge >= 0)
+		{
+			const uint32 a = triangle[rotation];
+			const uint32 b = triangle[(rotation + 1) % 3];
+			const uint32 c = triangle[(rotation + 2) % 3];
+
+			uint32 vertexCode = 0;
+			if (c == nextVertex)
+			{
+				nextVertex++;
+				pushVertex(c);
+			}
+			else if ((vertexCode = findVertex(c, 14)) == 0)
+			{
+				vertexCode = 15;
+				WriteVarint(vertices, ZigZag(c - lastExplicitVertex));
+				lastExplicitVertex = c;
+				pushVertex(c);
+			}
+
+			codes[iTriangle] = (byte)((uint32)sharedEdge << 4 | vertexCode);
+
+			pushEdge(c, b);
+			pushEdge(a, c);
+			continue;
+		}
+
+		codes[iTriangle] = 0xf0;
+
+		for (uint32 vertex : triangle)
+		{
+			if (vertex == nextVertex)
+			{
+				WriteVarint(vertices, 0);
+				nextVertex++;
+				pushVertex(vertex);
+				continue;
+			}
+
+			const uint32 distance = findVertex(vertex, 15);
+			if (distance != 0)
+			{
+				WriteVarint(vertices, distance);
+				continue;
+			}
+
+			WriteVarint(vertices, ZigZag(vertex - lastExplicitVertex) + 16);
+			lastExplicitVertex = vertex;
+			pushVertex(vertex);
+		}
+
+		pushEdge(triangle[1], triangle[0]);
+		pushEdge(triangle[2], triangle[1]);
+		pushEdge(triangle[0], triangle[2]);
+	}
+
+	codes.insert(codes.end(), vertices.begin(), vertices.end());
+
+	return codes;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::EncodeBytePlanes
+//-----------------------------------------------------------------------------
+std::vector<Kimura::byte> Kimura::Tests::EncodeBytePlanes(const byte* InData, uint64 InNumVertices, uint32 InVertexSize)
+{
+	const uint32 blockSize = 256;
+
+	std::vector<byte> encoded;
+	std::vector<byte> previous(InVertexSize, 0);
+
+	for (uint64 blockBegin = 0; blockBegin < InNumVertices; blockBegin += blockSize)
+	{
+		const uint32 count = (uint32)std::min<uint64>(blockSize, InNumVertices - blockBegin);
+		const uint32 numGroups = (count + 15) / 16;
+
+		for (uint32 iPlane = 0; iPlane < InVertexSize; iPlane++)
+		{
+			// zigzagged differences with the previous vertex, the last group padded with zeros
+			std::vector<byte> values(numGroups * 16, 0);
+			for (uint32 i = 0; i < count; i++)
+			{
+				const byte value = InData[(blockBegin + i) * InVertexSize + iPlane];
+				const int8 difference = (int8)(byte)(value - previous[iPlane]);
+
+				values[i] = (byte)(((byte)difference << 1) ^ (byte)(difference >> 7));
+				previous[iPlane] = value;
+			}
+
+			std::vector<byte> header((numGroups + 3) / 4, 0);
+			std::vector<byte> groups;
+
+			for (uint32 iGroup = 0; iGroup < numGroups; iGroup++)
+			{
+				const byte* group = &values[iGroup * 16];
+				const byte largest = *std::max_element(group, group + 16);
+
+				const uint32 mode = largest == 0 ? 0 : largest < 4 ? 1 : largest < 16 ? 2 : 3;
+				header[iGroup / 4] |= (byte)(mode << ((iGroup % 4) * 2));
+
+				for (uint32 i = 0; mode == 1 && i < 16; i += 4)
+				{
+					groups.push_back((byte)(group[i] << 6 | group[i + 1] << 4 | group[i + 2] << 2 | group[i + 3]));
+				}
+
+				for (uint32 i = 0; mode == 2 && i < 16; i += 2)
+				{
+					groups.push_back((byte)(group[i] << 4 | group[i + 1]));
+				}
+
+				if (mode == 3)
+				{
+					groups.insert(groups.end(), group, group + 16);
+				}
+			}
+
+			encoded.insert(encoded.end(), header.begin(), header.end());
+			encoded.insert(encoded.end(), groups.begin(), groups.end());
+		}
+	}
+
+	return encoded;
+}
@@ -0,0 +1,32 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#pragma once
+
+#include "Kimura.h"
+
+namespace Kimura
+{
+	namespace Tests
+	{
+		// Encoders of the streams the library decodes, which the converter would otherwise produce. They favor being
+		// simple over compressing well.
+
+		// LZ4 block, greedy matches from a hash of the last position of every 4 bytes sequence
+		std::vector<byte> EncodeLZ4(const byte* InData, uint64 InSize);
+
+		// sparse stream of the InElementSize bytes elements that differ between two streams of the same size
+		std::vector<byte> EncodeSparseStream(const byte* InPrevious, const byte* InData, uint64 InSize, uint64 InElementSize);
+
+		// triangles stream of InIndices. Triangles are rotated to share an edge with a previous one when InRotate is
+		// set, their first vertex is kept otherwise.
+		std::vector<byte> EncodeTriangles(const std::vector<uint32>& InIndices, bool InRotate);
+
+		// byte planes stream of InNumVertices vertices of InVertexSize bytes
+		std::vector<byte> EncodeBytePlanes(const byte* InData, uint64 InNumVertices, uint32 InVertexSize);
+	}
+}
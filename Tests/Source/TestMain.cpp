@@ -0,0 +1,121 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#include "Tests.h"
+#include "Player.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+	struct RegisteredTest
+	{
+		const char*						Name;
+		Kimura::Tests::TestFunction		Function;
+	};
+
+	// filled before main runs, in no particular order
+	std::vector<RegisteredTest>& GetRegisteredTests()
+	{
+		static std::vector<RegisteredTest> tests;
+		return tests;
+	}
+
+	const char*		RunningTest = nullptr;
+	uint32_t		NumFailedChecks = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::TestRegistration::TestRegistration
+//-----------------------------------------------------------------------------
+Kimura::Tests::TestRegistration::TestRegistration(const char* InName, TestFunction InFunction)
+{
+	GetRegisteredTests().push_back({ InName, InFunction });
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::ReportFailure
+//-----------------------------------------------------------------------------
+void Kimura::Tests::ReportFailure(const char* InFile, int InLine, const char* InExpression)
+{
+	// a failing check inside a loop only reports its first few failures
+	NumFailedChecks++;
+	if (NumFailedChecks <= 20)
+	{
+		printf("%s:%d: %s: check failed: %s\n", InFile, InLine, RunningTest, InExpression);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Tests::IsUsingSIMD
+//-----------------------------------------------------------------------------
+bool Kimura::Tests::IsUsingSIMD()
+{
+#if defined(KIMURA_SSE2)
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// main
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	// arguments select the tests whose name contains one of them, all of them run otherwise
+	auto isSelected = [argc, argv](const char* InName)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			if (strstr(InName, argv[i]) != nullptr)
+			{
+				return true;
+			}
+		}
+
+		return argc <= 1;
+	};
+
+	printf("Kimura %s, %s code paths\n", Kimura::GetVersion().c_str(), Kimura::Tests::IsUsingSIMD() ? "SSE2" : "scalar");
+
+	uint32_t numTests = 0;
+	uint32_t numFailedTests = 0;
+
+	for (const RegisteredTest& test : GetRegisteredTests())
+	{
+		if (!isSelected(test.Name))
+		{
+			continue;
+		}
+
+		RunningTest = test.Name;
+
+		const uint32_t numFailedChecks = NumFailedChecks;
+		const auto start = std::chrono::steady_clock::now();
+
+		test.Function();
+
+		const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		const bool bPassed = NumFailedChecks == numFailedChecks;
+
+		printf("%-48s %s (%.2fs)\n", test.Name, bPassed ? "passed" : "FAILED", duration);
+		fflush(stdout);
+
+		numTests++;
+		numFailedTests += bPassed ? 0 : 1;
+	}
+
+	printf("%u of %u tests passed\n", numTests - numFailedTests, numTests);
+
+	return numFailedTests == 0 && numTests > 0 ? 0 : 1;
+}
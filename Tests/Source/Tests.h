@@ -0,0 +1,48 @@
+//
+// Copyright (c) Alexandre Hetu.
+// Licensed under the MIT License.
+//
+// https://github.com/ahetu04
+//
+
+#pragma once
+
+#include "Kimura.h"
+
+#include <cstdio>
+
+namespace Kimura
+{
+	namespace Tests
+	{
+		typedef void (*TestFunction)();
+
+		// tests register themselves before main runs, see KIMURA_TEST
+		class TestRegistration
+		{
+			public:
+
+				TestRegistration(const char* InName, TestFunction InFunction);
+		};
+
+		// counts a failed check of the running test, which keeps going
+		void ReportFailure(const char* InFile, int InLine, const char* InExpression);
+
+		// true when the code was built with its SSE2 code paths
+		bool IsUsingSIMD();
+	}
+}
+
+#define KIMURA_TEST(Name) \
+	static void Name(); \
+	static Kimura::Tests::TestRegistration Name##Registration(#Name, &Name); \
+	static void Name()
+
+#define KIMURA_CHECK(Expression) \
+	do \
+	{ \
+		if (!(Expression)) \
+		{ \
+			Kimura::Tests::ReportFailure(__FILE__, __LINE__, #Expression); \
+		} \
+	} while (0)